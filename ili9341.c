@@ -22,43 +22,212 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 */
 #include <stdlib.h>
+#include <string.h>
+#include <math.h>
 #include <ili9341.h>
+#if defined(__SSE2__)
+	#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+	#include <arm_neon.h>
+#endif
+
+/* Lines of frame memory the panel scrolls, along its 320 pixel side */
+#define ILI_SCROLL_LINES    320
 
-/* Number of pixels in the temporary display buffer.
- * The temporary buffer is used only by `ili_fill_color()` function
+#if !defined(ILI_NO_DEFAULT_INSTANCE)
+/*
+ * Default instance, the one the ili_* functions without a handle run on.
+ * It sits on the platform's default bus, see ili_dev_setup() for the others
  */
-#define ILI_TMP_DISP_BUF_PX_CNT    256
+static ili_dev_t g_ili_dev = {.bus = &ili_platform_default_bus, .width = 240, .height = 320};
+#endif
 
-//TFT width and height default global variables
-static uint16_t g_ili_tftwidth = 240;
-static uint16_t g_ili_tftheight = 320;
-static uint8_t  g_rotation = 0;
+#if defined(ILI_SHARED_SCRATCH)
+/* Working memory of the rasterizers, one for all instances */
+static _ili_scratch_t g_ili_scratch;
+#define _ILI_SCRATCH(dev)   ((void)(dev), &g_ili_scratch)
+#else
+#define _ILI_SCRATCH(dev)   (&(dev)->scratch)
+#endif
 
-#if defined(ILI_BUS_TYPE_SPI)
-/*used by `ili_fill_color()` function*/
-static uint16_t g_tmp_disp_buffer[ILI_TMP_DISP_BUF_PX_CNT];
+/*
+ * Optional RAM framebuffer, see ili_fb_attach(). While attached, the address window and the
+ * pixel writes go into `fb_buf` instead of the bus, and the touched areas are recorded as
+ * dirty rectangles until ili_flush().
+ */
+#define ILI_FB_WINDOW_COST_PX   8		// CASET+PASET+RAMWR cost about as much bus time as 8 pixels
+
+/* Bus cost of sending a rectangle as one window, in pixels */
+static inline uint32_t _ili_rect_cost(const _ili_rect_t *r)
+{
+	return (uint32_t)(r->x1 - r->x0 + 1) * (uint32_t)(r->y1 - r->y0 + 1) + ILI_FB_WINDOW_COST_PX;
+}
+
+static inline _ili_rect_t _ili_rect_union(const _ili_rect_t *a, const _ili_rect_t *b)
+{
+	_ili_rect_t u;
+	u.x0 = (a->x0 < b->x0) ? a->x0 : b->x0;
+	u.y0 = (a->y0 < b->y0) ? a->y0 : b->y0;
+	u.x1 = (a->x1 > b->x1) ? a->x1 : b->x1;
+	u.y1 = (a->y1 > b->y1) ? a->y1 : b->y1;
+	return u;
+}
+
+static void _ili_fb_add_dirty(ili_dev_t *dev, uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1)
+{
+	_ili_rect_t r = {x0, y0, x1, y1};
+
+	// Absorb it into an existing rectangle when sending both as one is not more expensive.
+	// Covers overlapping, adjacent and contained rectangles
+	for (uint8_t i = 0; i < dev->fb_dirty_cnt; i++)
+	{
+		_ili_rect_t u = _ili_rect_union(&dev->fb_dirty[i], &r);
+		if (_ili_rect_cost(&u) <= _ili_rect_cost(&dev->fb_dirty[i]) + _ili_rect_cost(&r))
+		{
+			dev->fb_dirty[i] = u;
+			return;
+		}
+	}
+	if (dev->fb_dirty_cnt < ILI_FB_MAX_DIRTY)
+	{
+		dev->fb_dirty[dev->fb_dirty_cnt++] = r;
+		return;
+	}
+
+	// List is full, grow the rectangle that grows the least
+	uint8_t best = 0;
+	uint32_t best_growth = UINT32_MAX;
+	for (uint8_t i = 0; i < dev->fb_dirty_cnt; i++)
+	{
+		_ili_rect_t u = _ili_rect_union(&dev->fb_dirty[i], &r);
+		uint32_t growth = _ili_rect_cost(&u) - _ili_rect_cost(&dev->fb_dirty[i]);
+		if (growth < best_growth)
+		{
+			best_growth = growth;
+			best = i;
+		}
+	}
+	dev->fb_dirty[best] = _ili_rect_union(&dev->fb_dirty[best], &r);
+}
+
+/*
+ * Write `len` pixels at the framebuffer write pointer, walking the address window like the panel does.
+ * Pixels come from `src`, or are all `color` when `src` is NULL
+ */
+static void _ili_fb_write(ili_dev_t *dev, const uint16_t *src, uint16_t color, uint32_t len)
+{
+	uint16_t fb_x1 = dev->fb_x + dev->fb_w - 1;
+	uint16_t fb_y1 = dev->fb_y + dev->fb_h - 1;
+	uint16_t dx0 = UINT16_MAX, dy0 = UINT16_MAX, dx1 = 0, dy1 = 0;
+
+	while (len)
+	{
+		uint32_t run = (uint32_t)(dev->fb_ec - dev->fb_col) + 1;
+		run = (len < run) ? len : run;
+		uint16_t c0 = dev->fb_col;
+		uint16_t c1 = dev->fb_col + (uint16_t)run - 1;
+
+		if (dev->fb_page >= dev->fb_y && dev->fb_page <= fb_y1 && c1 >= dev->fb_x && c0 <= fb_x1)
+		{
+			uint16_t s = (c0 > dev->fb_x) ? c0 : dev->fb_x;
+			uint16_t e = (c1 < fb_x1) ? c1 : fb_x1;
+			uint16_t *dst = &dev->fb_buf[(uint32_t)(dev->fb_page - dev->fb_y) * dev->fb_w + (s - dev->fb_x)];
+			if (src)
+				memcpy(dst, &src[s - c0], (uint32_t)(e - s + 1) * sizeof(uint16_t));
+			else
+				for (uint16_t i = 0; i <= e - s; i++)
+					dst[i] = color;
+
+			dx0 = (s < dx0) ? s : dx0;
+			dx1 = (e > dx1) ? e : dx1;
+			dy0 = (dev->fb_page < dy0) ? dev->fb_page : dy0;
+			dy1 = (dev->fb_page > dy1) ? dev->fb_page : dy1;
+		}
+
+		if (src)
+			src += run;
+		len -= run;
+		dev->fb_col += (uint16_t)run;
+		if (dev->fb_col > dev->fb_ec)
+		{
+			dev->fb_col = dev->fb_sc;
+			dev->fb_page = (dev->fb_page == dev->fb_ep) ? dev->fb_sp : dev->fb_page + 1;
+		}
+	}
+
+	if (dx0 <= dx1)
+		_ili_fb_add_dirty(dev, dx0, dy0, dx1, dy1);
+}
+
+/*
+ * Append an op to the display list being recorded, see ili_dl_begin(). While recording, the drawing
+ * functions call it and return without touching the bus or the framebuffer.
+ */
+static void _ili_dl_add(ili_dev_t *dev, uint8_t type, uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint8_t width,
+										uint16_t color, uint16_t *bitmap)
+{
+	if (dev->dl_rec->count >= dev->dl_rec->capacity)
+	{
+		dev->dl_rec->overflow = 1;
+		return;
+	}
+	ili_dl_op_t *op = &dev->dl_rec->ops[dev->dl_rec->count++];
+	op->type = type;
+	op->width = width;
+	op->color = color;
+	op->x0 = x0;
+	op->y0 = y0;
+	op->x1 = x1;
+	op->y1 = y1;
+	op->bitmap = bitmap;
+}
+
+/**
+ * Start a driver instance for a panel on `bus`, with cleared state: 240x320, rotation 0.
+ * Then call ili_dev_bus_init() and ili_dev_init() on it, the same way as ili_bus_init() and ili_init()
+ * @param dev Instance, must stay valid as long as it is in use
+ * @param bus Bus of the panel, see the platform header. Not shared with another instance
+ */
+void ili_dev_setup(ili_dev_t *dev, ili_bus_t *bus)
+{
+	memset(dev, 0, sizeof(ili_dev_t));
+	dev->bus = bus;
+	dev->width = 240;
+	dev->height = 320;
+}
+
+#if !defined(ILI_NO_DEFAULT_INSTANCE)
+/**
+ * Instance the functions without a handle run on. It sits on the platform's default bus
+ */
+ili_dev_t *ili_dev_default(void)
+{
+	return &g_ili_dev;
+}
 #endif
 
-void ili_bus_init()
+void ili_dev_bus_init(ili_dev_t *dev)
 {
 #if defined(ILI_BUS_TYPE_SPI)
-	ili_platform_spi_init(ILI_SPI_FREQ, SPI_CPOL, SPI_CPHA, IS_LSBFIRST); // Freq: 20MHz (default), CPOL: 0, CPHA: 0, Bit order: MSB First)
+	ili_platform_spi_init(dev->bus, ILI_SPI_FREQ, SPI_CPOL, SPI_CPHA, IS_LSBFIRST); // Freq: 20MHz (default), CPOL: 0, CPHA: 0, Bit order: MSB First)
 #else
-	ili_platform_parallel_init();
+	ili_platform_parallel_init(dev->bus);
 #endif
 #if defined(ILI_PLATFORM_CS_LOW)
-	ILI_PLATFORM_CS_LOW();
+	ILI_PLATFORM_CS_LOW(dev->bus);
 #endif
-
+	_ili_window_invalidate(dev);
 }
 
-void ili_bus_deinit()
+void ili_dev_bus_deinit(ili_dev_t *dev)
 {
-	ILI_PLATFORM_CS_HIGH();
+	ili_dev_wait_idle(dev);
+	ILI_PLATFORM_CS_HIGH(dev->bus);
+	_ili_window_invalidate(dev);
 #if defined(ILI_BUS_TYPE_SPI)
-	ili_platform_spi_deinit();
+	ili_platform_spi_deinit(dev->bus);
 #else
-	ili_platform_parallel_deinit();
+	ili_platform_parallel_deinit(dev->bus);
 #endif
 }
 
@@ -66,32 +235,31 @@ void ili_bus_deinit()
 /**
  * Set an area for drawing on the display with start row,col and end row,col.
  * User don't need to call it usually, call it only before some functions who don't call it by default.
+ * Only sends what the panel doesn't already have: CASET and PASET are skipped when unchanged,
+ * and nothing at all is sent when the next pixel would land on (x, y) in the same rows anyway.
+ * In that case the panel keeps its previous window, which is equivalent for the first w*h pixels.
  * @param x start column address.
  * @param y start row address.
  * @param w width.
  * @param h Height.
  */
-void ili_set_address_window(uint16_t x, uint16_t y, uint16_t w, uint16_t h)
+void ili_dev_set_address_window(ili_dev_t *dev, uint16_t x, uint16_t y, uint16_t w, uint16_t h)
 {
     uint16_t x2 = x + w - 1;
     uint16_t y2 = y + h - 1;
 
-    _ili_write_command_8bit(ILI_CASET);
-    _ILI_DC_DATA();
-    _ILI_WRITE8((uint8_t)(x >> 8));
-    _ILI_WRITE8((uint8_t)x);
-    _ILI_WRITE8((uint8_t)(x2 >> 8));
-    _ILI_WRITE8((uint8_t)x2);
-
-
-    _ili_write_command_8bit(ILI_PASET);
-    _ILI_DC_DATA();
-    _ILI_WRITE8((uint8_t)(y >> 8));
-    _ILI_WRITE8((uint8_t)y);
-    _ILI_WRITE8((uint8_t)(y2 >> 8));
-    _ILI_WRITE8((uint8_t)y2);
+    if (dev->fb_buf)
+    {
+    	dev->fb_sc = x;
+    	dev->fb_ec = x2;
+    	dev->fb_sp = y;
+    	dev->fb_ep = y2;
+    	dev->fb_col = x;
+    	dev->fb_page = y;
+    	return;
+    }
 
-    _ili_write_command_8bit(ILI_RAMWR);
+    _ili_open_window(dev, dev->bus, x, y, x2, y2);
 }
 
 
@@ -100,27 +268,35 @@ void ili_set_address_window(uint16_t x, uint16_t y, uint16_t w, uint16_t h)
  * @param color_buffer Pointer to the 16-bit color color_buffer
  * @param len Number of pixels in buffer
  */
-void ili_draw_pixels_buffer(uint16_t *color_buffer, uint32_t len)
+void ili_dev_draw_pixels_buffer(ili_dev_t *dev, uint16_t *color_buffer, uint32_t len)
 {
-    _ILI_DC_DATA();
+    if (dev->fb_buf)
+    {
+    	_ili_fb_write(dev, color_buffer, 0, len);
+    	return;
+    }
+
+    _ILI_DC_DATA(dev->bus);
+    _ili_write_pointer_advance(dev, len);
 
 #if defined(ILI_BUS_TYPE_SPI)
-    ili_platform_spi_send_buffer16(color_buffer, len);
+    ili_platform_spi_send_buffer16(dev->bus, color_buffer, len);
 
 #elif defined(ILI_BUS_TYPE_PARALLEL8)
-    uint32_t tmp_len = (len >> 2) << 2; // Getting closest len divisible by 4. [Same as: (uint32_t)(len / 4) * 4]
-    for (uint32_t i = 0; i < tmp_len; i+=4)
+    ili_bus_t *bus = dev->bus;
+    uint32_t i = 0;
+    uint32_t burst_len = (len >> 2) << 2; // Getting closest len divisible by 4. [Same as: (uint32_t)(len / 4) * 4]
+    for (; i < burst_len; i += 4)
     {
         // Unrolled loop to send burst of 4 pixels (64 bits) fast
-        _ILI_WRITE8((uint8_t)(color_buffer[i+0]>>8)); _ILI_WRITE8((uint8_t)color_buffer[i+0]); //1
-        _ILI_WRITE8((uint8_t)(color_buffer[i+1]>>8)); _ILI_WRITE8((uint8_t)color_buffer[i+1]); //2
-        _ILI_WRITE8((uint8_t)(color_buffer[i+2]>>8)); _ILI_WRITE8((uint8_t)color_buffer[i+2]); //3
-        _ILI_WRITE8((uint8_t)(color_buffer[i+3]>>8)); _ILI_WRITE8((uint8_t)color_buffer[i+3]); //4
+        _ILI_WRITE8(bus, (uint8_t)(color_buffer[i+0]>>8)); _ILI_WRITE8(bus, (uint8_t)color_buffer[i+0]); //1
+        _ILI_WRITE8(bus, (uint8_t)(color_buffer[i+1]>>8)); _ILI_WRITE8(bus, (uint8_t)color_buffer[i+1]); //2
+        _ILI_WRITE8(bus, (uint8_t)(color_buffer[i+2]>>8)); _ILI_WRITE8(bus, (uint8_t)color_buffer[i+2]); //3
+        _ILI_WRITE8(bus, (uint8_t)(color_buffer[i+3]>>8)); _ILI_WRITE8(bus, (uint8_t)color_buffer[i+3]); //4
     }
-    tmp_len = (len & 3);    // len % 4
-    for (uint32_t i = 0; i < tmp_len; i++)
+    for (; i < len; i++)
     {
-    	ILI_DISP_BUFFER_PIXELS_COUNT    _ILI_WRITE8((uint8_t)(color_buffer[i]>>8)); _ILI_WRITE8((uint8_t)color_buffer[i]); //1
+        _ILI_WRITE8(bus, (uint8_t)(color_buffer[i]>>8)); _ILI_WRITE8(bus, (uint8_t)color_buffer[i]);
     }
 #endif
 
@@ -128,76 +304,146 @@ void ili_draw_pixels_buffer(uint16_t *color_buffer, uint32_t len)
 }
 
 
+/**
+ * Draw a `w`x`h` area of a larger bitmap whose rows are `stride` pixels apart.
+ * Call ili_set_address_window() with `w` and `h` before calling this function.
+ * @param color_buffer Pointer to the first pixel of the area
+ * @param w Width of the area
+ * @param h Height of the area
+ * @param stride Number of pixels between the starts of two rows of `color_buffer`
+ */
+void ili_dev_draw_pixels_buffer_stride(ili_dev_t *dev, uint16_t *color_buffer, uint16_t w, uint16_t h, uint32_t stride)
+{
+	if (stride == w)
+	{
+		ili_dev_draw_pixels_buffer(dev, color_buffer, (uint32_t)w * (uint32_t)h);
+		return;
+	}
+	// The RAMWR stream stays open, so each row costs no command bytes
+	for (uint16_t row = 0; row < h; row++)
+	{
+		ili_dev_draw_pixels_buffer(dev, color_buffer, w);
+		color_buffer += stride;
+	}
+}
+
+
+/**
+ * Draw a bitmap image on the display without waiting for the transfer to finish
+ * @param color_buffer Pointer to the 16-bit color color_buffer. Must stay valid until `cb` is called
+ * @param len Number of pixels in buffer
+ * @param cb Completion callback, can be NULL
+ * @param user_data Passed to `cb`
+ */
+void ili_dev_draw_pixels_buffer_async(ili_dev_t *dev, uint16_t *color_buffer, uint32_t len, ili_xfer_done_cb_t cb, void *user_data)
+{
+#if defined(ILI_BUS_TYPE_SPI) && defined(ILI_PLATFORM_SPI_ASYNC)
+	if (dev->fb_buf)
+	{
+		// Nothing to wait for in RAM
+		_ili_fb_write(dev, color_buffer, 0, len);
+		if (cb)
+			cb(user_data);
+		return;
+	}
+
+	_ILI_DC_DATA(dev->bus);
+	_ili_write_pointer_advance(dev, len);
+	ili_platform_spi_send_buffer16_async(dev->bus, color_buffer, len, cb, user_data);
+#else
+	// No DMA on this platform. Send it blocking and complete right away
+	ili_dev_draw_pixels_buffer(dev, color_buffer, len);
+	if (cb)
+		cb(user_data);
+#endif
+}
+
+
+/**
+ * Wait until the ongoing non-blocking transfer (if any) is finished
+ */
+void ili_dev_wait_idle(ili_dev_t *dev)
+{
+	_ILI_WAIT_IDLE(dev->bus);
+}
+
+
 /**
  * Fills `len` number of pixels with `color`.
  * Call ili_set_address_window() before calling this function.
  * @param color 16-bit RGB565 color value
  * @param len 32-bit number of pixels
  */
-void ili_fill_color(uint16_t color, uint32_t len)
+void ili_dev_fill_color(ili_dev_t *dev, uint16_t color, uint32_t len)
 {
-    _ILI_DC_DATA();
+    if (dev->fb_buf)
+    {
+    	_ili_fb_write(dev, NULL, color, len);
+    	return;
+    }
+
+    _ILI_DC_DATA(dev->bus);
+    _ili_write_pointer_advance(dev, len);
 
 #if defined(ILI_BUS_TYPE_SPI)
     uint32_t xfer_px_cnt = (len < ILI_TMP_DISP_BUF_PX_CNT) ? len : ILI_TMP_DISP_BUF_PX_CNT;
 
     for (uint32_t i = 0; i < xfer_px_cnt; i++)
 	{
-    	g_tmp_disp_buffer[i] = color;
+    	dev->tmp_disp_buffer[i] = color;
 	}
 	while (len)
 	{
 		xfer_px_cnt = (len < xfer_px_cnt) ? len : xfer_px_cnt;
-		ili_platform_spi_send_buffer16(g_tmp_disp_buffer, xfer_px_cnt);
+		ili_platform_spi_send_buffer16(dev->bus, dev->tmp_disp_buffer, xfer_px_cnt);
 		len -= xfer_px_cnt;
 	}
 
 #else /* when ILI_BUS_TYPE_PARALLEL8 */
-	// [IMPORTANT]: The colorhigh == colorlow check is only applicable for parallel interface
-	// If higher byte and lower byte are identical,
-	// just strobe the WR pin to send the previous data
+	ili_bus_t *bus = dev->bus;
 	uint8_t color_high = color >> 8;
 	uint8_t color_low = color;
-#ifdef _ILI_PLATFORM_WR_STROBE()
+#if defined(_ILI_PLATFORM_WR_STROBE)
+	// [IMPORTANT]: The colorhigh == colorlow check is only applicable for parallel interface
+	// If higher byte and lower byte are identical, the byte is put on the port once
+	// and the panel latches it again on every WR strobe
 	if (color_high == color_low)
 	{
-        // Write only the first pixel
-        _ILI_WRITE8(color_high); _ILI_WRITE8(color_low);
-        --len;
-		uint32_t tmp_len = (len >> 2) << 2; // Getting closest len divisible by 4. [Same as: (uint32_t)(len / 4) * 4]
-        for (uint32_t i = 0; i < tmp_len; i+=4)
-        {
-            // Unrolled loop to send burst of 4 pixels (64 bytes) fast
-            _ILI_WR_STROBE(); _ILI_WR_STROBE(); //1
-            _ILI_WR_STROBE(); _ILI_WR_STROBE(); //2
-            _ILI_WR_STROBE(); _ILI_WR_STROBE(); //3
-            _ILI_WR_STROBE(); _ILI_WR_STROBE(); //4
-        }
-        tmp_len = (len & 3);    // len % 4
-        for (uint32_t i = 0; i < tmp_len; i++)
-        {
-            _ILI_WR_STROBE(); _ILI_WR_STROBE(); //1
-        }
+		if (len == 0)
+			return;
+		_ILI_WRITE8(bus, color_high);
+		uint32_t strobes = len * 2 - 1;
+		uint32_t i = 0;
+		for (; i + 8 <= strobes; i += 8)
+		{
+			// Unrolled loop to send burst of 4 pixels (64 bits) fast
+			_ILI_PLATFORM_WR_STROBE(bus); _ILI_PLATFORM_WR_STROBE(bus); //1
+			_ILI_PLATFORM_WR_STROBE(bus); _ILI_PLATFORM_WR_STROBE(bus); //2
+			_ILI_PLATFORM_WR_STROBE(bus); _ILI_PLATFORM_WR_STROBE(bus); //3
+			_ILI_PLATFORM_WR_STROBE(bus); _ILI_PLATFORM_WR_STROBE(bus); //4
+		}
+		for (; i < strobes; i++)
+		{
+			_ILI_PLATFORM_WR_STROBE(bus);
+		}
+		return;
 	}
+#endif /*_ILI_PLATFORM_WR_STROBE*/
 
 	// If higher and lower bytes are different, send those bytes
-	else
+	uint32_t i = 0;
+	uint32_t burst_len = (len >> 2) << 2; // Getting closest len divisible by 4. [Same as: (uint32_t)(len / 4) * 4]
+	for (; i < burst_len; i += 4)
 	{
-#endif /*_ILI_PLATFORM_WR_STROBE*/
-		uint32_t tmp_len = (len >> 2) << 2; // Getting closest len divisible by 4. [Same as: (uint32_t)(len / 4) * 4]
-        for (uint32_t i = 0; i < tmp_len; i+=4)
-        {
-            // Unrolled loop to send burst of 4 pixels (64 bytes) fast
-            _ILI_WRITE8(color_high); _ILI_WRITE8(color_low); //1
-            _ILI_WRITE8(color_high); _ILI_WRITE8(color_low); //2
-            _ILI_WRITE8(color_high); _ILI_WRITE8(color_low); //3
-            _ILI_WRITE8(color_high); _ILI_WRITE8(color_low); //4
-        }
-        tmp_len = (len & 3);    // len % 4
-        for (uint32_t i = 0; i < tmp_len; i++)
-        {
-            _ILI_WRITE8((uint8_t)(color_buffer[i]>>8)); _ILI_WRITE8((uint8_t)color_buffer[i]); //1
-        }
+		// Unrolled loop to send burst of 4 pixels (64 bits) fast
+		_ILI_WRITE8(bus, color_high); _ILI_WRITE8(bus, color_low); //1
+		_ILI_WRITE8(bus, color_high); _ILI_WRITE8(bus, color_low); //2
+		_ILI_WRITE8(bus, color_high); _ILI_WRITE8(bus, color_low); //3
+		_ILI_WRITE8(bus, color_high); _ILI_WRITE8(bus, color_low); //4
+	}
+	for (; i < len; i++)
+	{
+		_ILI_WRITE8(bus, color_high); _ILI_WRITE8(bus, color_low);
 	}
 
 #endif /*ILI_BUS_TYPE_SPI*/
@@ -206,572 +452,3667 @@ void ili_fill_color(uint16_t color, uint32_t len)
 
 
 /**
- * Fills a rectangular area with `color`.
- * Before filling, performs area bound checking
- * @param x Start col address
- * @param y Start row address
- * @param w Width of rectangle
- * @param h Height of rectangle
- * @param color 16-bit RGB565 color
+ * Attach a RAM framebuffer covering the area (x, y, w, h) of the display.
+ * From now on all drawing goes into `buf` instead of the bus, and the touched areas are recorded
+ * as dirty rectangles. Drawing outside the area is discarded. Call ili_flush() to send the changes.
+ * The buffer is neither cleared nor read back from the display. Coordinates are of the current rotation.
+ * @param buf w*h pixels, row by row. Must stay valid until ili_fb_detach()
+ * @param x Start col address of the area
+ * @param y Start row address of the area
+ * @param w Width of the area
+ * @param h Height of the area
  */
-void ili_fill_rect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color)
+void ili_dev_fb_attach(ili_dev_t *dev, uint16_t *buf, uint16_t x, uint16_t y, uint16_t w, uint16_t h)
 {
-	if (x >= g_ili_tftwidth || y >= g_ili_tftheight || w == 0 || h == 0)
+	if (dev->fb_buf)
+		ili_dev_fb_detach(dev);
+	if (buf == NULL || w == 0 || h == 0 || x >= dev->width || y >= dev->height)
 		return;
-	if (x + w - 1 >= g_ili_tftwidth)
-		w = g_ili_tftwidth - x;
-	if (y + h - 1 >= g_ili_tftheight)
-		h = g_ili_tftheight - y;
+	if (x + w - 1 >= dev->width)
+		w = dev->width - x;
+	if (y + h - 1 >= dev->height)
+		h = dev->height - y;
 
-	ili_set_address_window(x, y, w, h);
-	ili_fill_color(color, (uint32_t)w * (uint32_t)h);
+	dev->fb_x = x;
+	dev->fb_y = y;
+	dev->fb_w = w;
+	dev->fb_h = h;
+	dev->fb_dirty_cnt = 0;
+	dev->fb_buf = buf;
 }
 
 
-/*
- * Same as `ili_fill_rect()` but does not do bound checking, so it's slightly faster
+/**
+ * Flush the framebuffer and go back to drawing directly on the display
  */
-void ili_fill_rect_fast(uint16_t x1, uint16_t y1, uint16_t w, uint16_t h, uint16_t color)
+void ili_dev_fb_detach(ili_dev_t *dev)
 {
-	ili_set_address_window(x1, y1, w, h);
-	ili_fill_color(color, (uint32_t)w * (uint32_t)h);
+	if (!dev->fb_buf)
+		return;
+	ili_dev_flush(dev);
+	dev->fb_buf = NULL;
 }
 
 
-/**
- * Fill the entire display (screen) with `color`
- * @param color 16-bit RGB565 color
- */
-void ili_fill_screen(uint16_t color)
+/* Merge dirty rectangles grown after they were added, wherever one window is now cheaper than two */
+static void _ili_fb_merge_dirty(ili_dev_t *dev)
 {
-	ili_set_address_window(0, 0, g_ili_tftwidth, g_ili_tftheight);
-	ili_fill_color(color, (uint32_t)g_ili_tftwidth * (uint32_t)g_ili_tftheight);
+	uint8_t merged = 1;
+	while (merged)
+	{
+		merged = 0;
+		for (uint8_t i = 0; i < dev->fb_dirty_cnt; i++)
+		{
+			for (uint8_t j = i + 1; j < dev->fb_dirty_cnt; j++)
+			{
+				_ili_rect_t u = _ili_rect_union(&dev->fb_dirty[i], &dev->fb_dirty[j]);
+				if (_ili_rect_cost(&u) <= _ili_rect_cost(&dev->fb_dirty[i]) + _ili_rect_cost(&dev->fb_dirty[j]))
+				{
+					dev->fb_dirty[i] = u;
+					dev->fb_dirty[j--] = dev->fb_dirty[--dev->fb_dirty_cnt];
+					merged = 1;
+				}
+			}
+		}
+	}
 }
 
+/* Send the dirty rectangles in their order and clear them */
+static void _ili_fb_send_dirty(ili_dev_t *dev)
+{
+	uint16_t *fb = dev->fb_buf;
+
+	// Draw on the bus, not into the framebuffer
+	dev->fb_buf = NULL;
+	for (uint8_t i = 0; i < dev->fb_dirty_cnt; i++)
+	{
+		const _ili_rect_t *r = &dev->fb_dirty[i];
+		uint16_t w = r->x1 - r->x0 + 1;
+		uint16_t h = r->y1 - r->y0 + 1;
+		ili_dev_set_address_window(dev, r->x0, r->y0, w, h);
+		ili_dev_draw_pixels_buffer_stride(dev, &fb[(uint32_t)(r->y0 - dev->fb_y) * dev->fb_w + (r->x0 - dev->fb_x)], w, h, dev->fb_w);
+	}
+	dev->fb_dirty_cnt = 0;
+	dev->fb_buf = fb;
+}
 
 /**
- * Draw a rectangle
-*/
-void ili_draw_rectangle(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color)
+ * Send the dirty rectangles of the framebuffer to the display, one address window each.
+ * Rectangles are merged first wherever one window is cheaper than two.
+ * Does nothing when no framebuffer is attached.
+ */
+void ili_dev_flush(ili_dev_t *dev)
 {
-	// Perform bound checking
-	if (x >= g_ili_tftwidth || y >= g_ili_tftheight || w == 0 || h == 0)
+	if (!dev->fb_buf)
 		return;
-	if (x + w - 1 >= g_ili_tftwidth)
-		w = g_ili_tftwidth - x;
-	if (y + h - 1 >= g_ili_tftheight)
-		h = g_ili_tftheight - y;
-
-	_ili_draw_fast_h_line(x, y, x+w-1, 1, color);
-	_ili_draw_fast_h_line(x, y+h, x+w-1, 1, color);
-	_ili_draw_fast_v_line(x, y, y+h-1, 1, color);
-	_ili_draw_fast_v_line(x+w, y, y+h-1, 1, color);
-
 
+	_ili_fb_merge_dirty(dev);
+	_ili_fb_send_dirty(dev);
 }
 
-/*
- * Called by ili_draw_line().
- * User need not call it
+
+/**
+ * Render the whole screen in strips of `strip_h` rows, alternating between two strip buffers.
+ * `render` fills strip k+1 while strip k is being sent, and the whole frame goes out under one
+ * address window. During `render` the strip is attached as framebuffer, so it can either write
+ * the pixels itself or use any ili_* drawing function (clipped to the strip).
+ * Returns when the last strip is sent. An attached framebuffer is flushed and detached first.
+ * @param buf0 First strip buffer, `strip_h` rows of the display width
+ * @param buf1 Second strip buffer, same size. If NULL, buf0 is reused and nothing overlaps
+ * @param strip_h Number of rows per strip
+ * @param render Called once per strip
+ * @param user_data Passed to `render`
  */
-void _ili_plot_line_low(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint8_t width, uint16_t color)
+void ili_dev_render_strips(ili_dev_t *dev, uint16_t *buf0, uint16_t *buf1, uint16_t strip_h, ili_strip_render_cb_t render, void *user_data)
 {
-	int16_t dx = x1 - x0;
-	int16_t dy = y1 - y0;
-	int8_t yi = 1;
-	uint8_t pixels_per_point = width * width;	//no of pixels making a point. if line width is 1, this var is 1. if 2, this var is 4 and so on
-	uint8_t color_high = (uint8_t)(color >> 8);
-	uint8_t color_low = (uint8_t)color;
-	if (dy < 0)
-	{
-		yi = -1;
-		dy = -dy;
-	}
+	uint16_t *bufs[2] = {buf0, buf1 ? buf1 : buf0};
+	uint8_t cur = 0;
 
-	int16_t D = 2*dy - dx;
-	uint16_t y = y0;
-	uint16_t x = x0;
+	if (buf0 == NULL || strip_h == 0 || render == NULL)
+		return;
 
-	while (x <= x1)
+	ili_dev_fb_detach(dev);
+	ili_dev_set_address_window(dev, 0, 0, dev->width, dev->height);
+	for (uint16_t y = 0; y < dev->height; y += strip_h)
 	{
-		ili_set_address_window(x, y, width, width);
-		//Drawing all the pixels of a single point
+		uint16_t rows = (dev->height - y < strip_h) ? dev->height - y : strip_h;
+		uint16_t *buf = bufs[cur];
 
-		_ILI_DC_DATA();
-		for (uint8_t pixel_cnt = 0; pixel_cnt < pixels_per_point; pixel_cnt++)
-		{
-			_ILI_WRITE8(color_high);
-			_ILI_WRITE8(color_low);
-		}
+		// With two buffers, starting the previous strip already waited for the one before it
+		if (buf1 == NULL)
+			ili_dev_wait_idle(dev);
 
-		if (D > 0)
-		{
-			y = y + yi;
-			D = D - 2*dx;
-		}
-		D = D + 2*dy;
-		x++;
+		// Attach without any dirty tracking of interest, the strip is sent as a whole
+		ili_dev_fb_attach(dev, buf, 0, y, dev->width, rows);
+		render(buf, y, rows, user_data);
+		dev->fb_buf = NULL;
+
+		// Consecutive strips continue the RAMWR stream, no command in between
+		ili_dev_draw_pixels_buffer_async(dev, buf, (uint32_t)dev->width * rows, NULL, NULL);
+		cur ^= 1;
 	}
+	ili_dev_wait_idle(dev);
 }
 
 
-/*
- * Called by ili_draw_line().
- * User need not call it
+/**
+ * Start recording into `dl`. Until ili_dl_end(), ili_fill_rect(), ili_fill_rect_fast(), ili_fill_screen(),
+ * ili_draw_line(), ili_draw_pixel(), ili_draw_bitmap() and everything drawn with them (rectangles,
+ * polylines) are appended to `dl` instead of being drawn. Raw ili_set_address_window() writes are not recorded.
+ * Coordinates are of the current rotation. Recording appends to what `dl` already holds.
+ * @param dl Display list, set up with ops storage and capacity. `overflow` is set if it runs out
  */
-void _ili_plot_line_high(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint8_t width, uint16_t color)
+void ili_dev_dl_begin(ili_dev_t *dev, ili_dl_t *dl)
 {
-	int16_t dx = x1 - x0;
-	int16_t dy = y1 - y0;
-	int8_t xi = 1;
-	uint8_t pixels_per_point = width * width;	//no of pixels making a point. if line width is 1, this var is 1. if 2, this var is 4 and so on
-	uint8_t color_high = (uint8_t)(color >> 8);
-	uint8_t color_low = (uint8_t)color;
+	dev->dl_rec = dl;
+}
 
-	if (dx < 0)
-	{
-		xi = -1;
-		dx = -dx;
-	}
 
-	int16_t D = 2*dx - dy;
-	uint16_t y = y0;
-	uint16_t x = x0;
+/**
+ * Stop recording
+ */
+void ili_dev_dl_end(ili_dev_t *dev)
+{
+	dev->dl_rec = NULL;
+}
 
-	while (y <= y1)
+
+/* Pixels an op may touch, clipped to the display */
+static _ili_rect_t _ili_dl_bbox(ili_dev_t *dev, const ili_dl_op_t *op)
+{
+	_ili_rect_t r;
+	if (op->type == ILI_DL_LINE)
 	{
-		ili_set_address_window(x, y, width, width);
-		//Drawing all the pixels of a single point
+		// Thick lines cover [p, p + width) plus the rounding of the polygon edges
+		uint16_t margin = (op->width > 1) ? 1 : 0;
+		uint16_t x0 = (op->x0 < op->x1) ? op->x0 : op->x1;
+		uint16_t y0 = (op->y0 < op->y1) ? op->y0 : op->y1;
+		r.x0 = (x0 > margin) ? x0 - margin : 0;
+		r.y0 = (y0 > margin) ? y0 - margin : 0;
+		r.x1 = ((op->x0 > op->x1) ? op->x0 : op->x1) + op->width - 1 + margin;
+		r.y1 = ((op->y0 > op->y1) ? op->y0 : op->y1) + op->width - 1 + margin;
+	}
+	else
+	{
+		r.x0 = op->x0;
+		r.y0 = op->y0;
+		r.x1 = op->x1;
+		r.y1 = op->y1;
+	}
+	r.x1 = (r.x1 >= dev->width) ? dev->width - 1 : r.x1;
+	r.y1 = (r.y1 >= dev->height) ? dev->height - 1 : r.y1;
+	return r;
+}
 
-		_ILI_DC_DATA();
-		for (uint8_t pixel_cnt = 0; pixel_cnt < pixels_per_point; pixel_cnt++)
-		{
-			_ILI_WRITE8(color_high);
-			_ILI_WRITE8(color_low);
-		}
+static inline uint8_t _ili_rect_overlaps(const _ili_rect_t *a, const _ili_rect_t *b)
+{
+	return a->x0 <= b->x1 && b->x0 <= a->x1 && a->y0 <= b->y1 && b->y0 <= a->y1;
+}
 
-		if (D > 0)
-		{
-			x = x + xi;
-			D = D - 2*dy;
-		}
-		D = D + 2*dx;
-		y++;
+static inline uint8_t _ili_rect_contains(const _ili_rect_t *outer, const _ili_rect_t *inner)
+{
+	return outer->x0 <= inner->x0 && outer->x1 >= inner->x1 && outer->y0 <= inner->y0 && outer->y1 >= inner->y1;
+}
+
+/* Drop the ops marked ILI_DL_NONE */
+static void _ili_dl_compact(ili_dl_t *dl)
+{
+	uint16_t n = 0;
+	for (uint16_t i = 0; i < dl->count; i++)
+	{
+		if (dl->ops[i].type != ILI_DL_NONE)
+			dl->ops[n++] = dl->ops[i];
 	}
+	dl->count = n;
 }
 
+/* 1 if no op strictly between `i` and `j` touches `r` */
+static uint8_t _ili_dl_nothing_between(ili_dev_t *dev, const ili_dl_t *dl, uint16_t i, uint16_t j, const _ili_rect_t *r)
+{
+	for (uint16_t k = i + 1; k < j; k++)
+	{
+		if (dl->ops[k].type == ILI_DL_NONE)
+			continue;
+		_ili_rect_t rk = _ili_dl_bbox(dev, &dl->ops[k]);
+		if (_ili_rect_overlaps(&rk, r))
+			return 0;
+	}
+	return 1;
+}
 
 /**
- * Draw a line from (x0,y0) to (x1,y1) with `width` and `color`.
- * @param x0 start column address.
- * @param y0 start row address.
- * @param x1 end column address.
- * @param y1 end row address.
- * @param width width or thickness of the line
- * @param color 16-bit RGB565 color of the line
+ * Optimize a recorded display list in place. The result draws the same picture with less traffic:
+ * - ops completely covered by a later fill or bitmap are removed
+ * - same color fills that together form a rectangle are merged (pixels count as 1x1 fills)
+ * - independent ops are reordered top to bottom, left to right, so consecutive windows share
+ *   rows and columns and the address window cache skips more CASET/PASET
+ * Work is quadratic in the number of ops, meant to be done once for static screens.
+ * @param dl Display list to optimize
  */
-void ili_draw_line(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint8_t width, uint16_t color)
+void ili_dev_dl_optimize(ili_dev_t *dev, ili_dl_t *dl)
 {
-	/*
-	* Brehensen's algorithm is used.
-	* Not necessarily start points has to be less than end points.
-	*/
+	ili_dl_op_t *ops = dl->ops;
 
-	if (x0 == x1)	//vertical line
+	for (uint16_t i = 0; i < dl->count; i++)
 	{
-		_ili_draw_fast_v_line(x0, y0, y1, width, color);
+		if (ops[i].type == ILI_DL_PIXEL)
+			ops[i].type = ILI_DL_FILL;
 	}
-	else if (y0 == y1)		//horizontal line
+
+	// Cull everything a later opaque op paints over
+	for (uint16_t i = 0; i < dl->count; i++)
 	{
-		_ili_draw_fast_h_line(x0, y0, x1, width, color);
+		_ili_rect_t ri = _ili_dl_bbox(dev, &ops[i]);
+		for (uint16_t j = i + 1; j < dl->count; j++)
+		{
+			if (ops[j].type != ILI_DL_FILL && ops[j].type != ILI_DL_BITMAP)
+				continue;
+			_ili_rect_t rj = _ili_dl_bbox(dev, &ops[j]);
+			if (_ili_rect_contains(&rj, &ri))
+			{
+				ops[i].type = ILI_DL_NONE;
+				break;
+			}
+		}
 	}
+	_ili_dl_compact(dl);
 
-	else
+	// Merge same color fills sharing a full edge, when nothing in between touches the result
+	for (uint16_t i = 0; i < dl->count; i++)
 	{
-		if (abs(y1 - y0) < abs(x1 - x0))
+		if (ops[i].type != ILI_DL_FILL)
+			continue;
+		for (uint16_t j = i + 1; j < dl->count; j++)
 		{
-			if (x0 > x1)
-				_ili_plot_line_low(x1, y1, x0, y0, width, color);
-			else
-				_ili_plot_line_low(x0, y0, x1, y1, width, color);
+			ili_dl_op_t *a = &ops[i], *b = &ops[j];
+			if (b->type != ILI_DL_FILL || b->color != a->color)
+				continue;
+			uint8_t stacked = a->x0 == b->x0 && a->x1 == b->x1 && b->y0 <= a->y1 + 1 && a->y0 <= b->y1 + 1;
+			uint8_t side_by_side = a->y0 == b->y0 && a->y1 == b->y1 && b->x0 <= a->x1 + 1 && a->x0 <= b->x1 + 1;
+			if (!stacked && !side_by_side)
+				continue;
+			_ili_rect_t ra = _ili_dl_bbox(dev, a), rb = _ili_dl_bbox(dev, b);
+			_ili_rect_t u = _ili_rect_union(&ra, &rb);
+			if (!_ili_dl_nothing_between(dev, dl, i, j, &u))
+				continue;
+			a->x0 = u.x0;
+			a->y0 = u.y0;
+			a->x1 = u.x1;
+			a->y1 = u.y1;
+			b->type = ILI_DL_NONE;
+			j = i;	// `a` grew, look again from the start
 		}
+	}
+	_ili_dl_compact(dl);
 
-		else
+	// Insertion sort by (y0, x0). An op only moves before ops it doesn't overlap, so the picture stays the same
+	for (uint16_t i = 1; i < dl->count; i++)
+	{
+		ili_dl_op_t op = ops[i];
+		_ili_rect_t r = _ili_dl_bbox(dev, &op);
+		uint16_t k = i;
+		while (k > 0)
 		{
-			if (y0 > y1)
-				_ili_plot_line_high(x1, y1, x0, y0, width, color);
-			else
-				_ili_plot_line_high(x0, y0, x1, y1, width, color) ;
+			_ili_rect_t rp = _ili_dl_bbox(dev, &ops[k - 1]);
+			if (rp.y0 < r.y0 || (rp.y0 == r.y0 && rp.x0 <= r.x0) || _ili_rect_overlaps(&rp, &r))
+				break;
+			ops[k] = ops[k - 1];
+			k--;
 		}
+		ops[k] = op;
 	}
-
 }
 
 
-/*
- * Called by ili_draw_line().
- * User need not call it
+/**
+ * Draw all the ops of a display list
+ * @param dl Display list to draw
  */
-void _ili_draw_fast_h_line(uint16_t x0, uint16_t y0, uint16_t x1, uint8_t width, uint16_t color)
+void ili_dev_dl_replay(ili_dev_t *dev, const ili_dl_t *dl)
 {
-	/*
-	* Draw a horizontal line very fast
-	*/
-	if (x0 < x1)
-		ili_set_address_window(x0, y0, x1-x0+1, width);	//as it's horizontal line, y1=y0.. must be.
-	else
-		ili_set_address_window(x1, y0, x0-x1+1, width);
+	for (uint16_t i = 0; i < dl->count; i++)
+	{
+		const ili_dl_op_t *op = &dl->ops[i];
+		switch (op->type)
+		{
+			case ILI_DL_FILL:
+				ili_dev_fill_rect_fast(dev, op->x0, op->y0, op->x1 - op->x0 + 1, op->y1 - op->y0 + 1, op->color);
+				break;
+			case ILI_DL_LINE:
+				ili_dev_draw_line(dev, op->x0, op->y0, op->x1, op->y1, op->width, op->color);
+				break;
+			case ILI_DL_PIXEL:
+				ili_dev_draw_pixel(dev, op->x0, op->y0, op->color);
+				break;
+			case ILI_DL_BITMAP:
+				ili_dev_draw_bitmap(dev, op->x0, op->y0, op->x1 - op->x0 + 1, op->y1 - op->y0 + 1, op->bitmap);
+				break;
+			default:
+				break;
+		}
+	}
+}
+
+
+/**
+ * Fills a rectangular area with `color`.
+ * Before filling, performs area bound checking
+ * @param x Start col address
+ * @param y Start row address
+ * @param w Width of rectangle
+ * @param h Height of rectangle
+ * @param color 16-bit RGB565 color
+ */
+void ili_dev_fill_rect(ili_dev_t *dev, uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color)
+{
+	if (x >= dev->width || y >= dev->height || w == 0 || h == 0)
+		return;
+	if (x + w - 1 >= dev->width)
+		w = dev->width - x;
+	if (y + h - 1 >= dev->height)
+		h = dev->height - y;
+	if (dev->dl_rec)
+	{
+		_ili_dl_add(dev, ILI_DL_FILL, x, y, x + w - 1, y + h - 1, 0, color, NULL);
+		return;
+	}
 
-	ili_fill_color(color, (uint32_t)width * (uint32_t)abs(x1 - x0 + 1));
+	ili_dev_set_address_window(dev, x, y, w, h);
+	ili_dev_fill_color(dev, color, (uint32_t)w * (uint32_t)h);
 }
 
 
-/*
- * Called by ili_draw_line().
- * User need not call it
+/**
+ * Draw a `w`x`h` bitmap with its top-left corner at (x, y).
+ * Before drawing, performs area bound checking. Parts outside the display are skipped
+ * @param x Start col address
+ * @param y Start row address
+ * @param w Width of the bitmap
+ * @param h Height of the bitmap
+ * @param bitmap w*h RGB565 pixels, row by row
  */
-void _ili_draw_fast_v_line(uint16_t x0, uint16_t y0, uint16_t y1, uint8_t width, uint16_t color)
+void ili_dev_draw_bitmap(ili_dev_t *dev, uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t *bitmap)
 {
-	/*
-	* Draw a vertical line very fast
-	*/
-	if (y0 < y1)
-		ili_set_address_window(x0, y0, width, y1-y0+1);	//as it's vertical line, x1=x0.. must be.
+	if (x >= dev->width || y >= dev->height || w == 0 || h == 0)
+		return;
+	if (dev->dl_rec)
+	{
+		_ili_dl_add(dev, ILI_DL_BITMAP, x, y, x + w - 1, y + h - 1, 0, 0, bitmap);
+		return;
+	}
+
+	uint16_t vis_w = (x + w - 1 >= dev->width) ? dev->width - x : w;
+	uint16_t vis_h = (y + h - 1 >= dev->height) ? dev->height - y : h;
+	ili_dev_set_address_window(dev, x, y, vis_w, vis_h);
+	ili_dev_draw_pixels_buffer_stride(dev, bitmap, vis_w, vis_h, w);
+}
+
+
+/* Send `n` pixels of a packet of an RLE image: a run of `*src`, or the literal pixels at `src` */
+static inline void _ili_rle_emit(ili_dev_t *dev, uint8_t run, const uint16_t *src, uint32_t n)
+{
+	if (run)
+		ili_dev_fill_color(dev, *src, n);
 	else
-		ili_set_address_window(x0, y1, width, y0-y1+1);
+		ili_dev_draw_pixels_buffer(dev, (uint16_t *)src, n);
+}
+
+
+/**
+ * Draw a run-length encoded image with its top-left corner at (x, y). The packets are streamed
+ * to the display as they are decoded: runs with ili_fill_color(), literals straight from `img`
+ * with ili_draw_pixels_buffer(). Parts outside the display are skipped.
+ * Images are drawn right away, even while a display list is recorded.
+ * @param x Start col address
+ * @param y Start row address
+ * @param img Image to draw
+ */
+void ili_dev_draw_image_rle(ili_dev_t *dev, uint16_t x, uint16_t y, const ili_image_rle_t *img)
+{
+	uint16_t w = img->width;
+	if (x >= dev->width || y >= dev->height || w == 0 || img->height == 0)
+		return;
+
+	uint16_t vis_w = (x + w - 1 >= dev->width) ? dev->width - x : w;
+	uint16_t vis_h = (y + img->height - 1 >= dev->height) ? dev->height - y : img->height;
+	uint32_t vis_px = (uint32_t)w * vis_h;		// Image pixels up to the last visible row
+	uint32_t pos = 0;							// Image pixel the next packet starts at
+	uint32_t i = 0;
+
+	ili_dev_set_address_window(dev, x, y, vis_w, vis_h);
+	while (i < img->length && pos < vis_px)
+	{
+		uint16_t header = img->data[i++];
+		uint8_t run = (header & ILI_RLE_RUN) != 0;
+		uint32_t n = (uint32_t)(header & ~ILI_RLE_RUN) + 1;
+		const uint16_t *src = &img->data[i];
+		i += run ? 1 : n;
+		if (i > img->length)
+			break;		// Truncated image
+		n = (n > vis_px - pos) ? vis_px - pos : n;
 
-	ili_fill_color(color, (uint32_t)width * (uint32_t)abs(y1 - y0 + 1));
+		if (vis_w == w)
+		{
+			// Whole rows are visible, the window wraps like the image does
+			_ili_rle_emit(dev, run, src, n);
+			pos += n;
+			continue;
+		}
+		// Cut the packet down to the visible columns of each row it covers
+		while (n > 0)
+		{
+			uint16_t col = pos % w;
+			uint32_t seg = (n < (uint32_t)(w - col)) ? n : (uint32_t)(w - col);
+			if (col < vis_w)
+				_ili_rle_emit(dev, run, src, (seg < (uint32_t)(vis_w - col)) ? seg : (uint32_t)(vis_w - col));
+			pos += seg;
+			n -= seg;
+			if (!run)
+				src += seg;
+		}
+	}
 }
 
 
 /**
- * Draw a pixel at a given position with `color`
+ * Draw a palette indexed image with its top-left corner at (x, y). The indexes are expanded
+ * through the palette into the temporary display buffer, and sent one buffer at a time.
+ * Parts outside the display are skipped.
+ * Images are drawn right away, even while a display list is recorded.
  * @param x Start col address
  * @param y Start row address
+ * @param img Image to draw
+ * @param palette `1 << img->bpp` RGB565 colors to draw with instead of img->palette, or NULL
  */
-void ili_draw_pixel(uint16_t x, uint16_t y, uint16_t color)
+void ili_dev_draw_image_indexed(ili_dev_t *dev, uint16_t x, uint16_t y, const ili_image_indexed_t *img, const uint16_t *palette)
 {
-	/*
-	* Why?: This function is mainly added in the driver so that  ui libraries can use it.
-	*/
+	uint16_t w = img->width;
+	uint8_t bpp = img->bpp;
+	if (x >= dev->width || y >= dev->height || w == 0 || img->height == 0)
+		return;
+	if (bpp != 1 && bpp != 2 && bpp != 4 && bpp != 8)
+		return;
+
+	const uint16_t *clut = palette ? palette : img->palette;
+	uint16_t vis_w = (x + w - 1 >= dev->width) ? dev->width - x : w;
+	uint16_t vis_h = (y + img->height - 1 >= dev->height) ? dev->height - y : img->height;
+	uint32_t stride = ((uint32_t)w * bpp + 7) >> 3;
+	uint8_t mask = (uint8_t)((1 << bpp) - 1);
+	uint32_t fill = 0;
+
+	ili_dev_set_address_window(dev, x, y, vis_w, vis_h);
+	// Buffers run across rows, the window wraps the same way
+	for (uint16_t row = 0; row < vis_h; row++)
+	{
+		const uint8_t *src = &img->data[row * stride];
+		if (bpp == 8)
+		{
+			for (uint16_t col = 0; col < vis_w; col++)
+			{
+				dev->tmp_disp_buffer[fill++] = clut[src[col]];
+				if (fill == ILI_TMP_DISP_BUF_PX_CNT)
+				{
+					ili_dev_draw_pixels_buffer(dev, dev->tmp_disp_buffer, fill);
+					fill = 0;
+				}
+			}
+			continue;
+		}
+		// Pixels are packed MSB first
+		uint8_t byte = 0;
+		uint8_t bits = 0;		// Bits of `byte` not expanded yet
+		for (uint16_t col = 0; col < vis_w; col++)
+		{
+			if (bits == 0)
+			{
+				byte = *src++;
+				bits = 8;
+			}
+			bits -= bpp;
+			dev->tmp_disp_buffer[fill++] = clut[(byte >> bits) & mask];
+			if (fill == ILI_TMP_DISP_BUF_PX_CNT)
+			{
+				ili_dev_draw_pixels_buffer(dev, dev->tmp_disp_buffer, fill);
+				fill = 0;
+			}
+		}
+	}
+	if (fill)
+		ili_dev_draw_pixels_buffer(dev, dev->tmp_disp_buffer, fill);
+}
+
+/* ---------------------- Alpha blending ---------------------- */
+/*
+ * Colors are blended as RGB565, each channel as (fg * a + bg * (32 - a)) >> 5, with the 8-bit
+ * alpha brought down to a = 0..32. ili_blend_color() is the reference, the span kernels below
+ * give the same result bit for bit: 8 pixels at a time with SSE2 or NEON on the host, two
+ * pixels per 32-bit load and store in plain C otherwise.
+ */
+
+/* 8-bit alpha to the 0..32 weight of the kernels, 255 gives 32 */
+#define _ILI_ALPHA5(alpha)  (((uint32_t)(alpha) + 4) >> 3)
+
+/*
+ * RGB565 spread over 32 bits as 0x07E0F81F: green moves to the upper half, so each channel has
+ * room for a product with a 0..32 weight and blue, red and green are blended with one multiply
+ */
+static inline uint32_t _ili_spread(uint16_t color)
+{
+	return ((uint32_t)color | ((uint32_t)color << 16)) & 0x07E0F81FUL;
+}
+
+static inline uint16_t _ili_unspread(uint32_t spread)
+{
+	spread &= 0x07E0F81FUL;
+	return (uint16_t)(spread | (spread >> 16));
+}
+
+static inline uint16_t _ili_blend_px(uint16_t fg, uint16_t bg, uint32_t a)
+{
+	return _ili_unspread((_ili_spread(fg) * a + _ili_spread(bg) * (32 - a)) >> 5);
+}
+
+#if defined(__SSE2__)
+/* One channel of 8 pixels, already shifted down to bit 0 */
+static inline __m128i _ili_blend_ch8(__m128i fg, __m128i bg, __m128i a, __m128i inv_a)
+{
+	return _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(fg, a), _mm_mullo_epi16(bg, inv_a)), 5);
+}
+
+static inline __m128i _ili_blend8(__m128i fg, __m128i bg, __m128i a, __m128i inv_a)
+{
+	const __m128i mask_g = _mm_set1_epi16(0x3F);
+	const __m128i mask_b = _mm_set1_epi16(0x1F);
+	__m128i r = _ili_blend_ch8(_mm_srli_epi16(fg, 11), _mm_srli_epi16(bg, 11), a, inv_a);
+	__m128i g = _ili_blend_ch8(_mm_and_si128(_mm_srli_epi16(fg, 5), mask_g), _mm_and_si128(_mm_srli_epi16(bg, 5), mask_g), a, inv_a);
+	__m128i b = _ili_blend_ch8(_mm_and_si128(fg, mask_b), _mm_and_si128(bg, mask_b), a, inv_a);
+	return _mm_or_si128(_mm_or_si128(_mm_slli_epi16(r, 11), _mm_slli_epi16(g, 5)), b);
+}
+#elif defined(__ARM_NEON)
+static inline uint16x8_t _ili_blend_ch8(uint16x8_t fg, uint16x8_t bg, uint16x8_t a, uint16x8_t inv_a)
+{
+	return vshrq_n_u16(vmlaq_u16(vmulq_u16(fg, a), bg, inv_a), 5);
+}
+
+static inline uint16x8_t _ili_blend8(uint16x8_t fg, uint16x8_t bg, uint16x8_t a, uint16x8_t inv_a)
+{
+	const uint16x8_t mask_g = vdupq_n_u16(0x3F);
+	const uint16x8_t mask_b = vdupq_n_u16(0x1F);
+	uint16x8_t r = _ili_blend_ch8(vshrq_n_u16(fg, 11), vshrq_n_u16(bg, 11), a, inv_a);
+	uint16x8_t g = _ili_blend_ch8(vandq_u16(vshrq_n_u16(fg, 5), mask_g), vandq_u16(vshrq_n_u16(bg, 5), mask_g), a, inv_a);
+	uint16x8_t b = _ili_blend_ch8(vandq_u16(fg, mask_b), vandq_u16(bg, mask_b), a, inv_a);
+	return vorrq_u16(vorrq_u16(vshlq_n_u16(r, 11), vshlq_n_u16(g, 5)), b);
+}
+#endif
+
+/* Blend `color` with a constant `alpha` over `n` pixels of `dst` */
+static void _ili_blend_span_color(uint16_t *dst, uint16_t color, uint8_t alpha, uint32_t n)
+{
+	uint32_t a = _ILI_ALPHA5(alpha);
+	uint32_t i = 0;
+
+#if defined(__SSE2__)
+	const __m128i fg8 = _mm_set1_epi16((int16_t)color);
+	const __m128i a8 = _mm_set1_epi16((int16_t)a);
+	const __m128i inv_a8 = _mm_set1_epi16((int16_t)(32 - a));
+	for (; i + 8 <= n; i += 8)
+	{
+		__m128i bg = _mm_loadu_si128((const __m128i *)(dst + i));
+		_mm_storeu_si128((__m128i *)(dst + i), _ili_blend8(fg8, bg, a8, inv_a8));
+	}
+#elif defined(__ARM_NEON)
+	const uint16x8_t fg8 = vdupq_n_u16(color);
+	const uint16x8_t a8 = vdupq_n_u16((uint16_t)a);
+	const uint16x8_t inv_a8 = vdupq_n_u16((uint16_t)(32 - a));
+	for (; i + 8 <= n; i += 8)
+	{
+		vst1q_u16(dst + i, _ili_blend8(fg8, vld1q_u16(dst + i), a8, inv_a8));
+	}
+#endif
+
+	// The foreground part is the same for every pixel
+	uint32_t fg = _ili_spread(color) * a;
+	uint32_t inv_a = 32 - a;
+	if (i < n && ((uintptr_t)(dst + i) & 2))
+	{
+		dst[i] = _ili_unspread((fg + _ili_spread(dst[i]) * inv_a) >> 5);
+		i++;
+	}
+	for (; i + 2 <= n; i += 2)
+	{
+		uint32_t pair;
+		memcpy(&pair, dst + i, sizeof(pair));
+		uint16_t lo = _ili_unspread((fg + _ili_spread((uint16_t)pair) * inv_a) >> 5);
+		uint16_t hi = _ili_unspread((fg + _ili_spread((uint16_t)(pair >> 16)) * inv_a) >> 5);
+		pair = (uint32_t)lo | ((uint32_t)hi << 16);
+		memcpy(dst + i, &pair, sizeof(pair));
+	}
+	if (i < n)
+		dst[i] = _ili_unspread((fg + _ili_spread(dst[i]) * inv_a) >> 5);
+}
+
+/* Blend `n` pixels of `src`, each with its own alpha, over `n` pixels of `dst` */
+static void _ili_blend_span_map(uint16_t *dst, const uint16_t *src, const uint8_t *alpha, uint32_t n)
+{
+	uint32_t i = 0;
+
+#if defined(__SSE2__)
+	const __m128i k4 = _mm_set1_epi16(4);
+	const __m128i k32 = _mm_set1_epi16(32);
+	for (; i + 8 <= n; i += 8)
+	{
+		__m128i a = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(alpha + i)), _mm_setzero_si128());
+		a = _mm_srli_epi16(_mm_add_epi16(a, k4), 3);
+		__m128i fg = _mm_loadu_si128((const __m128i *)(src + i));
+		__m128i bg = _mm_loadu_si128((const __m128i *)(dst + i));
+		_mm_storeu_si128((__m128i *)(dst + i), _ili_blend8(fg, bg, a, _mm_sub_epi16(k32, a)));
+	}
+#elif defined(__ARM_NEON)
+	const uint16x8_t k4 = vdupq_n_u16(4);
+	const uint16x8_t k32 = vdupq_n_u16(32);
+	for (; i + 8 <= n; i += 8)
+	{
+		uint16x8_t a = vshrq_n_u16(vaddq_u16(vmovl_u8(vld1_u8(alpha + i)), k4), 3);
+		vst1q_u16(dst + i, _ili_blend8(vld1q_u16(src + i), vld1q_u16(dst + i), a, vsubq_u16(k32, a)));
+	}
+#endif
+
+	if (i < n && ((uintptr_t)(dst + i) & 2))
+	{
+		dst[i] = _ili_blend_px(src[i], dst[i], _ILI_ALPHA5(alpha[i]));
+		i++;
+	}
+	for (; i + 2 <= n; i += 2)
+	{
+		uint32_t fg;
+		uint32_t bg;
+		memcpy(&fg, src + i, sizeof(fg));	// `src` may be off by one pixel from `dst`
+		memcpy(&bg, dst + i, sizeof(bg));
+		uint16_t lo = _ili_blend_px((uint16_t)fg, (uint16_t)bg, _ILI_ALPHA5(alpha[i]));
+		uint16_t hi = _ili_blend_px((uint16_t)(fg >> 16), (uint16_t)(bg >> 16), _ILI_ALPHA5(alpha[i + 1]));
+		bg = (uint32_t)lo | ((uint32_t)hi << 16);
+		memcpy(dst + i, &bg, sizeof(bg));
+	}
+	if (i < n)
+		dst[i] = _ili_blend_px(src[i], dst[i], _ILI_ALPHA5(alpha[i]));
+}
+
 
-	ili_set_address_window(x, y, 1, 1);
-    _ILI_DC_DATA();
-    _ILI_WRITE8((uint8_t)(color >> 8));
-    _ILI_WRITE8((uint8_t)color);
+/**
+ * Blend two RGB565 colors. This is the reference of all the blending functions, they give
+ * the same result pixel for pixel.
+ * @param fg Foreground color
+ * @param bg Background color
+ * @param alpha Opacity of `fg`, 0 (only `bg`) to 255 (only `fg`)
+ * @return Blended color
+ */
+uint16_t ili_blend_color(uint16_t fg, uint16_t bg, uint8_t alpha)
+{
+	uint32_t a = _ILI_ALPHA5(alpha);
+	uint32_t r = ((uint32_t)(fg >> 11) * a + (uint32_t)(bg >> 11) * (32 - a)) >> 5;
+	uint32_t g = ((uint32_t)((fg >> 5) & 0x3F) * a + (uint32_t)((bg >> 5) & 0x3F) * (32 - a)) >> 5;
+	uint32_t b = ((uint32_t)(fg & 0x1F) * a + (uint32_t)(bg & 0x1F) * (32 - a)) >> 5;
+	return (uint16_t)((r << 11) | (g << 5) | b);
 }
 
 
+/**
+ * Blend `color` with a constant `alpha` over a `w`x`h` area of a RAM buffer, e.g. a strip of
+ * ili_render_strips() or a framebuffer, before it's sent.
+ * @param buf First pixel of the area
+ * @param stride Number of pixels between the starts of two rows of `buf`
+ * @param w Width of the area
+ * @param h Height of the area
+ * @param color 16-bit RGB565 color
+ * @param alpha Opacity of `color`, 0 to 255
+ */
+void ili_blend_fill_buffer(uint16_t *buf, uint32_t stride, uint16_t w, uint16_t h, uint16_t color, uint8_t alpha)
+{
+	if (stride == w)
+	{
+		_ili_blend_span_color(buf, color, alpha, (uint32_t)w * h);
+		return;
+	}
+	for (uint16_t row = 0; row < h; row++)
+	{
+		_ili_blend_span_color(buf, color, alpha, w);
+		buf += stride;
+	}
+}
+
 
 /**
- * Rotate the display clockwise or anti-clockwie set by `rotation`
- * @param rotation Type of rotation. Supported values 0, 1, 2, 3
+ * Blend a `w`x`h` bitmap with an alpha value per pixel over the same sized area of a RAM buffer,
+ * e.g. an anti-aliased icon over a strip of ili_render_strips().
+ * @param buf First pixel of the area
+ * @param stride Number of pixels between the starts of two rows of `buf`
+ * @param w Width of the bitmap
+ * @param h Height of the bitmap
+ * @param bitmap w*h RGB565 pixels, row by row
+ * @param alpha w*h opacities (0 to 255) of the bitmap pixels, row by row
  */
-void ili_rotate_display(uint8_t rotation)
+void ili_blend_bitmap_buffer(uint16_t *buf, uint32_t stride, uint16_t w, uint16_t h, const uint16_t *bitmap, const uint8_t *alpha)
 {
-    /*
-    *(uint8_t)rotation: Rotation Type
-    *         0 : Default landscape
-    *         1 : Potrait 1
-    *         2 : Landscape 2
-    *         3 : Potrait 2
-    */
+	if (stride == w)
+	{
+		_ili_blend_span_map(buf, bitmap, alpha, (uint32_t)w * h);
+		return;
+	}
+	for (uint16_t row = 0; row < h; row++)
+	{
+		_ili_blend_span_map(buf, bitmap, alpha, w);
+		buf += stride;
+		bitmap += w;
+		alpha += w;
+	}
+}
 
-//    uint16_t new_height = 240;
-//    uint16_t new_width = 320;
 
-	uint16_t new_height = 320;
-	uint16_t new_width = 240;
+/**
+ * Fill a rectangular area with `color` seen through with `alpha` over a plain `bg_color`.
+ * Before filling, performs area bound checking
+ * @param x Start col address
+ * @param y Start row address
+ * @param w Width of rectangle
+ * @param h Height of rectangle
+ * @param color 16-bit RGB565 color
+ * @param alpha Opacity of `color`, 0 to 255
+ * @param bg_color 16-bit RGB565 color of the area below
+ */
+void ili_dev_fill_rect_alpha(ili_dev_t *dev, uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color, uint8_t alpha, uint16_t bg_color)
+{
+	ili_dev_fill_rect(dev, x, y, w, h, ili_blend_color(color, bg_color, alpha));
+}
 
-    switch (rotation)
-    {
-        case 0:
-            _ili_write_command_8bit(ILI_MADCTL);		//Memory Access Control
-            _ili_write_data_8bit(0x40 | ILI_MAD_COLOR_ORDER);				//MX: 1, MY: 0, MV: 0	(Portrait 1. Default)
-            g_ili_tftheight = new_height;
-            g_ili_tftwidth = new_width;
-            break;
-        case 1:
-            _ili_write_command_8bit(ILI_MADCTL);		//Memory Access Control
-            _ili_write_data_8bit(0x20 | ILI_MAD_COLOR_ORDER);				//MX: 0, MY: 0, MV: 1	(Landscape 1)
-            g_ili_tftheight = new_width;
-            g_ili_tftwidth = new_height;
-            break;
-        case 2:
-            _ili_write_command_8bit(ILI_MADCTL);		//Memory Access Control
-            _ili_write_data_8bit(0x80 | ILI_MAD_COLOR_ORDER);				//MX: 0, MY: 1, MV: 0	(Portrait 2)
-            g_ili_tftheight = new_height;
-            g_ili_tftwidth = new_width;
-            break;
-        case 3:
-            _ili_write_command_8bit(ILI_MADCTL);		//Memory Access Control
-            _ili_write_data_8bit(0xE0 | ILI_MAD_COLOR_ORDER);				//MX: 1, MY: 1, MV: 1	(Landscape 2)
-            g_ili_tftheight = new_width;
-            g_ili_tftwidth = new_height;
-            break;
-    }
+
+/**
+ * Draw a `w`x`h` bitmap with an alpha value per pixel over a plain `bg_color`, with its
+ * top-left corner at (x, y). Rows are blended into the temporary display buffer and sent
+ * one buffer at a time. Parts outside the display are skipped.
+ * Bitmaps with alpha are drawn right away, even while a display list is recorded.
+ * @param x Start col address
+ * @param y Start row address
+ * @param w Width of the bitmap
+ * @param h Height of the bitmap
+ * @param bitmap w*h RGB565 pixels, row by row
+ * @param alpha w*h opacities (0 to 255) of the bitmap pixels, row by row
+ * @param bg_color 16-bit RGB565 color below the bitmap
+ */
+void ili_dev_draw_bitmap_alpha(ili_dev_t *dev, uint16_t x, uint16_t y, uint16_t w, uint16_t h, const uint16_t *bitmap,
+										   const uint8_t *alpha, uint16_t bg_color)
+{
+	if (x >= dev->width || y >= dev->height || w == 0 || h == 0)
+		return;
+
+	uint16_t vis_w = (x + w - 1 >= dev->width) ? dev->width - x : w;
+	uint16_t vis_h = (y + h - 1 >= dev->height) ? dev->height - y : h;
+
+	ili_dev_set_address_window(dev, x, y, vis_w, vis_h);
+	for (uint16_t row = 0; row < vis_h; row++)
+	{
+		const uint16_t *src = bitmap + (uint32_t)row * w;
+		const uint8_t *src_alpha = alpha + (uint32_t)row * w;
+		for (uint16_t col = 0; col < vis_w; )
+		{
+			uint16_t n = vis_w - col;
+			n = (n > ILI_TMP_DISP_BUF_PX_CNT) ? ILI_TMP_DISP_BUF_PX_CNT : n;
+			for (uint16_t i = 0; i < n; i++)
+				dev->tmp_disp_buffer[i] = bg_color;
+			_ili_blend_span_map(dev->tmp_disp_buffer, src + col, src_alpha + col, n);
+			ili_dev_draw_pixels_buffer(dev, dev->tmp_disp_buffer, n);
+			col += n;
+		}
+	}
 }
 
-uint8_t ili_display_get_rotation()
+
+/* ---------------------- Pixel format conversion ---------------------- */
+/*
+ * 24-bit colors are brought down to RGB565 channel by channel as (c + d) >> 3 for red and blue
+ * and (c + d / 2) >> 2 for green, capped at the channel maximum. `d` is 0 when truncating and
+ * half the 4x4 Bayer threshold of the pixel position when dithering, so a smooth gradient turns
+ * into a fine fixed pattern instead of bands, and the pattern stays put when an image is drawn
+ * in pieces. SSE2 and NEON convert 8 pixels at a time with the same result as the plain C loop.
+ */
+
+static const uint8_t g_ili_bayer4[4][4] = {
+	{ 0,  8,  2, 10},
+	{12,  4, 14,  6},
+	{ 3, 11,  1,  9},
+	{15,  7, 13,  5}
+};
+
+static inline uint16_t _ili_byteswap16(uint16_t c)
 {
-	return g_rotation;
+	return (uint16_t)((c << 8) | (c >> 8));
 }
 
-void ili_get_display_size(uint16_t *width, uint16_t *height, uint8_t *rotation)
+/*
+ * Plain C conversion of `n` pixels `step` bytes apart, with the channels at byte offsets `r`, `g`
+ * and `b`. Inlined with constant `step` and `dither`, so each combination gets its own loop
+ */
+__attribute__((always_inline)) static inline void _ili_conv_span(uint16_t *dst, const uint8_t *p, uint32_t n,
+		uint32_t step, uint32_t r, uint32_t g, uint32_t b, const uint16_t *d_rb, const uint16_t *d_g, uint8_t dither)
+{
+	for (uint32_t i = 0; i < n; i++, p += step)
+	{
+		if (!dither)
+		{
+			dst[i] = (uint16_t)(((p[r] & 0xF8) << 8) | ((p[g] & 0xFC) << 3) | (p[b] >> 3));
+			continue;
+		}
+		uint32_t r5 = (p[r] + d_rb[i & 3]) >> 3;
+		uint32_t g6 = (p[g] + d_g[i & 3]) >> 2;
+		uint32_t b5 = (p[b] + d_rb[i & 3]) >> 3;
+		// Only values close to 255 go past the maximum, by one
+		r5 -= r5 >> 5;
+		g6 -= g6 >> 6;
+		b5 -= b5 >> 5;
+		dst[i] = (uint16_t)((r5 << 11) | (g6 << 5) | b5);
+	}
+}
+
+#if defined(__SSE2__)
+/* One channel of 8 pixels held as 32-bit lanes in `lo` and `hi`, at bit `sh`, to 16-bit lanes */
+static inline __m128i _ili_channel8(__m128i lo, __m128i hi, __m128i sh)
+{
+	const __m128i mask8 = _mm_set1_epi32(0xFF);
+	return _mm_packs_epi32(_mm_and_si128(_mm_srl_epi32(lo, sh), mask8), _mm_and_si128(_mm_srl_epi32(hi, sh), mask8));
+}
+
+/* 8 pixels as 32-bit lanes in `lo` and `hi` to RGB565 */
+static inline __m128i _ili_conv8(__m128i lo, __m128i hi, __m128i r_sh, __m128i b_sh, __m128i d_rb, __m128i d_g)
+{
+	__m128i r = _ili_channel8(lo, hi, r_sh);
+	__m128i g = _ili_channel8(lo, hi, _mm_cvtsi32_si128(8));
+	__m128i b = _ili_channel8(lo, hi, b_sh);
+	r = _mm_min_epi16(_mm_srli_epi16(_mm_add_epi16(r, d_rb), 3), _mm_set1_epi16(31));
+	g = _mm_min_epi16(_mm_srli_epi16(_mm_add_epi16(g, d_g), 2), _mm_set1_epi16(63));
+	b = _mm_min_epi16(_mm_srli_epi16(_mm_add_epi16(b, d_rb), 3), _mm_set1_epi16(31));
+	return _mm_or_si128(_mm_or_si128(_mm_slli_epi16(r, 11), _mm_slli_epi16(g, 5)), b);
+}
+
+/* 4 pixels of 3 bytes from `p` as 32-bit lanes, reads 16 bytes */
+static inline __m128i _ili_gather888(const uint8_t *p)
+{
+	__m128i v = _mm_loadu_si128((const __m128i *)p);
+	__m128i px = _mm_and_si128(v, _mm_set_epi32(0, 0, 0, -1));
+	px = _mm_or_si128(px, _mm_and_si128(_mm_slli_si128(v, 1), _mm_set_epi32(0, 0, -1, 0)));
+	px = _mm_or_si128(px, _mm_and_si128(_mm_slli_si128(v, 2), _mm_set_epi32(0, -1, 0, 0)));
+	return _mm_or_si128(px, _mm_and_si128(_mm_slli_si128(v, 3), _mm_set_epi32(-1, 0, 0, 0)));
+}
+#elif defined(__ARM_NEON)
+static inline uint16x8_t _ili_conv8(uint8x8_t r8, uint8x8_t g8, uint8x8_t b8, uint16x8_t d_rb, uint16x8_t d_g)
 {
-	*rotation = g_rotation;
-	*width = g_ili_tftwidth;
-	*height = g_ili_tftheight;
+	uint16x8_t r = vminq_u16(vshrq_n_u16(vaddq_u16(vmovl_u8(r8), d_rb), 3), vdupq_n_u16(31));
+	uint16x8_t g = vminq_u16(vshrq_n_u16(vaddq_u16(vmovl_u8(g8), d_g), 2), vdupq_n_u16(63));
+	uint16x8_t b = vminq_u16(vshrq_n_u16(vaddq_u16(vmovl_u8(b8), d_rb), 3), vdupq_n_u16(31));
+	return vorrq_u16(vorrq_u16(vshlq_n_u16(r, 11), vshlq_n_u16(g, 5)), b);
 }
+#endif
+
 
 /**
- * Initialize the display driver
+ * Convert `n` pixels of one row of a 24-bit image to RGB565. With ILI_CONV_DITHER the
+ * pixels get the ordered dither pattern of display position (x, y) onwards.
+ * @param dst `n` RGB565 pixels
+ * @param src `n` pixels in `format`
+ * @param n Number of pixels
+ * @param format ILI_FMT_RGB888, ILI_FMT_BGR888 or ILI_FMT_ARGB8888
+ * @param flags ILI_CONV_DITHER, ILI_CONV_SWAP_RB, ILI_CONV_BYTESWAP or 0
+ * @param x Display column of the first pixel, only used with ILI_CONV_DITHER
+ * @param y Display row of the pixels, only used with ILI_CONV_DITHER
  */
-#define _INIT_MODE 1
-void ili_init()
+void ili_convert_to_rgb565(uint16_t *dst, const void *src, uint32_t n, uint8_t format, uint8_t flags, uint16_t x, uint16_t y)
 {
-// Hardware reset is not mandatory if software rest is done
-#if defined(ILI_PLATFORM_RST_LOW) && defined(ILI_PLATFORM_RST_HIGH)
-    ILI_PLATFORM_RST_HIGH();
-    ili_platform_delay(5);
-    ILI_PLATFORM_RST_LOW();
-    ili_platform_delay(10);
-    ILI_PLATFORM_RST_HIGH();
-#else
-	_ili_write_command_8bit(ILI_SWRESET);
+	const uint8_t *p = (const uint8_t *)src;
+	uint32_t step = (format == ILI_FMT_ARGB8888) ? 4 : 3;
+	// Byte offsets of the channels in a pixel, ARGB8888 words are in native byte order
+	uint32_t r = 0, g = 1, b = 2;
+	if (format != ILI_FMT_RGB888)
+	{
+		r = 2;
+		b = 0;
+	}
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+	if (format == ILI_FMT_ARGB8888)
+	{
+		r = 1;
+		g = 2;
+		b = 3;
+	}
 #endif
-	ili_platform_delay(150);
-
-#if _INIT_MODE == 1
-	_ili_write_command_8bit(0xEF);
-	_ili_write_data_8bit(0x03);
-	_ili_write_data_8bit(0x80);
-	_ili_write_data_8bit(0x02);
-
-	_ili_write_command_8bit(0xCF);
-	_ili_write_data_8bit(0x00);
-	_ili_write_data_8bit(0XC1);
-	_ili_write_data_8bit(0X30);
-
-	_ili_write_command_8bit(0xED);
-	_ili_write_data_8bit(0x64);
-	_ili_write_data_8bit(0x03);
-	_ili_write_data_8bit(0X12);
-	_ili_write_data_8bit(0X81);
-
-	_ili_write_command_8bit(0xE8);
-	_ili_write_data_8bit(0x85);
-	_ili_write_data_8bit(0x00);
-	_ili_write_data_8bit(0x78);
-
-	_ili_write_command_8bit(0xCB);
-	_ili_write_data_8bit(0x39);
-	_ili_write_data_8bit(0x2C);
-	_ili_write_data_8bit(0x00);
-	_ili_write_data_8bit(0x34);
-	_ili_write_data_8bit(0x02);
-
-	_ili_write_command_8bit(0xF7);
-	_ili_write_data_8bit(0x20);
-
-	_ili_write_command_8bit(0xEA);
-	_ili_write_data_8bit(0x00);
-	_ili_write_data_8bit(0x00);
-
-	_ili_write_command_8bit(ILI_PWCTR1);    //Power control
-	_ili_write_data_8bit(0x23);   //VRH[5:0]
-
-	_ili_write_command_8bit(ILI_PWCTR2);    //Power control
-	_ili_write_data_8bit(0x10);   //SAP[2:0];BT[3:0]
-
-	_ili_write_command_8bit(ILI_VMCTR1);    //VCM control
-	_ili_write_data_8bit(0x3e);
-	_ili_write_data_8bit(0x28);
-
-	_ili_write_command_8bit(ILI_VMCTR2);    //VCM control2
-	_ili_write_data_8bit(0x86);  //--
-
-	_ili_write_command_8bit(ILI_MADCTL);    // Memory Access Control
-	_ili_write_data_8bit(0x40 | ILI_MAD_COLOR_ORDER); // Rotation 0 (portrait mode) //40 = RGB, 48 = BGR
-
-
-	_ili_write_command_8bit(ILI_PIXFMT);
-	_ili_write_data_8bit(0x55);
-
-	_ili_write_command_8bit(ILI_FRMCTR1);
-	_ili_write_data_8bit(0x00);
-	_ili_write_data_8bit(0x13); // 0x18 79Hz, 0x1B default 70Hz, 0x13 100Hz
-
-	_ili_write_command_8bit(ILI_DFUNCTR);    // Display Function Control
-	_ili_write_data_8bit(0x08);
-	_ili_write_data_8bit(0x82);
-	_ili_write_data_8bit(0x27);
-
-	_ili_write_command_8bit(0xF2);    // 3Gamma Function Disable
-	_ili_write_data_8bit(0x00);
-
-	_ili_write_command_8bit(ILI_GAMMASET);    //Gamma curve selected
-	_ili_write_data_8bit(0x01);
-
-	_ili_write_command_8bit(ILI_GMCTRP1);    //Set Gamma
-	_ili_write_data_8bit(0x0F);
-	_ili_write_data_8bit(0x31);
-	_ili_write_data_8bit(0x2B);
-	_ili_write_data_8bit(0x0C);
-	_ili_write_data_8bit(0x0E);
-	_ili_write_data_8bit(0x08);
-	_ili_write_data_8bit(0x4E);
-	_ili_write_data_8bit(0xF1);
-	_ili_write_data_8bit(0x37);
-	_ili_write_data_8bit(0x07);
-	_ili_write_data_8bit(0x10);
-	_ili_write_data_8bit(0x03);
-	_ili_write_data_8bit(0x0E);
-	_ili_write_data_8bit(0x09);
-	_ili_write_data_8bit(0x00);
-
-	_ili_write_command_8bit(ILI_GMCTRN1);    //Set Gamma
-	_ili_write_data_8bit(0x00);
-	_ili_write_data_8bit(0x0E);
-	_ili_write_data_8bit(0x14);
-	_ili_write_data_8bit(0x03);
-	_ili_write_data_8bit(0x11);
-	_ili_write_data_8bit(0x07);
-	_ili_write_data_8bit(0x31);
-	_ili_write_data_8bit(0xC1);
-	_ili_write_data_8bit(0x48);
-	_ili_write_data_8bit(0x08);
-	_ili_write_data_8bit(0x0F);
-	_ili_write_data_8bit(0x0C);
-	_ili_write_data_8bit(0x31);
-	_ili_write_data_8bit(0x36);
-	_ili_write_data_8bit(0x0F);
-
-	_ili_write_command_8bit(ILI_SLPOUT);    //Exit Sleep
-	_ili_write_data_8bit(0x80);
-	ili_platform_delay(120);
-
-	_ili_write_command_8bit(ILI_DISPON);    //Display on
-	_ili_write_data_8bit(0x80);
-	ili_platform_delay(120);
-
-#elif _INIT_MODE == 2
-	_ili_write_command_8bit(0xCF);
-	_ili_write_data_8bit(0x00);
-	_ili_write_data_8bit(0XC1);
-	_ili_write_data_8bit(0X30);
-
-	_ili_write_command_8bit(0xED);
-	_ili_write_data_8bit(0x64);
-	_ili_write_data_8bit(0x03);
-	_ili_write_data_8bit(0X12);
-	_ili_write_data_8bit(0X81);
-
-	_ili_write_command_8bit(0xE8);
-	_ili_write_data_8bit(0x85);
-	_ili_write_data_8bit(0x00);
-	_ili_write_data_8bit(0x78);
-
-	_ili_write_command_8bit(0xCB);
-	_ili_write_data_8bit(0x39);
-	_ili_write_data_8bit(0x2C);
-	_ili_write_data_8bit(0x00);
-	_ili_write_data_8bit(0x34);
-	_ili_write_data_8bit(0x02);
-
-	_ili_write_command_8bit(0xF7);
-	_ili_write_data_8bit(0x20);
-
-	_ili_write_command_8bit(0xEA);
-	_ili_write_data_8bit(0x00);
-	_ili_write_data_8bit(0x00);
-
-	_ili_write_command_8bit(ILI_PWCTR1); //Power control
-	_ili_write_data_8bit(0x10); //VRH[5:0]
-
-	_ili_write_command_8bit(ILI_PWCTR2); //Power control
-	_ili_write_data_8bit(0x00); //SAP[2:0];BT[3:0]
-
-	_ili_write_command_8bit(ILI_VMCTR1); //VCM control
-	_ili_write_data_8bit(0x30);
-	_ili_write_data_8bit(0x30);
-
-	_ili_write_command_8bit(ILI_VMCTR2); //VCM control2
-	_ili_write_data_8bit(0xB7); //--
-
-	_ili_write_command_8bit(ILI_PIXFMT);
-	_ili_write_data_8bit(0x55);
-
-	_ili_write_command_8bit(0x36); // Memory Access Control
-	_ili_write_data_8bit(0x08); // Rotation 0 (portrait mode)
-
-	_ili_write_command_8bit(ILI_FRMCTR1);
-	_ili_write_data_8bit(0x00);
-	_ili_write_data_8bit(0x1A);
-
-	_ili_write_command_8bit(ILI_DFUNCTR); // Display Function Control
-	_ili_write_data_8bit(0x08);
-	_ili_write_data_8bit(0x82);
-	_ili_write_data_8bit(0x27);
-
-	_ili_write_command_8bit(0xF2); // 3Gamma Function Disable
-	_ili_write_data_8bit(0x00);
-
-	_ili_write_command_8bit(0x26); //Gamma curve selected
-	_ili_write_data_8bit(0x01);
-
-	_ili_write_command_8bit(0xE0); //Set Gamma
-	_ili_write_data_8bit(0x0F);
-	_ili_write_data_8bit(0x2A);
-	_ili_write_data_8bit(0x28);
-	_ili_write_data_8bit(0x08);
-	_ili_write_data_8bit(0x0E);
-	_ili_write_data_8bit(0x08);
-	_ili_write_data_8bit(0x54);
-	_ili_write_data_8bit(0xA9);
-	_ili_write_data_8bit(0x43);
-	_ili_write_data_8bit(0x0A);
-	_ili_write_data_8bit(0x0F);
-	_ili_write_data_8bit(0x00);
-	_ili_write_data_8bit(0x00);
-	_ili_write_data_8bit(0x00);
-	_ili_write_data_8bit(0x00);
-
-	_ili_write_command_8bit(0XE1); //Set Gamma
-	_ili_write_data_8bit(0x00);
-	_ili_write_data_8bit(0x15);
-	_ili_write_data_8bit(0x17);
-	_ili_write_data_8bit(0x07);
-	_ili_write_data_8bit(0x11);
-	_ili_write_data_8bit(0x06);
-	_ili_write_data_8bit(0x2B);
-	_ili_write_data_8bit(0x56);
-	_ili_write_data_8bit(0x3C);
-	_ili_write_data_8bit(0x05);
-	_ili_write_data_8bit(0x10);
-	_ili_write_data_8bit(0x0F);
-	_ili_write_data_8bit(0x3F);
-	_ili_write_data_8bit(0x3F);
-	_ili_write_data_8bit(0x0F);
-
-	_ili_write_command_8bit(0x2B);
-	_ili_write_data_8bit(0x00);
-	_ili_write_data_8bit(0x00);
-	_ili_write_data_8bit(0x01);
-	_ili_write_data_8bit(0x3f);
-
-	_ili_write_command_8bit(0x2A);
-	_ili_write_data_8bit(0x00);
-	_ili_write_data_8bit(0x00);
-	_ili_write_data_8bit(0x00);
-	_ili_write_data_8bit(0xef);
-
-	_ili_write_command_8bit(ILI_SLPOUT); //Exit Sleep
-	ili_platform_delay(120);
-
-	_ili_write_command_8bit(ILI_DISPON); //Display on
-	ili_platform_delay(120);
-#endif /* _INIT_MODE == 2 */
+	if (flags & ILI_CONV_SWAP_RB)
+	{
+		uint32_t tmp = r;
+		r = b;
+		b = tmp;
+	}
+
+	// Thresholds of the next 8 pixels, the pattern repeats every 4 columns
+	uint16_t d_rb[8] = {0};
+	uint16_t d_g[8] = {0};
+	if (flags & ILI_CONV_DITHER)
+	{
+		for (uint8_t k = 0; k < 8; k++)
+		{
+			d_rb[k] = g_ili_bayer4[y & 3][(x + k) & 3] >> 1;
+			d_g[k] = g_ili_bayer4[y & 3][(x + k) & 3] >> 2;
+		}
+	}
 
+	uint32_t i = 0;
+#if defined(__SSE2__)
+	const __m128i r_sh4 = _mm_cvtsi32_si128((int)r * 8);
+	const __m128i b_sh4 = _mm_cvtsi32_si128((int)b * 8);
+	const __m128i d_rb8 = _mm_loadu_si128((const __m128i *)d_rb);
+	const __m128i d_g8 = _mm_loadu_si128((const __m128i *)d_g);
+	// 3-byte pixels are gathered 16 bytes at a time, the second read reaches 2 pixels past the 8th
+	uint32_t reach = (step == 4) ? 8 : 10;
+	for (; i + reach <= n; i += 8, p += 8 * step)
+	{
+		__m128i lo, hi;
+		if (step == 4)
+		{
+			lo = _mm_loadu_si128((const __m128i *)p);
+			hi = _mm_loadu_si128((const __m128i *)(p + 16));
+		}
+		else
+		{
+			lo = _ili_gather888(p);
+			hi = _ili_gather888(p + 12);
+		}
+		__m128i c = _ili_conv8(lo, hi, r_sh4, b_sh4, d_rb8, d_g8);
+		if (flags & ILI_CONV_BYTESWAP)
+			c = _mm_or_si128(_mm_slli_epi16(c, 8), _mm_srli_epi16(c, 8));
+		_mm_storeu_si128((__m128i *)(dst + i), c);
+	}
+#elif defined(__ARM_NEON) && !defined(__ARM_BIG_ENDIAN)
+	const uint16x8_t d_rb8 = vld1q_u16(d_rb);
+	const uint16x8_t d_g8 = vld1q_u16(d_g);
+	for (; i + 8 <= n; i += 8, p += 8 * step)
+	{
+		// vld3/vld4 split the bytes of the pixels into one vector per byte position
+		uint8x8_t c0, c1, c2;
+		if (step == 4)
+		{
+			uint8x8x4_t v = vld4_u8(p);
+			c0 = v.val[0];
+			c1 = v.val[1];
+			c2 = v.val[2];
+		}
+		else
+		{
+			uint8x8x3_t v = vld3_u8(p);
+			c0 = v.val[0];
+			c1 = v.val[1];
+			c2 = v.val[2];
+		}
+		uint16x8_t c = (r == 0) ? _ili_conv8(c0, c1, c2, d_rb8, d_g8) : _ili_conv8(c2, c1, c0, d_rb8, d_g8);
+		if (flags & ILI_CONV_BYTESWAP)
+			c = vorrq_u16(vshlq_n_u16(c, 8), vshrq_n_u16(c, 8));
+		vst1q_u16(dst + i, c);
+	}
+#endif
 
+	if (i == n)
+		return;
+	// i is a multiple of 8 here, so the thresholds still start at d_rb[0]
+	if (step == 4)
+	{
+		if (flags & ILI_CONV_DITHER)
+			_ili_conv_span(dst + i, p, n - i, 4, r, g, b, d_rb, d_g, 1);
+		else
+			_ili_conv_span(dst + i, p, n - i, 4, r, g, b, d_rb, d_g, 0);
+	}
+	else
+	{
+		if (flags & ILI_CONV_DITHER)
+			_ili_conv_span(dst + i, p, n - i, 3, r, g, b, d_rb, d_g, 1);
+		else
+			_ili_conv_span(dst + i, p, n - i, 3, r, g, b, d_rb, d_g, 0);
+	}
+	if (flags & ILI_CONV_BYTESWAP)
+		ili_byteswap_buffer(dst + i, n - i);
+}
+
+
+/**
+ * Swap the red and blue channels of RGB565 pixels, RGB565 to BGR565 and back
+ * @param buf Pixels to swap in place
+ * @param n Number of pixels
+ */
+void ili_swap_rb_buffer(uint16_t *buf, uint32_t n)
+{
+	uint32_t i = 0;
+	if (i < n && ((uintptr_t)buf & 2))
+	{
+		buf[0] = (uint16_t)((buf[0] << 11) | (buf[0] & 0x07E0) | (buf[0] >> 11));
+		i++;
+	}
+	// Two pixels per 32-bit word, compilers vectorize this loop where they can
+	for (; i + 2 <= n; i += 2)
+	{
+		uint32_t pair;
+		memcpy(&pair, buf + i, sizeof(pair));
+		pair = ((pair & 0x001F001FUL) << 11) | (pair & 0x07E007E0UL) | ((pair >> 11) & 0x001F001FUL);
+		memcpy(buf + i, &pair, sizeof(pair));
+	}
+	if (i < n)
+		buf[i] = (uint16_t)((buf[i] << 11) | (buf[i] & 0x07E0) | (buf[i] >> 11));
+}
+
+
+/**
+ * Swap the two bytes of each pixel. For transfers that send the buffer byte by byte in memory
+ * order, e.g. DMA to an 8-bit bus on a little-endian MCU, or images stored high byte first.
+ * The driver's own functions send the high byte first already.
+ * @param buf Pixels to swap in place
+ * @param n Number of pixels
+ */
+void ili_byteswap_buffer(uint16_t *buf, uint32_t n)
+{
+	uint32_t i = 0;
+	if (i < n && ((uintptr_t)buf & 2))
+	{
+		buf[0] = _ili_byteswap16(buf[0]);
+		i++;
+	}
+	for (; i + 2 <= n; i += 2)
+	{
+		uint32_t pair;
+		memcpy(&pair, buf + i, sizeof(pair));
+		pair = ((pair & 0x00FF00FFUL) << 8) | ((pair >> 8) & 0x00FF00FFUL);
+		memcpy(buf + i, &pair, sizeof(pair));
+	}
+	if (i < n)
+		buf[i] = _ili_byteswap16(buf[i]);
+}
+
+
+/**
+ * Draw 24-bit pixels, e.g. a camera frame or a decoded image, converted to RGB565 one
+ * temporary display buffer at a time, red and blue swapped when ILI_MAD_COLOR_ORDER is ILI_MAD_RGB.
+ * Call ili_set_address_window() before calling this function; with ILI_CONV_DITHER the
+ * pattern follows the position in the address window, so an image sent in pieces has no seams.
+ * @param src `len` pixels in `format`
+ * @param len Number of pixels
+ * @param format ILI_FMT_RGB888, ILI_FMT_BGR888 or ILI_FMT_ARGB8888
+ * @param flags ILI_CONV_DITHER or 0
+ */
+void ili_dev_draw_pixels_rgb888(ili_dev_t *dev, const void *src, uint32_t len, uint8_t format, uint8_t flags)
+{
+	const uint8_t *p = (const uint8_t *)src;
+	uint32_t step = (format == ILI_FMT_ARGB8888) ? 4 : 3;
+	uint16_t col = dev->fb_buf ? dev->fb_col : dev->wp_col;
+	uint16_t page = dev->fb_buf ? dev->fb_page : dev->wp_page;
+	uint16_t sc = dev->fb_buf ? dev->fb_sc : dev->win_sc;
+	uint16_t ec = dev->fb_buf ? dev->fb_ec : dev->win_ec;
+
+#if ILI_MAD_COLOR_ORDER == ILI_MAD_RGB
+	flags |= ILI_CONV_SWAP_RB;
+#endif
+
+	while (len)
+	{
+		uint32_t n = (len > ILI_TMP_DISP_BUF_PX_CNT) ? ILI_TMP_DISP_BUF_PX_CNT : len;
+		// Dithered pieces end with the window row, so the next one starts with the right pattern
+		if ((flags & ILI_CONV_DITHER) && n > (uint32_t)(ec - col) + 1)
+			n = (uint32_t)(ec - col) + 1;
+		ili_convert_to_rgb565(dev->tmp_disp_buffer, p, n, format, flags, col, page);
+		ili_dev_draw_pixels_buffer(dev, dev->tmp_disp_buffer, n);
+		p += n * step;
+		len -= n;
+		col += (uint16_t)(n % ((uint32_t)(ec - sc) + 1));
+		page += (uint16_t)(n / ((uint32_t)(ec - sc) + 1));
+		if (col > ec)
+		{
+			col -= ec - sc + 1;
+			page++;
+		}
+	}
+}
+
+
+/*
+ * Same as `ili_fill_rect()` but does not do bound checking, so it's slightly faster
+ */
+void ili_dev_fill_rect_fast(ili_dev_t *dev, uint16_t x1, uint16_t y1, uint16_t w, uint16_t h, uint16_t color)
+{
+	if (dev->dl_rec)
+	{
+		_ili_dl_add(dev, ILI_DL_FILL, x1, y1, x1 + w - 1, y1 + h - 1, 0, color, NULL);
+		return;
+	}
+	ili_dev_set_address_window(dev, x1, y1, w, h);
+	ili_dev_fill_color(dev, color, (uint32_t)w * (uint32_t)h);
+}
+
+
+/**
+ * Fill the entire display (screen) with `color`
+ * @param color 16-bit RGB565 color
+ */
+void ili_dev_fill_screen(ili_dev_t *dev, uint16_t color)
+{
+	if (dev->dl_rec)
+	{
+		_ili_dl_add(dev, ILI_DL_FILL, 0, 0, dev->width - 1, dev->height - 1, 0, color, NULL);
+		return;
+	}
+	ili_dev_set_address_window(dev, 0, 0, dev->width, dev->height);
+	ili_dev_fill_color(dev, color, (uint32_t)dev->width * (uint32_t)dev->height);
+}
+
+
+/**
+ * Draw a rectangle
+*/
+void ili_dev_draw_rectangle(ili_dev_t *dev, uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color)
+{
+	// Perform bound checking
+	if (x >= dev->width || y >= dev->height || w == 0 || h == 0)
+		return;
+	if (x + w - 1 >= dev->width)
+		w = dev->width - x;
+	if (y + h - 1 >= dev->height)
+		h = dev->height - y;
+
+	_ili_draw_fast_h_line(dev, x, y, x+w-1, 1, color);
+	_ili_draw_fast_h_line(dev, x, y+h, x+w-1, 1, color);
+	_ili_draw_fast_v_line(dev, x, y, y+h-1, 1, color);
+	_ili_draw_fast_v_line(dev, x+w, y, y+h-1, 1, color);
+
+
+}
+
+/* ---------------------- Circles, ellipses, arcs ---------------------- */
+/*
+ * Curved shapes are drawn row by row. Every row is one or two horizontal spans, each sent
+ * as a single window, and the top and bottom halves mirror each other. Pixel (x, k) relative
+ * to the center is inside an rx, ry ellipse when its center is inside the ellipse with radii
+ * rx + 0.5 and ry + 0.5, the same pixels the midpoint algorithm picks for a circle.
+ */
+
+/* Incremental row walker: half width of each row, from the top row (k = ry) down to the center (k = 0) */
+typedef struct
+{
+	int64_t d;		// Midpoint decision variable of (x + 1, k). <= 0 means x + 1 is inside
+	int64_t a2;		// (2rx + 1)^2
+	int64_t b2;		// (2ry + 1)^2
+	int32_t x;
+	int32_t k;
+} _ili_ellipse_iter_t;
+
+static void _ili_ellipse_begin(_ili_ellipse_iter_t *it, uint16_t rx, uint16_t ry)
+{
+	int64_t a = 2 * (int64_t)rx + 1;
+	int64_t b = 2 * (int64_t)ry + 1;
+	it->a2 = a * a;
+	it->b2 = b * b;
+	it->x = 0;
+	it->k = ry;
+	// d(x + 1, k) = 4(x + 1)^2 b^2 + 4k^2 a^2 - a^2 b^2
+	it->d = 4 * it->b2 + 4 * (int64_t)ry * ry * it->a2 - it->a2 * it->b2;
+}
+
+/* Half width of row `it->k`, then moves to the next row */
+static int32_t _ili_ellipse_next(_ili_ellipse_iter_t *it)
+{
+	while (it->d <= 0)
+	{
+		it->x++;
+		it->d += 4 * it->b2 * (2 * (int64_t)it->x + 1);
+	}
+	int32_t hw = it->x;
+	// Down one row: 4a^2 ((k - 1)^2 - k^2)
+	it->d += 4 * it->a2 * (1 - 2 * (int64_t)it->k);
+	it->k--;
+	return hw;
+}
+
+/*
+ * Angular range of an arc. Directions are scaled by 1024, 0 degrees points right and angles
+ * grow clockwise
+ */
+typedef struct
+{
+	int32_t sx, sy;		// Start direction
+	int32_t ex, ey;		// End direction
+	uint8_t mode;		// 0: full circle, 1: up to 180 degrees, 2: more than 180 degrees
+} _ili_wedge_t;
+
+static uint8_t _ili_wedge_init(_ili_wedge_t *wg, int16_t start_angle, int16_t end_angle)
+{
+	int32_t sweep = (int32_t)end_angle - start_angle;
+	if (sweep == 0)
+		return 0;
+	if (sweep >= 360 || sweep <= -360)
+	{
+		wg->mode = 0;
+		return 1;
+	}
+	sweep = ((sweep % 360) + 360) % 360;
+
+	const float deg = 3.14159265f / 180.0f;
+	wg->sx = (int32_t)lroundf(cosf(start_angle * deg) * 1024.0f);
+	wg->sy = (int32_t)lroundf(sinf(start_angle * deg) * 1024.0f);
+	wg->ex = (int32_t)lroundf(cosf(end_angle * deg) * 1024.0f);
+	wg->ey = (int32_t)lroundf(sinf(end_angle * deg) * 1024.0f);
+	wg->mode = (sweep <= 180) ? 1 : 2;
+	return 1;
+}
+
+static inline uint8_t _ili_wedge_contains(const _ili_wedge_t *wg, int32_t dx, int32_t dy)
+{
+	// cross(a, b) > 0 when b is clockwise from a (y grows downwards)
+	int32_t after_start = wg->sx * dy - wg->sy * dx;
+	int32_t before_end = dx * wg->ey - dy * wg->ex;
+	if (wg->mode == 1)
+		return after_start >= 0 && before_end >= 0;
+	return !(after_start < 0 && before_end < 0);
+}
+
+/* Horizontal span from x0 to x1 (inclusive) on row y, clipped to the display */
+static void _ili_hspan(ili_dev_t *dev, int32_t x0, int32_t x1, int32_t y, uint16_t color)
+{
+	if (y < 0 || y >= dev->height)
+		return;
+	x0 = (x0 < 0) ? 0 : x0;
+	x1 = (x1 >= dev->width) ? dev->width - 1 : x1;
+	if (x1 < x0)
+		return;
+	ili_dev_fill_rect_fast(dev, x0, y, x1 - x0 + 1, 1, color);
+}
+
+/* Vertical span from y0 to y1 (inclusive) on column x, clipped to the display */
+static void _ili_vspan(ili_dev_t *dev, int32_t x, int32_t y0, int32_t y1, uint16_t color)
+{
+	if (x < 0 || x >= dev->width)
+		return;
+	y0 = (y0 < 0) ? 0 : y0;
+	y1 = (y1 >= dev->height) ? dev->height - 1 : y1;
+	if (y1 < y0)
+		return;
+	ili_dev_fill_rect_fast(dev, x, y0, 1, y1 - y0 + 1, color);
+}
+
+/* Same as _ili_hspan() but only the runs of pixels inside the wedge around (cx, cy) */
+static void _ili_hspan_wedge(ili_dev_t *dev, int32_t x0, int32_t x1, int32_t y, int32_t cx, int32_t cy, const _ili_wedge_t *wg, uint16_t color)
+{
+	if (wg->mode == 0)
+	{
+		_ili_hspan(dev, x0, x1, y, color);
+		return;
+	}
+	if (y < 0 || y >= dev->height)
+		return;
+	x0 = (x0 < 0) ? 0 : x0;
+	x1 = (x1 >= dev->width) ? dev->width - 1 : x1;
+
+	int32_t run_start = -1;
+	for (int32_t x = x0; x <= x1; x++)
+	{
+		if (_ili_wedge_contains(wg, x - cx, y - cy))
+		{
+			if (run_start < 0)
+				run_start = x;
+		}
+		else if (run_start >= 0)
+		{
+			ili_dev_fill_rect_fast(dev, run_start, y, x - run_start, 1, color);
+			run_start = -1;
+		}
+	}
+	if (run_start >= 0)
+		ili_dev_fill_rect_fast(dev, run_start, y, x1 - run_start + 1, 1, color);
+}
+
+/*
+ * Outline pixels of row k: from the end of the row above (`prev_hw` + 1) to `hw`, on both sides.
+ * `cx0` and `cx1` are the left and right centers, the same for ellipses, apart for rounded rectangles
+ */
+static void _ili_outline_row(ili_dev_t *dev, int32_t cx0, int32_t cx1, int32_t y, int32_t hw, int32_t prev_hw, uint16_t color)
+{
+	int32_t inner = (prev_hw + 1 < hw) ? prev_hw + 1 : hw;
+	if (inner == 0 || cx1 - cx0 + 2 * inner <= 1)
+	{
+		_ili_hspan(dev, cx0 - hw, cx1 + hw, y, color);
+		return;
+	}
+	_ili_hspan(dev, cx0 - hw, cx0 - inner, y, color);
+	_ili_hspan(dev, cx1 + inner, cx1 + hw, y, color);
+}
+
+
+/**
+ * Draw a filled ellipse
+ * @param x0 Center col address
+ * @param y0 Center row address
+ * @param rx Horizontal radius
+ * @param ry Vertical radius
+ * @param color 16-bit RGB565 color
+ */
+void ili_dev_fill_ellipse(ili_dev_t *dev, uint16_t x0, uint16_t y0, uint16_t rx, uint16_t ry, uint16_t color)
+{
+	_ili_ellipse_iter_t it;
+	_ili_ellipse_begin(&it, rx, ry);
+	for (int32_t k = ry; k >= 0; k--)
+	{
+		int32_t hw = _ili_ellipse_next(&it);
+		_ili_hspan(dev, (int32_t)x0 - hw, (int32_t)x0 + hw, (int32_t)y0 - k, color);
+		if (k)
+			_ili_hspan(dev, (int32_t)x0 - hw, (int32_t)x0 + hw, (int32_t)y0 + k, color);
+	}
+}
+
+
+/**
+ * Draw the 1 pixel outline of an ellipse
+ * @param x0 Center col address
+ * @param y0 Center row address
+ * @param rx Horizontal radius
+ * @param ry Vertical radius
+ * @param color 16-bit RGB565 color
+ */
+void ili_dev_draw_ellipse(ili_dev_t *dev, uint16_t x0, uint16_t y0, uint16_t rx, uint16_t ry, uint16_t color)
+{
+	_ili_ellipse_iter_t it;
+	int32_t cx = x0, cy = y0;
+	int32_t prev_hw = -1;
+	int32_t run_k = -1;		// First row of the current vertical run, -1 if none
+
+	_ili_ellipse_begin(&it, rx, ry);
+	for (int32_t k = ry; k >= 0; k--)
+	{
+		int32_t hw = _ili_ellipse_next(&it);
+		if (hw == prev_hw && hw > 0)
+		{
+			// One pixel per side, same column as the row above. Collect rows into a vertical run
+			if (run_k < 0)
+				run_k = k;
+		}
+		else
+		{
+			_ili_outline_row(dev, cx, cx, cy - k, hw, prev_hw, color);
+			if (k)
+				_ili_outline_row(dev, cx, cx, cy + k, hw, prev_hw, color);
+		}
+
+		// Send the run when its column ends, both halves in one window if it reaches the center row
+		if (run_k >= 0 && (k == 0 || hw != prev_hw))
+		{
+			int32_t run_end = (hw != prev_hw) ? k + 1 : k;
+			if (run_end == 0)
+			{
+				_ili_vspan(dev, cx - prev_hw, cy - run_k, cy + run_k, color);
+				_ili_vspan(dev, cx + prev_hw, cy - run_k, cy + run_k, color);
+			}
+			else
+			{
+				_ili_vspan(dev, cx - prev_hw, cy - run_k, cy - run_end, color);
+				_ili_vspan(dev, cx + prev_hw, cy - run_k, cy - run_end, color);
+				_ili_vspan(dev, cx - prev_hw, cy + run_end, cy + run_k, color);
+				_ili_vspan(dev, cx + prev_hw, cy + run_end, cy + run_k, color);
+			}
+			run_k = -1;
+		}
+		prev_hw = hw;
+	}
+}
+
+
+/**
+ * Draw a filled circle
+ * @param x0 Center col address
+ * @param y0 Center row address
+ * @param r Radius
+ * @param color 16-bit RGB565 color
+ */
+void ili_dev_fill_circle(ili_dev_t *dev, uint16_t x0, uint16_t y0, uint16_t r, uint16_t color)
+{
+	ili_dev_fill_ellipse(dev, x0, y0, r, r, color);
+}
+
+
+/**
+ * Draw the 1 pixel outline of a circle
+ * @param x0 Center col address
+ * @param y0 Center row address
+ * @param r Radius
+ * @param color 16-bit RGB565 color
+ */
+void ili_dev_draw_circle(ili_dev_t *dev, uint16_t x0, uint16_t y0, uint16_t r, uint16_t color)
+{
+	ili_dev_draw_ellipse(dev, x0, y0, r, r, color);
+}
+
+
+/**
+ * Draw a filled arc: the part of the ring between `r_inner` and `r_outer` from `start_angle` to
+ * `end_angle`. With `r_inner` 0 it's a sector (pie slice).
+ * Angles are in degrees, 0 points right and angles grow clockwise. A sweep of 360 or more is a full ring.
+ * @param x0 Center col address
+ * @param y0 Center row address
+ * @param r_outer Outer radius
+ * @param r_inner Inner radius, the ring is `r_outer - r_inner` pixels thick
+ * @param start_angle Start angle
+ * @param end_angle End angle
+ * @param color 16-bit RGB565 color
+ */
+void ili_dev_fill_arc(ili_dev_t *dev, uint16_t x0, uint16_t y0, uint16_t r_outer, uint16_t r_inner, int16_t start_angle, int16_t end_angle, uint16_t color)
+{
+	_ili_wedge_t wg;
+	_ili_ellipse_iter_t outer, inner;
+	int32_t cx = x0, cy = y0;
+
+	if (r_inner >= r_outer || !_ili_wedge_init(&wg, start_angle, end_angle))
+		return;
+
+	_ili_ellipse_begin(&outer, r_outer, r_outer);
+	_ili_ellipse_begin(&inner, r_inner, r_inner);
+	for (int32_t k = r_outer; k >= 0; k--)
+	{
+		int32_t hw = _ili_ellipse_next(&outer);
+		// Half width of the hole, -1 above it. Radius 0 has no hole
+		int32_t hole = -1;
+		if (r_inner > 0 && k <= r_inner)
+			hole = _ili_ellipse_next(&inner);
+
+		for (int32_t side = -1; side <= 1; side += 2)
+		{
+			int32_t y = cy + side * k;
+			if (hole < 0)
+				_ili_hspan_wedge(dev, cx - hw, cx + hw, y, cx, cy, &wg, color);
+			else
+			{
+				_ili_hspan_wedge(dev, cx - hw, cx - hole - 1, y, cx, cy, &wg, color);
+				_ili_hspan_wedge(dev, cx + hole + 1, cx + hw, y, cx, cy, &wg, color);
+			}
+			if (k == 0)
+				break;
+		}
+	}
+}
+
+
+/**
+ * Draw the 1 pixel outline of a circle from `start_angle` to `end_angle`.
+ * Angles are in degrees, 0 points right and angles grow clockwise. A sweep of 360 or more is a full circle.
+ * @param x0 Center col address
+ * @param y0 Center row address
+ * @param r Radius
+ * @param start_angle Start angle
+ * @param end_angle End angle
+ * @param color 16-bit RGB565 color
+ */
+void ili_dev_draw_arc(ili_dev_t *dev, uint16_t x0, uint16_t y0, uint16_t r, int16_t start_angle, int16_t end_angle, uint16_t color)
+{
+	_ili_wedge_t wg;
+	_ili_ellipse_iter_t it;
+	int32_t cx = x0, cy = y0;
+	int32_t prev_hw = -1;
+
+	if (!_ili_wedge_init(&wg, start_angle, end_angle))
+		return;
+
+	_ili_ellipse_begin(&it, r, r);
+	for (int32_t k = r; k >= 0; k--)
+	{
+		int32_t hw = _ili_ellipse_next(&it);
+		int32_t inner = (prev_hw + 1 < hw) ? prev_hw + 1 : hw;
+		for (int32_t side = -1; side <= 1; side += 2)
+		{
+			int32_t y = cy + side * k;
+			if (inner == 0)
+				_ili_hspan_wedge(dev, cx - hw, cx + hw, y, cx, cy, &wg, color);
+			else
+			{
+				_ili_hspan_wedge(dev, cx - hw, cx - inner, y, cx, cy, &wg, color);
+				_ili_hspan_wedge(dev, cx + inner, cx + hw, y, cx, cy, &wg, color);
+			}
+			if (k == 0)
+				break;
+		}
+		prev_hw = hw;
+	}
+}
+
+
+/**
+ * Draw a filled rectangle with rounded corners
+ * @param x Start col address
+ * @param y Start row address
+ * @param w Width of rectangle
+ * @param h Height of rectangle
+ * @param r Corner radius, limited to fit the rectangle
+ * @param color 16-bit RGB565 color
+ */
+void ili_dev_fill_round_rect(ili_dev_t *dev, uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t r, uint16_t color)
+{
+	_ili_ellipse_iter_t it;
+
+	if (w == 0 || h == 0)
+		return;
+	r = (r > (w - 1) / 2) ? (w - 1) / 2 : r;
+	r = (r > (h - 1) / 2) ? (h - 1) / 2 : r;
+
+	int32_t cx0 = (int32_t)x + r, cx1 = (int32_t)x + w - 1 - r;
+	int32_t cy0 = (int32_t)y + r, cy1 = (int32_t)y + h - 1 - r;
+	_ili_ellipse_begin(&it, r, r);
+	for (int32_t k = r; k > 0; k--)
+	{
+		int32_t hw = _ili_ellipse_next(&it);
+		_ili_hspan(dev, cx0 - hw, cx1 + hw, cy0 - k, color);
+		_ili_hspan(dev, cx0 - hw, cx1 + hw, cy1 + k, color);
+	}
+	// Straight middle part in one window
+	ili_dev_fill_rect(dev, x, cy0, w, cy1 - cy0 + 1, color);
+}
+
+
+/**
+ * Draw the 1 pixel outline of a rectangle with rounded corners
+ * @param x Start col address
+ * @param y Start row address
+ * @param w Width of rectangle
+ * @param h Height of rectangle
+ * @param r Corner radius, limited to fit the rectangle
+ * @param color 16-bit RGB565 color
+ */
+void ili_dev_draw_round_rect(ili_dev_t *dev, uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t r, uint16_t color)
+{
+	_ili_ellipse_iter_t it;
+	int32_t prev_hw = -1;
+
+	if (w == 0 || h == 0)
+		return;
+	r = (r > (w - 1) / 2) ? (w - 1) / 2 : r;
+	r = (r > (h - 1) / 2) ? (h - 1) / 2 : r;
+
+	int32_t cx0 = (int32_t)x + r, cx1 = (int32_t)x + w - 1 - r;
+	int32_t cy0 = (int32_t)y + r, cy1 = (int32_t)y + h - 1 - r;
+	if (r == 0)
+	{
+		// Plain rectangle, the edges are the top and bottom rows
+		_ili_hspan(dev, x, cx1, y, color);
+		if (h > 1)
+			_ili_hspan(dev, x, cx1, cy1, color);
+		cy0++;
+		cy1--;
+	}
+	_ili_ellipse_begin(&it, r, r);
+	for (int32_t k = r; k > 0; k--)
+	{
+		int32_t hw = _ili_ellipse_next(&it);
+		_ili_outline_row(dev, cx0, cx1, cy0 - k, hw, prev_hw, color);
+		_ili_outline_row(dev, cx0, cx1, cy1 + k, hw, prev_hw, color);
+		prev_hw = hw;
+	}
+	// Straight sides
+	if (cy1 >= cy0)
+	{
+		ili_dev_fill_rect(dev, x, cy0, 1, cy1 - cy0 + 1, color);
+		if (w > 1)
+			ili_dev_fill_rect(dev, x + w - 1, cy0, 1, cy1 - cy0 + 1, color);
+	}
+}
+
+
+/* ---------------------- Polygon scanline filler ---------------------- */
+/*
+ * Edge table scanline rasterizer. Rows and vertices are inclusive, so polygons meet their outlines
+ * without gaps. Edges step in 16.16 fixed point, one add per edge per row, and every row's
+ * interior (even-odd rule) goes out as merged spans, one window each.
+ */
+
+/*
+ * Crossings and horizontal edges are clamped to this many pixels around the display. Points
+ * take the whole uint16_t range, but past the guard band a span is off the display anyway
+ */
+#define _ILI_POLY_X_GUARD   4096
+
+/* Index of the point after `i`, wrapping around */
+static inline uint16_t _ili_poly_next(uint16_t i, uint16_t count)
+{
+	return (i + 1 == count) ? 0 : i + 1;
+}
+
+/* 16.16 x clamped to the guard band, where it fits 32 bits */
+static inline int32_t _ili_poly_clamp_x(int64_t x)
+{
+	const int64_t guard = (int64_t)_ILI_POLY_X_GUARD << 16;
+	return (int32_t)((x < -guard) ? -guard : (x > guard) ? guard : x);
+}
+
+
+/**
+ * Draw a filled polygon through `count` points (even-odd rule, may be concave or self-intersecting).
+ * The edges and vertices are part of the polygon. At most ILI_POLY_MAX_POINTS points.
+ * @param points Array of points
+ * @param count Number of points
+ * @param color 16-bit RGB565 color
+ */
+void ili_dev_fill_polygon(ili_dev_t *dev, const ili_point_t *points, uint16_t count, uint16_t color)
+{
+	uint8_t edge_cnt = 0;
+	uint8_t horiz_cnt = 0;
+	int32_t y_min = INT32_MAX, y_max = -1;
+
+	if (count == 0 || count > ILI_POLY_MAX_POINTS)
+		return;
+
+	for (uint16_t i = 0; i < count; i++)
+	{
+		const ili_point_t *a = &points[i];
+		const ili_point_t *b = &points[_ili_poly_next(i, count)];
+		y_min = (a->y < y_min) ? a->y : y_min;
+		y_max = (a->y > y_max) ? a->y : y_max;
+		if (a->y != b->y)
+			continue;
+		_ili_rect_t *h = &_ILI_SCRATCH(dev)->poly.horiz[horiz_cnt++];
+		h->x0 = (a->x < b->x) ? a->x : b->x;
+		h->x1 = (a->x < b->x) ? b->x : a->x;
+		h->x0 = (h->x0 > _ILI_POLY_X_GUARD) ? _ILI_POLY_X_GUARD : h->x0;
+		h->x1 = (h->x1 > _ILI_POLY_X_GUARD) ? _ILI_POLY_X_GUARD : h->x1;
+		h->y0 = h->y1 = a->y;
+	}
+
+	// Sloped edges. A vertex where the outline keeps going the same vertical direction
+	// would be crossed twice on its row, so the second edge skips that row
+	for (uint16_t i = 0; i < count; i++)
+	{
+		const ili_point_t *a = &points[i];
+		const ili_point_t *b = &points[_ili_poly_next(i, count)];
+		if (a->y == b->y)
+			continue;
+
+		// Previous sloped edge, looking back over horizontal ones
+		uint16_t p = i;
+		do
+			p = (p == 0) ? count - 1 : p - 1;
+		while (points[p].y == points[_ili_poly_next(p, count)].y && p != i);
+		uint8_t down = b->y > a->y;
+		uint8_t prev_down = points[_ili_poly_next(p, count)].y > points[p].y;
+
+		_ili_poly_edge_t *e = &_ILI_SCRATCH(dev)->poly.edges[edge_cnt++];
+		const ili_point_t *top = down ? a : b;
+		const ili_point_t *bot = down ? b : a;
+		e->dxdy = ((int64_t)bot->x - top->x) * 65536 / ((int32_t)bot->y - top->y);
+		e->x = (int64_t)top->x << 16;
+		e->x_min = _ili_poly_clamp_x((int64_t)((top->x < bot->x) ? top->x : bot->x) << 16);
+		e->x_max = _ili_poly_clamp_x((int64_t)((top->x < bot->x) ? bot->x : top->x) << 16);
+		e->y_top = top->y;
+		e->y_bot = bot->y;
+		if (down == prev_down)
+		{
+			if (down)
+			{
+				e->y_top++;
+				e->x += e->dxdy;
+			}
+			else
+				e->y_bot--;
+		}
+	}
+
+	// Edge table: sloped edges sorted by first row
+	for (uint8_t i = 1; i < edge_cnt; i++)
+	{
+		_ili_poly_edge_t e = _ILI_SCRATCH(dev)->poly.edges[i];
+		uint8_t k = i;
+		while (k > 0 && _ILI_SCRATCH(dev)->poly.edges[k - 1].y_top > e.y_top)
+		{
+			_ILI_SCRATCH(dev)->poly.edges[k] = _ILI_SCRATCH(dev)->poly.edges[k - 1];
+			k--;
+		}
+		_ILI_SCRATCH(dev)->poly.edges[k] = e;
+	}
+
+	y_max = (y_max >= dev->height) ? dev->height - 1 : y_max;
+	uint8_t next_edge = 0;
+	uint8_t active_cnt = 0;
+	for (int32_t y = y_min; y <= y_max; y++)
+	{
+		// Update the active edge list
+		while (next_edge < edge_cnt && _ILI_SCRATCH(dev)->poly.edges[next_edge].y_top <= y)
+			_ILI_SCRATCH(dev)->poly.active[active_cnt++] = next_edge++;
+		uint8_t n = 0;
+		for (uint8_t i = 0; i < active_cnt; i++)
+		{
+			if (_ILI_SCRATCH(dev)->poly.edges[_ILI_SCRATCH(dev)->poly.active[i]].y_bot >= y)
+				_ILI_SCRATCH(dev)->poly.active[n++] = _ILI_SCRATCH(dev)->poly.active[i];
+		}
+		active_cnt = n;
+
+		// Crossings, sorted. A shallow edge covers several pixels of the row, half a row
+		// up and down from the center crossing, which the spans take in so the edge stays solid
+		for (uint8_t i = 0; i < active_cnt; i++)
+		{
+			const _ili_poly_edge_t *e = &_ILI_SCRATCH(dev)->poly.edges[_ILI_SCRATCH(dev)->poly.active[i]];
+			int64_t half = ((e->dxdy < 0) ? -e->dxdy : e->dxdy) >> 1;
+			int32_t x = _ili_poly_clamp_x(e->x);
+			int32_t lo = _ili_poly_clamp_x(e->x - half), hi = _ili_poly_clamp_x(e->x + half);
+			lo = (lo < e->x_min) ? e->x_min : lo;
+			hi = (hi > e->x_max) ? e->x_max : hi;
+			uint8_t k = i;
+			while (k > 0 && _ILI_SCRATCH(dev)->poly.xs[k - 1] > x)
+			{
+				_ILI_SCRATCH(dev)->poly.xs[k] = _ILI_SCRATCH(dev)->poly.xs[k - 1];
+				_ILI_SCRATCH(dev)->poly.xs_lo[k] = _ILI_SCRATCH(dev)->poly.xs_lo[k - 1];
+				_ILI_SCRATCH(dev)->poly.xs_hi[k] = _ILI_SCRATCH(dev)->poly.xs_hi[k - 1];
+				k--;
+			}
+			_ILI_SCRATCH(dev)->poly.xs[k] = x;
+			_ILI_SCRATCH(dev)->poly.xs_lo[k] = lo;
+			_ILI_SCRATCH(dev)->poly.xs_hi[k] = hi;
+		}
+
+		// Interior spans between crossing pairs, plus the horizontal edges on this row
+		uint8_t spans = 0;
+		for (uint8_t i = 0; i + 1 < active_cnt; i += 2)
+		{
+			_ILI_SCRATCH(dev)->poly.span_start[spans] = (int16_t)((_ILI_SCRATCH(dev)->poly.xs_lo[i] + 0x8000) >> 16);
+			_ILI_SCRATCH(dev)->poly.span_end[spans++] = (int16_t)((_ILI_SCRATCH(dev)->poly.xs_hi[i + 1] + 0x8000) >> 16);
+		}
+		for (uint8_t i = 0; i < horiz_cnt; i++)
+		{
+			const _ili_rect_t *h = &_ILI_SCRATCH(dev)->poly.horiz[i];
+			if (h->y0 != y)
+				continue;
+			uint8_t k = spans++;
+			while (k > 0 && _ILI_SCRATCH(dev)->poly.span_start[k - 1] > h->x0)
+			{
+				_ILI_SCRATCH(dev)->poly.span_start[k] = _ILI_SCRATCH(dev)->poly.span_start[k - 1];
+				_ILI_SCRATCH(dev)->poly.span_end[k] = _ILI_SCRATCH(dev)->poly.span_end[k - 1];
+				k--;
+			}
+			_ILI_SCRATCH(dev)->poly.span_start[k] = (int16_t)h->x0;
+			_ILI_SCRATCH(dev)->poly.span_end[k] = (int16_t)h->x1;
+		}
+
+		// Merge overlapping and touching spans, send each once
+		uint8_t i = 0;
+		while (i < spans)
+		{
+			int32_t s = _ILI_SCRATCH(dev)->poly.span_start[i];
+			int32_t e = _ILI_SCRATCH(dev)->poly.span_end[i++];
+			while (i < spans && _ILI_SCRATCH(dev)->poly.span_start[i] <= e + 1)
+			{
+				e = (_ILI_SCRATCH(dev)->poly.span_end[i] > e) ? _ILI_SCRATCH(dev)->poly.span_end[i] : e;
+				i++;
+			}
+			_ili_hspan(dev, s, e, y, color);
+		}
+
+		for (uint8_t k = 0; k < active_cnt; k++)
+			_ILI_SCRATCH(dev)->poly.edges[_ILI_SCRATCH(dev)->poly.active[k]].x += _ILI_SCRATCH(dev)->poly.edges[_ILI_SCRATCH(dev)->poly.active[k]].dxdy;
+	}
+}
+
+
+/**
+ * Draw a filled triangle. The edges and vertices are part of the triangle.
+ * @param x0 First vertex col address
+ * @param y0 First vertex row address
+ * @param x1 Second vertex col address
+ * @param y1 Second vertex row address
+ * @param x2 Third vertex col address
+ * @param y2 Third vertex row address
+ * @param color 16-bit RGB565 color
+ */
+void ili_dev_fill_triangle(ili_dev_t *dev, uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint16_t color)
+{
+	ili_point_t points[3] = {{x0, y0}, {x1, y1}, {x2, y2}};
+	ili_dev_fill_polygon(dev, points, 3, color);
+}
+
+
+/* ---------------------- Bitmap font text ---------------------- */
+/*
+ * A line of text is rendered into RAM, glyphs blended on the background color, and goes out
+ * through one address window. Lines wider than the line buffer are rendered and sent in bands
+ * of rows. Rendered lines can be kept in a user supplied pool for cheap redraws.
+ */
+
+/* Glyph of `c`, NULL if the font does not have it */
+static inline const ili_glyph_t *_ili_text_glyph(const ili_font_t *font, char c)
+{
+	uint8_t code = (uint8_t)c;
+	if (code < font->first || code > font->last)
+		return NULL;
+	return &font->glyphs[code - font->first];
+}
+
+/* Number of characters up to the end of the line */
+static uint16_t _ili_text_line_len(const char *str)
+{
+	uint16_t len = 0;
+	while (str[len] != '\0' && str[len] != '\n')
+		len++;
+	return len;
+}
+
+static uint16_t _ili_text_line_width(const char *str, uint16_t len, const ili_font_t *font)
+{
+	uint16_t w = 0;
+	for (uint16_t i = 0; i < len; i++)
+	{
+		const ili_glyph_t *g = _ili_text_glyph(font, str[i]);
+		if (g)
+			w += g->x_advance;
+	}
+	return w;
+}
+
+/* `color` over `bg_color` for the 16 coverage levels. 1bpp fonts only use 0 and 15 */
+static void _ili_text_make_lut(uint16_t *lut, uint16_t color, uint16_t bg_color)
+{
+	int32_t fr = color >> 11, fg = (color >> 5) & 0x3F, fb = color & 0x1F;
+	int32_t br = bg_color >> 11, bg = (bg_color >> 5) & 0x3F, bb = bg_color & 0x1F;
+	for (int32_t a = 0; a < 16; a++)
+	{
+		uint16_t r = (uint16_t)((fr * a + br * (15 - a) + 7) / 15);
+		uint16_t g = (uint16_t)((fg * a + bg * (15 - a) + 7) / 15);
+		uint16_t b = (uint16_t)((fb * a + bb * (15 - a) + 7) / 15);
+		lut[a] = (uint16_t)((r << 11) | (g << 5) | b);
+	}
+}
+
+/*
+ * Render rows `row0` to `row0 + rows - 1` of a line into `dst`, which is `w` pixels wide.
+ * Glyph pixels right of `w` are cut off
+ */
+static void _ili_text_render(const char *str, uint16_t len, const ili_font_t *font, const uint16_t *lut,
+							 uint16_t *dst, uint16_t w, uint16_t row0, uint16_t rows)
+{
+	uint32_t px_cnt = (uint32_t)w * rows;
+	for (uint32_t i = 0; i < px_cnt; i++)
+		dst[i] = lut[0];
+
+	int32_t cursor = 0;
+	for (uint16_t i = 0; i < len && cursor < w; i++)
+	{
+		const ili_glyph_t *g = _ili_text_glyph(font, str[i]);
+		if (!g)
+			continue;
+		int32_t gx0 = cursor + g->x_offset;
+		cursor += g->x_advance;
+
+		// Glyph rows inside the band
+		int32_t gy_start = (int32_t)row0 - g->y_offset;
+		int32_t gy_end = (int32_t)row0 + rows - g->y_offset;
+		gy_start = (gy_start < 0) ? 0 : gy_start;
+		gy_end = (gy_end > g->height) ? g->height : gy_end;
+		// Glyph columns inside the line
+		int32_t gx_start = (gx0 < 0) ? -gx0 : 0;
+		int32_t gx_end = (gx0 + g->width > w) ? w - gx0 : g->width;
+
+		const uint8_t *bm = &font->bitmap[g->bitmap_offset];
+		for (int32_t gy = gy_start; gy < gy_end; gy++)
+		{
+			uint16_t *out = &dst[(uint32_t)(g->y_offset + gy - row0) * w + gx0];
+			uint32_t bit = (uint32_t)gy * g->width * font->bpp;
+			for (int32_t gx = gx_start; gx < gx_end; gx++)
+			{
+				uint32_t b = bit + (uint32_t)gx * font->bpp;
+				uint8_t a;
+				if (font->bpp == 4)
+					a = (b & 4) ? (bm[b >> 3] & 0x0F) : (bm[b >> 3] >> 4);
+				else
+					a = (bm[b >> 3] & (0x80 >> (b & 7))) ? 15 : 0;
+				if (a)
+					out[gx] = lut[a];
+			}
+		}
+	}
+}
+
+/* Cached rendering of the line, NULL if there is none */
+static _ili_text_slot_t *_ili_text_cache_find(ili_dev_t *dev, const char *str, uint16_t len, const ili_font_t *font,
+															  uint16_t color, uint16_t bg_color, uint16_t w, uint16_t h)
+{
+	for (uint8_t i = 0; i < ILI_TEXT_CACHE_SLOTS; i++)
+	{
+		_ili_text_slot_t *slot = &dev->text_slots[i];
+		if (slot->last_used && slot->font == font && slot->color == color && slot->bg_color == bg_color &&
+			slot->w == w && slot->h == h && strncmp(slot->str, str, len) == 0 && slot->str[len] == '\0')
+			return slot;
+	}
+	return NULL;
+}
+
+/* Draw one line of text, `w` x `h` visible pixels at (x, y) */
+static void _ili_text_draw_line(ili_dev_t *dev, uint16_t x, uint16_t y, const char *str, uint16_t len, const ili_font_t *font,
+												uint16_t color, uint16_t bg_color, uint16_t w, uint16_t h)
+{
+	uint16_t lut[16];
+	uint32_t px_cnt = (uint32_t)w * h;
+
+	if (dev->text_pool && len < ILI_TEXT_CACHE_STR_LEN && px_cnt <= dev->text_slot_px)
+	{
+		_ili_text_slot_t *slot = _ili_text_cache_find(dev, str, len, font, color, bg_color, w, h);
+		if (!slot)
+		{
+			// Replace the least recently used slot, empty ones first
+			slot = &dev->text_slots[0];
+			for (uint8_t i = 1; i < ILI_TEXT_CACHE_SLOTS; i++)
+			{
+				if (dev->text_slots[i].last_used < slot->last_used)
+					slot = &dev->text_slots[i];
+			}
+			slot->font = font;
+			slot->color = color;
+			slot->bg_color = bg_color;
+			slot->w = w;
+			slot->h = h;
+			memcpy(slot->str, str, len);
+			slot->str[len] = '\0';
+			_ili_text_make_lut(lut, color, bg_color);
+			_ili_text_render(str, len, font, lut, dev->text_pool + (uint32_t)(slot - dev->text_slots) * dev->text_slot_px, w, 0, h);
+		}
+		slot->last_used = ++dev->text_clock;
+		ili_dev_set_address_window(dev, x, y, w, h);
+		ili_dev_draw_pixels_buffer(dev, dev->text_pool + (uint32_t)(slot - dev->text_slots) * dev->text_slot_px, px_cnt);
+		return;
+	}
+
+	_ili_text_make_lut(lut, color, bg_color);
+	uint16_t band_h = ILI_TEXT_BUF_PX_CNT / w;
+	ili_dev_set_address_window(dev, x, y, w, h);
+	for (uint16_t row = 0; row < h; row += band_h)
+	{
+		uint16_t rows = (h - row < band_h) ? h - row : band_h;
+		_ili_text_render(str, len, font, lut, _ILI_SCRATCH(dev)->text_buf, w, row, rows);
+		ili_dev_draw_pixels_buffer(dev, _ILI_SCRATCH(dev)->text_buf, (uint32_t)w * rows);
+	}
+}
+
+
+/**
+ * Draw a string with its top-left corner at (x, y). Each line (up to a '\n') is drawn as one
+ * solid `bg_color` box, font->y_advance high, with the glyphs blended on it, sent through one
+ * address window. Characters the font does not have are skipped. Parts outside the display are skipped.
+ * Text is drawn right away, even while a display list is recorded.
+ * @param x Start col address
+ * @param y Start row address
+ * @param str Null terminated string
+ * @param font Font to draw with
+ * @param color 16-bit RGB565 text color
+ * @param bg_color 16-bit RGB565 background color
+ */
+void ili_dev_draw_string(ili_dev_t *dev, uint16_t x, uint16_t y, const char *str, const ili_font_t *font, uint16_t color, uint16_t bg_color)
+{
+	if (x >= dev->width)
+		return;
+
+	while (y < dev->height)
+	{
+		uint16_t len = _ili_text_line_len(str);
+		uint16_t w = _ili_text_line_width(str, len, font);
+		uint16_t h = font->y_advance;
+		w = (x + w > dev->width) ? dev->width - x : w;
+		h = (y + h > dev->height) ? dev->height - y : h;
+		if (w > 0 && h > 0)
+			_ili_text_draw_line(dev, x, y, str, len, font, color, bg_color, w, h);
+
+		if (str[len] == '\0')
+			break;
+		str += len + 1;
+		y += font->y_advance;
+	}
+}
+
+
+/**
+ * Width in pixels of the first line of `str`, as drawn by ili_draw_string()
+ * @param str Null terminated string
+ * @param font Font to measure with
+ */
+uint16_t ili_text_width(const char *str, const ili_font_t *font)
+{
+	return _ili_text_line_width(str, _ili_text_line_len(str), font);
+}
+
+
+/**
+ * Give ili_draw_string() a pool to cache rendered lines in. The pool is split in
+ * ILI_TEXT_CACHE_SLOTS equal slots, the least recently used one is replaced. Lines that are
+ * longer than ILI_TEXT_CACHE_STR_LEN - 1 characters or do not fit a slot are not cached.
+ * Redrawing a cached line (same text, font, colors and visible size) only sends its pixels.
+ * @param pool RGB565 pixels, must stay valid until ili_text_cache_detach(). NULL disables the cache
+ * @param pool_px Number of pixels in `pool`
+ */
+void ili_dev_text_cache_attach(ili_dev_t *dev, uint16_t *pool, uint32_t pool_px)
+{
+	memset(dev->text_slots, 0, sizeof(dev->text_slots));
+	dev->text_clock = 0;
+	dev->text_pool = pool;
+	dev->text_slot_px = pool_px / ILI_TEXT_CACHE_SLOTS;
+}
+
+
+/**
+ * Stop caching rendered lines and forget the cached ones
+ */
+void ili_dev_text_cache_detach(ili_dev_t *dev)
+{
+	ili_dev_text_cache_attach(dev, NULL, 0);
+}
+
+
+/* Which end points of a line are left out. Polylines leave out the last point of every
+ * segment but the last one, so that shared vertices are drawn only once */
+#define _ILI_LINE_OMIT_NONE     0
+#define _ILI_LINE_OMIT_FIRST    1
+#define _ILI_LINE_OMIT_LAST     2
+
+/*
+ * Bresenham for shallow lines (|dy| < dx, x0 < x1). Pixels that share a row are
+ * collected into a run and every run goes out as a single window, instead of one
+ * window per pixel. A `width` thick run is the union of the `width`x`width` points
+ * on it, so the output is identical to stamping each point.
+ */
+static void _ili_plot_runs_low(ili_dev_t *dev, uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint8_t width, uint16_t color, uint8_t omit)
+{
+	int16_t dx = x1 - x0;
+	int16_t dy = y1 - y0;
+	int8_t yi = 1;
+	if (dy < 0)
+	{
+		yi = -1;
+		dy = -dy;
+	}
+
+	int16_t D = 2*dy - dx;
+	uint16_t y = y0;
+	int32_t first = (omit & _ILI_LINE_OMIT_FIRST) ? x0 + 1 : x0;
+	int32_t last = (omit & _ILI_LINE_OMIT_LAST) ? x1 - 1 : x1;
+	int32_t run_start = first;
+
+	for (int32_t x = x0; x <= x1; x++)
+	{
+		// Next pixel steps to another row, the run on this row ends at x
+		if (D > 0 || x == x1)
+		{
+			int32_t run_end = (x < last) ? x : last;
+			if (run_end >= run_start)
+				ili_dev_fill_rect_fast(dev, run_start, y, run_end - run_start + width, width, color);
+			run_start = x + 1;
+			y = y + yi;
+			D = D - 2*dx;
+		}
+		D = D + 2*dy;
+	}
+}
+
+
+/*
+ * Bresenham for steep lines (|dx| <= dy, y0 < y1). Same as _ili_plot_runs_low()
+ * with vertical runs.
+ */
+static void _ili_plot_runs_high(ili_dev_t *dev, uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint8_t width, uint16_t color, uint8_t omit)
+{
+	int16_t dx = x1 - x0;
+	int16_t dy = y1 - y0;
+	int8_t xi = 1;
+	if (dx < 0)
+	{
+		xi = -1;
+		dx = -dx;
+	}
+
+	int16_t D = 2*dx - dy;
+	uint16_t x = x0;
+	int32_t first = (omit & _ILI_LINE_OMIT_FIRST) ? y0 + 1 : y0;
+	int32_t last = (omit & _ILI_LINE_OMIT_LAST) ? y1 - 1 : y1;
+	int32_t run_start = first;
+
+	for (int32_t y = y0; y <= y1; y++)
+	{
+		// Next pixel steps to another column, the run on this column ends at y
+		if (D > 0 || y == y1)
+		{
+			int32_t run_end = (y < last) ? y : last;
+			if (run_end >= run_start)
+				ili_dev_fill_rect_fast(dev, x, run_start, width, run_end - run_start + width, color);
+			run_start = y + 1;
+			x = x + xi;
+			D = D - 2*dy;
+		}
+		D = D + 2*dx;
+	}
+}
+
+
+/*
+ * Called by ili_draw_line().
+ * User need not call it
+ */
+void _ili_plot_line_low(ili_dev_t *dev, uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint8_t width, uint16_t color)
+{
+	_ili_plot_runs_low(dev, x0, y0, x1, y1, width, color, _ILI_LINE_OMIT_NONE);
+}
+
+
+/*
+ * Called by ili_draw_line().
+ * User need not call it
+ */
+void _ili_plot_line_high(ili_dev_t *dev, uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint8_t width, uint16_t color)
+{
+	_ili_plot_runs_high(dev, x0, y0, x1, y1, width, color, _ILI_LINE_OMIT_NONE);
+}
+
+
+/*
+ * ili_draw_line() that can leave out end points, see _ILI_LINE_OMIT_xx
+ */
+static void _ili_draw_line_omit(ili_dev_t *dev, uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint8_t width, uint16_t color, uint8_t omit)
+{
+	/*
+	* Brehensen's algorithm is used.
+	* Not necessarily start points has to be less than end points.
+	*/
+
+	if (x0 == x1 || y0 == y1)	//vertical or horizontal line, or a single point
+	{
+		// Only the last point can be omitted here (polylines). A single point can't lose it
+		if (omit & _ILI_LINE_OMIT_LAST)
+		{
+			if (x0 == x1 && y0 == y1)
+				return;
+			if (x0 == x1)
+				y1 = (y1 > y0) ? y1 - 1 : y1 + 1;
+			else
+				x1 = (x1 > x0) ? x1 - 1 : x1 + 1;
+		}
+
+		if (x0 == x1)
+			_ili_draw_fast_v_line(dev, x0, y0, y1, width, color);
+		else
+			_ili_draw_fast_h_line(dev, x0, y0, x1, width, color);
+	}
+
+	else
+	{
+		// When the end points get swapped, so does the omitted one
+		uint8_t omit_swapped = ((omit & _ILI_LINE_OMIT_FIRST) ? _ILI_LINE_OMIT_LAST : 0) |
+							   ((omit & _ILI_LINE_OMIT_LAST) ? _ILI_LINE_OMIT_FIRST : 0);
+
+		if (abs(y1 - y0) < abs(x1 - x0))
+		{
+			if (x0 > x1)
+				_ili_plot_runs_low(dev, x1, y1, x0, y0, width, color, omit_swapped);
+			else
+				_ili_plot_runs_low(dev, x0, y0, x1, y1, width, color, omit);
+		}
+
+		else
+		{
+			if (y0 > y1)
+				_ili_plot_runs_high(dev, x1, y1, x0, y0, width, color, omit_swapped);
+			else
+				_ili_plot_runs_high(dev, x0, y0, x1, y1, width, color, omit);
+		}
+	}
+}
+
+
+/* ---------------------- Thick line rasterizer ---------------------- */
+/*
+ * Thick lines and polylines are built from convex pieces: one quad per segment,
+ * one piece per join and per round cap. Every row of the bounding box is intersected
+ * with all the pieces, the resulting intervals are merged and each merged span goes
+ * out as one window. So every pixel is sent exactly once, and traffic follows the area.
+ * Coordinates are floats in pixel units, pixel (x, y) is the square [x, x+1) x [y, y+1).
+ */
+
+/* Miter joins longer than this many half widths fall back to bevel (SVG default is 4) */
+#define _ILI_THICK_MITER_LIMIT  4.0f
+
+/* Index of the first pixel whose center is at or after `v` */
+static inline int32_t _ili_px_from(float v)
+{
+	v -= 0.5f;
+	int32_t i = (int32_t)v;
+	return (v > (float)i) ? i + 1 : i;
+}
+
+static void _ili_thick_add_poly(ili_dev_t *dev, const float *x, const float *y, uint8_t n)
+{
+	_ili_piece_t *pc = &_ILI_SCRATCH(dev)->thick.pieces[_ILI_SCRATCH(dev)->thick.piece_cnt++];
+	float y_min = y[0], y_max = y[0];
+	for (uint8_t i = 0; i < n; i++)
+	{
+		pc->x[i] = x[i];
+		pc->y[i] = y[i];
+		y_min = (y[i] < y_min) ? y[i] : y_min;
+		y_max = (y[i] > y_max) ? y[i] : y_max;
+	}
+	pc->n = n;
+	pc->row_min = _ili_px_from(y_min);
+	pc->row_max = _ili_px_from(y_max) - 1;
+}
+
+static void _ili_thick_add_disc(ili_dev_t *dev, float cx, float cy, float r)
+{
+	_ili_piece_t *pc = &_ILI_SCRATCH(dev)->thick.pieces[_ILI_SCRATCH(dev)->thick.piece_cnt++];
+	pc->x[0] = cx;
+	pc->y[0] = cy;
+	pc->x[1] = r;
+	pc->n = 0;
+	pc->row_min = _ili_px_from(cy - r);
+	pc->row_max = _ili_px_from(cy + r) - 1;
+}
+
+/* Pixel interval [start, end) of a piece on the row sampled at `ys`. Returns 0 if none */
+static uint8_t _ili_thick_piece_span(ili_dev_t *dev, const _ili_piece_t *pc, float ys, int16_t *start, int16_t *end)
+{
+	float xl, xr;
+
+	if (pc->n == 0)
+	{
+		float dy = ys - pc->y[0];
+		float r2 = pc->x[1] * pc->x[1] - dy * dy;
+		if (r2 <= 0.0f)
+			return 0;
+		float half = sqrtf(r2);
+		xl = pc->x[0] - half;
+		xr = pc->x[0] + half;
+	}
+	else
+	{
+		uint8_t crossings = 0;
+		xl = 1e9f;
+		xr = -1e9f;
+		for (uint8_t i = 0; i < pc->n; i++)
+		{
+			uint8_t j = (i + 1 == pc->n) ? 0 : i + 1;
+			float ya = pc->y[i], yb = pc->y[j];
+			// Half open in y, so a vertex on the sample line is counted once
+			if ((ya <= ys && ys < yb) || (yb <= ys && ys < ya))
+			{
+				float x = pc->x[i] + (ys - ya) * (pc->x[j] - pc->x[i]) / (yb - ya);
+				xl = (x < xl) ? x : xl;
+				xr = (x > xr) ? x : xr;
+				crossings++;
+			}
+		}
+		if (crossings < 2)
+			return 0;
+	}
+
+	int32_t s = _ili_px_from(xl);
+	int32_t e = _ili_px_from(xr);
+	s = (s < 0) ? 0 : s;
+	e = (e > dev->width) ? dev->width : e;
+	if (e <= s)
+		return 0;
+	*start = (int16_t)s;
+	*end = (int16_t)e;
+	return 1;
+}
+
+/* Scan convert the buffered pieces into merged spans and send them */
+static void _ili_thick_flush(ili_dev_t *dev, uint16_t color)
+{
+	if (_ILI_SCRATCH(dev)->thick.piece_cnt == 0)
+		return;
+
+	int32_t row_min = _ILI_SCRATCH(dev)->thick.pieces[0].row_min;
+	int32_t row_max = _ILI_SCRATCH(dev)->thick.pieces[0].row_max;
+	for (uint8_t i = 1; i < _ILI_SCRATCH(dev)->thick.piece_cnt; i++)
+	{
+		row_min = (_ILI_SCRATCH(dev)->thick.pieces[i].row_min < row_min) ? _ILI_SCRATCH(dev)->thick.pieces[i].row_min : row_min;
+		row_max = (_ILI_SCRATCH(dev)->thick.pieces[i].row_max > row_max) ? _ILI_SCRATCH(dev)->thick.pieces[i].row_max : row_max;
+	}
+	row_min = (row_min < 0) ? 0 : row_min;
+	row_max = (row_max >= dev->height) ? dev->height - 1 : row_max;
+
+	for (int32_t row = row_min; row <= row_max; row++)
+	{
+		uint8_t cnt = 0;
+		float ys = (float)row + 0.5f;
+
+		for (uint8_t i = 0; i < _ILI_SCRATCH(dev)->thick.piece_cnt; i++)
+		{
+			const _ili_piece_t *pc = &_ILI_SCRATCH(dev)->thick.pieces[i];
+			int16_t s, e;
+			if (row < pc->row_min || row > pc->row_max || !_ili_thick_piece_span(dev, pc, ys, &s, &e))
+				continue;
+
+			// Insertion sort by start
+			uint8_t k = cnt++;
+			while (k > 0 && _ILI_SCRATCH(dev)->thick.span_start[k - 1] > s)
+			{
+				_ILI_SCRATCH(dev)->thick.span_start[k] = _ILI_SCRATCH(dev)->thick.span_start[k - 1];
+				_ILI_SCRATCH(dev)->thick.span_end[k] = _ILI_SCRATCH(dev)->thick.span_end[k - 1];
+				k--;
+			}
+			_ILI_SCRATCH(dev)->thick.span_start[k] = s;
+			_ILI_SCRATCH(dev)->thick.span_end[k] = e;
+		}
+
+		// Merge overlapping and touching intervals, send each result once
+		uint8_t i = 0;
+		while (i < cnt)
+		{
+			int16_t s = _ILI_SCRATCH(dev)->thick.span_start[i];
+			int16_t e = _ILI_SCRATCH(dev)->thick.span_end[i++];
+			while (i < cnt && _ILI_SCRATCH(dev)->thick.span_start[i] <= e)
+			{
+				e = (_ILI_SCRATCH(dev)->thick.span_end[i] > e) ? _ILI_SCRATCH(dev)->thick.span_end[i] : e;
+				i++;
+			}
+			ili_dev_fill_rect_fast(dev, s, row, e - s, 1, color);
+		}
+	}
+	_ILI_SCRATCH(dev)->thick.piece_cnt = 0;
+}
+
+/* Join between two segments meeting at (px, py). u is the unit direction, n the half width normal */
+static void _ili_thick_add_join(ili_dev_t *dev, float px, float py, float u1x, float u1y, float u2x, float u2y, float hw, uint8_t join)
+{
+	float cross = u1x * u2y - u1y * u2x;
+	float dot = u1x * u2x + u1y * u2y;
+
+	if (join == ILI_LINE_JOIN_ROUND)
+	{
+		_ili_thick_add_disc(dev, px, py, hw);
+		return;
+	}
+	// Straight on, the quads already meet
+	if (cross > -1e-4f && cross < 1e-4f && dot > 0.0f)
+		return;
+
+	// The gap opens on the outer side of the turn, opposite to the normal (-u.y, u.x) when turning that way
+	float side = (cross > 0.0f) ? -hw : hw;
+	float ax = px - u1y * side, ay = py + u1x * side;
+	float bx = px - u2y * side, by = py + u2x * side;
+
+	if (join == ILI_LINE_JOIN_MITER)
+	{
+		// Miter point is along the bisector of the two normals
+		float mx = -u1y - u2y, my = u1x + u2x;
+		float m_len = sqrtf(mx * mx + my * my);
+		if (m_len > 1e-4f)
+		{
+			mx /= m_len;
+			my /= m_len;
+			float cos_half = mx * -u1y + my * u1x;	// cos of half the angle between the normals
+			if (cos_half > 1.0f / _ILI_THICK_MITER_LIMIT)
+			{
+				float k = side / cos_half;
+				float x[4] = {px, ax, px + mx * k, bx};
+				float y[4] = {py, ay, py + my * k, by};
+				_ili_thick_add_poly(dev, x, y, 4);
+				return;
+			}
+		}
+	}
+
+	// Bevel, also the fallback for too long miters
+	float x[3] = {px, ax, bx};
+	float y[3] = {py, ay, by};
+	_ili_thick_add_poly(dev, x, y, 3);
+}
+
+
+/**
+ * Draw connected thick line segments through `count` points with selectable joins and caps.
+ * Every pixel is sent once. A line of `width` covers the band centered on
+ * (x + (width-1)/2, y + (width-1)/2), the same band as `width`x`width` squares with their top-left
+ * corner on the line would. Width 1 is the plain Bresenham polyline, joins and caps don't apply.
+ * @param points Array of points
+ * @param count Number of points
+ * @param width width or thickness of the line
+ * @param color 16-bit RGB565 color of the line
+ * @param join ILI_LINE_JOIN_MITER, ILI_LINE_JOIN_BEVEL or ILI_LINE_JOIN_ROUND
+ * @param cap ILI_LINE_CAP_BUTT or ILI_LINE_CAP_ROUND
+ */
+void ili_dev_draw_polyline_ex(ili_dev_t *dev, const ili_point_t *points, uint16_t count, uint8_t width, uint16_t color, uint8_t join, uint8_t cap)
+{
+	if (count == 0 || width == 0)
+		return;
+	if (width == 1)
+	{
+		ili_dev_draw_polyline(dev, points, count, 1, color);
+		return;
+	}
+
+	float hw = (float)width / 2.0f;
+	float ofs = (float)(width - 1) / 2.0f + 0.5f;	// Pixel center, plus the legacy top-left anchoring
+
+	// First and last segment with a length. Caps go there
+	int32_t first = -1, last = -1;
+	for (uint16_t i = 0; i + 1 < count; i++)
+	{
+		if (points[i].x != points[i + 1].x || points[i].y != points[i + 1].y)
+		{
+			first = (first < 0) ? i : first;
+			last = i;
+		}
+	}
+	if (first < 0)
+	{
+		// All points are the same, just a dot
+		if (cap == ILI_LINE_CAP_ROUND)
+		{
+			_ili_thick_add_disc(dev, points[0].x + ofs, points[0].y + ofs, hw);
+			_ili_thick_flush(dev, color);
+		}
+		else
+			ili_dev_fill_rect(dev, points[0].x, points[0].y, width, width, color);
+		return;
+	}
+
+	float prev_ux = 0.0f, prev_uy = 0.0f;
+	_ILI_SCRATCH(dev)->thick.piece_cnt = 0;
+	for (int32_t i = first; i <= last; i++)
+	{
+		float ax = points[i].x + ofs, ay = points[i].y + ofs;
+		float bx = points[i + 1].x + ofs, by = points[i + 1].y + ofs;
+		float dx = bx - ax, dy = by - ay;
+		float len = sqrtf(dx * dx + dy * dy);
+		if (len == 0.0f)
+			continue;
+		float ux = dx / len, uy = dy / len;
+		float nx = -uy * hw, ny = ux * hw;
+
+		// Room for a quad, a join and two caps
+		if (_ILI_SCRATCH(dev)->thick.piece_cnt + 4 > _ILI_THICK_MAX_PIECES)
+			_ili_thick_flush(dev, color);
+
+		if (i != first)
+			_ili_thick_add_join(dev, ax, ay, prev_ux, prev_uy, ux, uy, hw, join);
+
+		// Butt caps reach to the outer edge of the end point pixel
+		float ext_a = (i == first && cap == ILI_LINE_CAP_BUTT) ? 0.5f : 0.0f;
+		float ext_b = (i == last && cap == ILI_LINE_CAP_BUTT) ? 0.5f : 0.0f;
+		float sx = ax - ux * ext_a, sy = ay - uy * ext_a;
+		float ex = bx + ux * ext_b, ey = by + uy * ext_b;
+		float x[4] = {sx + nx, ex + nx, ex - nx, sx - nx};
+		float y[4] = {sy + ny, ey + ny, ey - ny, sy - ny};
+		_ili_thick_add_poly(dev, x, y, 4);
+
+		if (cap == ILI_LINE_CAP_ROUND)
+		{
+			if (i == first)
+				_ili_thick_add_disc(dev, ax, ay, hw);
+			if (i == last)
+				_ili_thick_add_disc(dev, bx, by, hw);
+		}
+		prev_ux = ux;
+		prev_uy = uy;
+	}
+	_ili_thick_flush(dev, color);
+}
+
+
+/**
+ * Draw a line from (x0,y0) to (x1,y1) with `width` and `color`.
+ * Thick diagonal lines have butt caps, see ili_draw_polyline_ex() for the band they cover.
+ * @param x0 start column address.
+ * @param y0 start row address.
+ * @param x1 end column address.
+ * @param y1 end row address.
+ * @param width width or thickness of the line
+ * @param color 16-bit RGB565 color of the line
+ */
+void ili_dev_draw_line(ili_dev_t *dev, uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint8_t width, uint16_t color)
+{
+	if (dev->dl_rec)
+	{
+		_ili_dl_add(dev, ILI_DL_LINE, x0, y0, x1, y1, width, color, NULL);
+		return;
+	}
+	// Thick diagonal lines are scan converted as a polygon. Horizontal and vertical ones are a single window anyway
+	if (width > 1 && x0 != x1 && y0 != y1)
+	{
+		ili_point_t points[2] = {{x0, y0}, {x1, y1}};
+		ili_dev_draw_polyline_ex(dev, points, 2, width, color, ILI_LINE_JOIN_MITER, ILI_LINE_CAP_BUTT);
+		return;
+	}
+	_ili_draw_line_omit(dev, x0, y0, x1, y1, width, color, _ILI_LINE_OMIT_NONE);
+}
+
+
+/**
+ * Draw connected line segments through `count` points.
+ * Every vertex is drawn once, segments don't repeat the end point of the previous one.
+ * Thick polylines use miter joins and butt caps, see ili_draw_polyline_ex().
+ * @param points Array of points
+ * @param count Number of points
+ * @param width width or thickness of the line
+ * @param color 16-bit RGB565 color of the line
+ */
+void ili_dev_draw_polyline(ili_dev_t *dev, const ili_point_t *points, uint16_t count, uint8_t width, uint16_t color)
+{
+	if (count == 0)
+		return;
+	if (width > 1)
+	{
+		ili_dev_draw_polyline_ex(dev, points, count, width, color, ILI_LINE_JOIN_MITER, ILI_LINE_CAP_BUTT);
+		return;
+	}
+	if (count == 1)
+	{
+		ili_dev_draw_pixel(dev, points[0].x, points[0].y, color);
+		return;
+	}
+
+	for (uint16_t i = 0; i + 1 < count; i++)
+	{
+		// Last segment keeps its end point, as nobody else draws it
+		uint8_t omit = (i + 2 < count) ? _ILI_LINE_OMIT_LAST : _ILI_LINE_OMIT_NONE;
+		_ili_draw_line_omit(dev, points[i].x, points[i].y, points[i + 1].x, points[i + 1].y, width, color, omit);
+	}
+}
+
+
+/*
+ * Called by ili_draw_line().
+ * User need not call it
+ */
+void _ili_draw_fast_h_line(ili_dev_t *dev, uint16_t x0, uint16_t y0, uint16_t x1, uint8_t width, uint16_t color)
+{
+	/*
+	* Draw a horizontal line very fast
+	*/
+	if (dev->dl_rec)
+	{
+		_ili_dl_add(dev, ILI_DL_FILL, (x0 < x1) ? x0 : x1, y0, (x0 < x1) ? x1 : x0, y0 + width - 1, 0, color, NULL);
+		return;
+	}
+	if (x0 < x1)
+		ili_dev_set_address_window(dev, x0, y0, x1-x0+1, width);	//as it's horizontal line, y1=y0.. must be.
+	else
+		ili_dev_set_address_window(dev, x1, y0, x0-x1+1, width);
+
+	ili_dev_fill_color(dev, color, (uint32_t)width * (uint32_t)(abs(x1 - x0) + 1));
+}
+
+
+/*
+ * Called by ili_draw_line().
+ * User need not call it
+ */
+void _ili_draw_fast_v_line(ili_dev_t *dev, uint16_t x0, uint16_t y0, uint16_t y1, uint8_t width, uint16_t color)
+{
+	/*
+	* Draw a vertical line very fast
+	*/
+	if (dev->dl_rec)
+	{
+		_ili_dl_add(dev, ILI_DL_FILL, x0, (y0 < y1) ? y0 : y1, x0 + width - 1, (y0 < y1) ? y1 : y0, 0, color, NULL);
+		return;
+	}
+	if (y0 < y1)
+		ili_dev_set_address_window(dev, x0, y0, width, y1-y0+1);	//as it's vertical line, x1=x0.. must be.
+	else
+		ili_dev_set_address_window(dev, x0, y1, width, y0-y1+1);
+
+	ili_dev_fill_color(dev, color, (uint32_t)width * (uint32_t)(abs(y1 - y0) + 1));
+}
+
+
+/**
+ * Draw a pixel at a given position with `color`
+ * @param x Start col address
+ * @param y Start row address
+ */
+void ili_dev_draw_pixel(ili_dev_t *dev, uint16_t x, uint16_t y, uint16_t color)
+{
+	/*
+	* Why?: This function is mainly added in the driver so that  ui libraries can use it.
+	*/
+	if (x >= dev->width || y >= dev->height)
+		return;
+	if (dev->dl_rec)
+	{
+		_ili_dl_add(dev, ILI_DL_PIXEL, x, y, x, y, 0, color, NULL);
+		return;
+	}
+
+	// Window runs to the right edge, so a pixel right after this one needs no re-addressing
+	ili_dev_set_address_window(dev, x, y, dev->width - x, 1);
+	// Single 16-bit transfer, so the bus stays in the width used by windows and pixels
+	ili_dev_fill_color(dev, color, 1);
+}
+
+
+
+/**
+ * Rotate the display clockwise or anti-clockwie set by `rotation`
+ * @param rotation Type of rotation. Supported values 0, 1, 2, 3
+ */
+void ili_dev_rotate_display(ili_dev_t *dev, uint8_t rotation)
+{
+    /*
+    *(uint8_t)rotation: Rotation Type
+    *         0 : Default landscape
+    *         1 : Potrait 1
+    *         2 : Landscape 2
+    *         3 : Potrait 2
+    */
+
+//    uint16_t new_height = 240;
+//    uint16_t new_width = 320;
+
+	uint16_t new_height = 320;
+	uint16_t new_width = 240;
+	uint8_t madctl;
+
+    switch (rotation)
+    {
+        case 0:
+            madctl = 0x40 | ILI_MAD_COLOR_ORDER;				//MX: 1, MY: 0, MV: 0	(Portrait 1. Default)
+            dev->height = new_height;
+            dev->width = new_width;
+            break;
+        case 1:
+            madctl = 0x20 | ILI_MAD_COLOR_ORDER;				//MX: 0, MY: 0, MV: 1	(Landscape 1)
+            dev->height = new_width;
+            dev->width = new_height;
+            break;
+        case 2:
+            madctl = 0x80 | ILI_MAD_COLOR_ORDER;				//MX: 0, MY: 1, MV: 0	(Portrait 2)
+            dev->height = new_height;
+            dev->width = new_width;
+            break;
+        case 3:
+            madctl = 0xE0 | ILI_MAD_COLOR_ORDER;				//MX: 1, MY: 1, MV: 1	(Landscape 2)
+            dev->height = new_width;
+            dev->width = new_height;
+            break;
+        default:
+            return;
+    }
+
+    // Pending framebuffer changes are in the old orientation
+    ili_dev_flush(dev);
+    _ili_window_invalidate(dev);
+    // A scroll area is defined along the old orientation
+    if (dev->scroll_on)
+        ili_dev_scroll_stop(dev);
+    dev->rotation = rotation;
+    _ili_write_command_params(dev->bus, ILI_MADCTL, &madctl, 1);		//Memory Access Control
+}
+
+uint8_t ili_dev_display_get_rotation(ili_dev_t *dev)
+{
+	return dev->rotation;
+}
+
+void ili_dev_get_display_size(ili_dev_t *dev, uint16_t *width, uint16_t *height, uint8_t *rotation)
+{
+	*rotation = dev->rotation;
+	*width = dev->width;
+	*height = dev->height;
+}
+
+
+/* ---------------------- Hardware scrolling ---------------------- */
+/*
+ * The panel scrolls frame memory lines along its 320 pixel side: the display's y in rotations 0
+ * and 2, its x in rotations 1 and 3. Rotations 2 and 3 address those lines from the other end,
+ * so the fixed areas swap and the scroll start counts backwards.
+ */
+
+/**
+ * Split the display, along the direction the panel scrolls, into a fixed area, a scrolling area
+ * and another fixed area. That's top to bottom in rotations 0 and 2, left to right in 1 and 3.
+ * The three must add up to 320 lines. Nothing moves until ili_scroll_to() is called.
+ * @param top Lines of the first fixed area
+ * @param area Lines of the scrolling area
+ * @param bottom Lines of the last fixed area
+ */
+void ili_dev_scroll_define(ili_dev_t *dev, uint16_t top, uint16_t area, uint16_t bottom)
+{
+	if ((uint32_t)top + area + bottom != ILI_SCROLL_LINES || area == 0)
+		return;
+
+	uint16_t tfa = (dev->rotation >= 2) ? bottom : top;
+	uint16_t bfa = (dev->rotation >= 2) ? top : bottom;
+	uint8_t params[6] = {tfa >> 8, tfa, area >> 8, area, bfa >> 8, bfa};
+	_ili_window_invalidate(dev);
+	_ili_write_command_params(dev->bus, ILI_VSCRDEF, params, 6);
+	dev->scroll_tfa = tfa;
+	dev->scroll_vsa = area;
+	dev->scroll_top = top;
+}
+
+
+/**
+ * Scroll the area set by ili_scroll_define() so that `line` is shown at its start. The lines
+ * before it wrap around to the end of the area. Drawing is not affected, it still goes to
+ * where the display showed it before scrolling.
+ * @param line Line of the scrolling area, from `top` to `top + area - 1`
+ */
+void ili_dev_scroll_to(ili_dev_t *dev, uint16_t line)
+{
+	if (dev->scroll_vsa == 0 || line < dev->scroll_top || line >= dev->scroll_top + dev->scroll_vsa)
+		return;
+
+	uint16_t vsp = line;
+	if (dev->rotation >= 2)
+		vsp = dev->scroll_tfa + (uint16_t)((ILI_SCROLL_LINES - line - dev->scroll_tfa) % dev->scroll_vsa);
+	uint8_t params[2] = {vsp >> 8, vsp};
+	_ili_window_invalidate(dev);
+	_ili_write_command_params(dev->bus, ILI_VSCRSADD, params, 2);
+	dev->scroll_on = 1;
+}
+
+
+/**
+ * Stop scrolling, the display shows the frame memory as it is again
+ */
+void ili_dev_scroll_stop(ili_dev_t *dev)
+{
+	_ili_window_invalidate(dev);
+	_ili_write_command_params(dev->bus, ILI_NORON, NULL, 0);
+	dev->scroll_on = 0;
+}
+
+
+/* ---------------------- Low power display modes ---------------------- */
+
+/* Internal oscillator of the panel, in Hz */
+#define ILI_OSC_HZ              615000UL
+/* Lines scanned per frame: 320 plus the default front and back porches */
+#define ILI_FRAME_LINES         324
+
+/*
+ * FRMCTR1/2/3 parameters (division ratio, clocks per line) for the frame rate closest to `hz`:
+ * rate = ILI_OSC_HZ / (clocks per line * 2^div * ILI_FRAME_LINES), clocks per line from 16 to 31.
+ * The smallest division that reaches `hz` is used, it has the finest steps
+ */
+static void _ili_frame_rate_params(uint16_t hz, uint8_t *params)
+{
+	uint8_t div = 0;
+	uint32_t rtn = 31;
+	hz = (hz == 0) ? 1 : hz;
+	for (div = 0; div < 4; div++)
+	{
+		rtn = (ILI_OSC_HZ + (uint32_t)hz * ILI_FRAME_LINES * (1UL << div) / 2) / ((uint32_t)hz * ILI_FRAME_LINES * (1UL << div));
+		if (rtn <= 31)
+			break;
+	}
+	div = (div > 3) ? 3 : div;
+	rtn = (rtn > 31) ? 31 : (rtn < 16) ? 16 : rtn;
+	params[0] = div;
+	params[1] = (uint8_t)rtn;
+}
+
+
+/**
+ * Only refresh the display lines `start` to `end` (partial mode), the rest of the panel is not
+ * driven and shows the non-display color. Lines run along the panel's 320 pixel side, like
+ * the scroll area: display rows in rotations 0 and 2, display columns in 1 and 3.
+ * Leaves scrolling. The partial mode frame rate is set by ili_set_low_power_frame_rate().
+ * @param start First line of the partial area
+ * @param end Last line of the partial area
+ */
+void ili_dev_partial_area(ili_dev_t *dev, uint16_t start, uint16_t end)
+{
+	if (start > end || end >= ILI_SCROLL_LINES)
+		return;
+
+	uint16_t sr = (dev->rotation >= 2) ? ILI_SCROLL_LINES - 1 - end : start;
+	uint16_t er = (dev->rotation >= 2) ? ILI_SCROLL_LINES - 1 - start : end;
+	uint8_t params[4] = {sr >> 8, sr, er >> 8, er};
+	_ili_window_invalidate(dev);
+	_ili_write_command_params(dev->bus, ILI_PTLAR, params, 4);
+	_ili_write_command_params(dev->bus, ILI_PTLON, NULL, 0);
+	dev->scroll_on = 0;
+}
+
+
+/**
+ * Leave partial mode (and scrolling), the whole display is refreshed again
+ */
+void ili_dev_partial_off(ili_dev_t *dev)
+{
+	_ili_window_invalidate(dev);
+	_ili_write_command_params(dev->bus, ILI_NORON, NULL, 0);
+	dev->scroll_on = 0;
+}
+
+
+/**
+ * Enter or leave idle mode. In idle mode the panel shows 8 colors, only the most significant
+ * bit of red, green and blue, and runs at the frame rate set by ili_set_low_power_frame_rate().
+ * Frame memory keeps all the colors, they are back when idle mode is left.
+ * @param enable 1 to enter idle mode, 0 to leave it
+ */
+void ili_dev_idle_mode(ili_dev_t *dev, uint8_t enable)
+{
+	_ili_window_invalidate(dev);
+	_ili_write_command_params(dev->bus, enable ? ILI_IDMON : ILI_IDMOFF, NULL, 0);
+}
+
+
+/**
+ * Set the frame rate of idle mode and partial mode (FRMCTR2 and FRMCTR3). A static screen
+ * doesn't need the normal mode rate, and every frame costs panel power.
+ * Reachable rates are about 8 to 118 Hz, the closest one is used.
+ * @param hz Frame rate in Hz
+ */
+void ili_dev_set_low_power_frame_rate(ili_dev_t *dev, uint16_t hz)
+{
+	uint8_t params[2];
+	_ili_frame_rate_params(hz, params);
+	_ili_window_invalidate(dev);
+	_ili_write_command_params(dev->bus, ILI_FRMCTR2, params, 2);
+	_ili_write_command_params(dev->bus, ILI_FRMCTR3, params, 2);
+}
+
+
+/* ---------------------- Frame rate and tearing effect ---------------------- */
+
+/**
+ * Set the normal mode frame rate (FRMCTR1). ili_init() sets ILI_FRAME_RATE_HZ.
+ * A lower rate gives a write more time to stay ahead of the refresh, see ili_flush_vsync().
+ * Reachable rates are about 8 to 118 Hz, the closest one is used.
+ * @param hz Frame rate in Hz
+ */
+void ili_dev_set_frame_rate(ili_dev_t *dev, uint16_t hz)
+{
+	uint8_t params[2];
+	_ili_frame_rate_params(hz, params);
+	_ili_window_invalidate(dev);
+	_ili_write_command_params(dev->bus, ILI_FRMCTR1, params, 2);
+}
+
+
+/**
+ * Turn on the tearing effect output of the panel (TE pin). It pulses once per frame, when the
+ * refresh reaches line `scanline`. Line 0 is the start of the vertical blanking, the first
+ * display line follows two lines later. Display lines run along the panel's 320 pixel side
+ * from the top of rotation 0, like the scroll area.
+ * @param scanline Line the pulse comes at
+ */
+void ili_dev_te_enable(ili_dev_t *dev, uint16_t scanline)
+{
+	scanline = (scanline >= ILI_SCROLL_LINES) ? ILI_SCROLL_LINES - 1 : scanline;
+	uint8_t params[2] = {scanline >> 8, scanline};
+	_ili_window_invalidate(dev);
+	_ili_write_command_params(dev->bus, ILI_STE, params, 2);
+	_ili_write_command_params(dev->bus, ILI_TEON, (const uint8_t []){0x00}, 1);    // V-blanking information only
+	dev->te_on = 1;
+}
+
+
+/**
+ * Turn off the tearing effect output, ili_wait_te() doesn't wait anymore
+ */
+void ili_dev_te_disable(ili_dev_t *dev)
+{
+	_ili_window_invalidate(dev);
+	_ili_write_command_params(dev->bus, ILI_TEOFF, NULL, 0);
+	dev->te_on = 0;
+}
+
+
+#if defined(ILI_PLATFORM_TE)
+/**
+ * Wait for the transfer in progress, then for the next tearing effect pulse.
+ * Returns at once if the output is off.
+ */
+void ili_dev_wait_te(ili_dev_t *dev)
+{
+	if (!dev->te_on)
+		return;
+	_ILI_WAIT_IDLE(dev->bus);
+	ili_platform_te_wait(dev->bus);
+}
+
+
+/* First line the refresh reaches of a rectangle, in the scan order of the current rotation */
+static uint16_t _ili_rect_scan_line(ili_dev_t *dev, const _ili_rect_t *r)
+{
+	switch (dev->rotation)
+	{
+	case 1:		return r->x0;
+	case 2:		return ILI_SCROLL_LINES - 1 - r->y1;
+	case 3:		return ILI_SCROLL_LINES - 1 - r->x1;
+	default:	return r->y0;
+	}
+}
+
+/**
+ * ili_flush(), synchronized to the refresh. When at least ILI_VSYNC_MIN_PX pixels are dirty the
+ * rectangles are sorted in scan order and sent from the next tearing effect pulse on, so the
+ * write pointer follows the refresh instead of crossing it. Smaller updates go out at once.
+ * In rotation 0, where rows are written in scan order, an update doesn't tear if it takes:
+ * - less than a frame period, from a pulse at line 0: it stays ahead of the refresh
+ * - less than two frame periods, from a pulse a few lines later (ili_te_enable(8)): it stays
+ *   behind the refresh. A full frame takes 30.7ms at 40MHz SPI, 60Hz is slow enough
+ * Rows skipped between two rectangles let the write jump ahead of a refresh it was following.
+ */
+void ili_dev_flush_vsync(ili_dev_t *dev)
+{
+	if (!dev->fb_buf)
+		return;
+
+	_ili_fb_merge_dirty(dev);
+
+	uint32_t px = 0;
+	for (uint8_t i = 0; i < dev->fb_dirty_cnt; i++)
+		px += (uint32_t)(dev->fb_dirty[i].x1 - dev->fb_dirty[i].x0 + 1) * (dev->fb_dirty[i].y1 - dev->fb_dirty[i].y0 + 1);
+
+	if (px >= ILI_VSYNC_MIN_PX && dev->te_on)
+	{
+		for (uint8_t i = 1; i < dev->fb_dirty_cnt; i++)
+		{
+			_ili_rect_t r = dev->fb_dirty[i];
+			uint16_t line = _ili_rect_scan_line(dev, &r);
+			uint8_t j = i;
+			for (; j > 0 && _ili_rect_scan_line(dev, &dev->fb_dirty[j - 1]) > line; j--)
+				dev->fb_dirty[j] = dev->fb_dirty[j - 1];
+			dev->fb_dirty[j] = r;
+		}
+		ili_dev_wait_te(dev);
+	}
+	_ili_fb_send_dirty(dev);
+}
+#endif /* defined(ILI_PLATFORM_TE) */
+
+
+/**
+ * Start a scrolling text console on the display lines `top` to `319 - bottom`.
+ * Needs rotation 0 or 2, the panel can't scroll lines of text in the other rotations.
+ * The console area is cleared with `bg_color`.
+ * @param con Console state, kept by the user
+ * @param font Font of the text
+ * @param top Lines above the console that stay fixed
+ * @param bottom Lines below the console that stay fixed. Lines that don't make a whole text row are added to it
+ * @param color 16-bit RGB565 text color
+ * @param bg_color 16-bit RGB565 background color
+ */
+void ili_dev_console_init(ili_dev_t *dev, ili_console_t *con, const ili_font_t *font, uint16_t top, uint16_t bottom,
+									  uint16_t color, uint16_t bg_color)
+{
+	con->font = font;
+	con->top = top;
+	con->color = color;
+	con->bg_color = bg_color;
+	con->count = 0;
+	con->rows = 0;
+	if (dev->rotation & 1 || (uint32_t)top + bottom >= ILI_SCROLL_LINES || font->y_advance == 0)
+		return;
+
+	con->rows = (ILI_SCROLL_LINES - top - bottom) / font->y_advance;
+	if (con->rows == 0)
+		return;
+	uint16_t area = con->rows * font->y_advance;
+	ili_dev_scroll_define(dev, top, area, ILI_SCROLL_LINES - top - area);
+	ili_dev_scroll_to(dev, top);
+	ili_dev_fill_rect(dev, 0, top, dev->width, area, bg_color);
+}
+
+
+/**
+ * Print a line at the bottom of the console, the older lines move up. Once the console is full,
+ * the line is drawn over the oldest one, which the scroll brings to the bottom, so only
+ * one row of text is sent per line. Each '\n' in `str` starts a new line.
+ * @param con Console started by ili_console_init()
+ * @param str Null terminated string
+ */
+void ili_dev_console_print(ili_dev_t *dev, ili_console_t *con, const char *str)
+{
+	if (con->rows == 0)
+		return;
+
+	const ili_font_t *font = con->font;
+	while (1)
+	{
+		// Row of frame memory the line goes to, the oldest one once the console is full
+		uint16_t slot = con->count % con->rows;
+		uint16_t y = con->top + slot * font->y_advance;
+		uint16_t len = _ili_text_line_len(str);
+		uint16_t w = _ili_text_line_width(str, len, font);
+		w = (w > dev->width) ? dev->width : w;
+
+		if (w > 0)
+			_ili_text_draw_line(dev, 0, y, str, len, font, con->color, con->bg_color, w, font->y_advance);
+		if (w < dev->width)
+			ili_dev_fill_rect(dev, w, y, dev->width - w, font->y_advance, con->bg_color);
+		con->count++;
+		if (con->count >= con->rows)
+			ili_dev_scroll_to(dev, con->top + (con->count % con->rows) * font->y_advance);
+
+		if (str[len] == '\0')
+			break;
+		str += len + 1;
+	}
+}
+
+#if defined(ILI_BUS_TYPE_SPI) && defined(ILI_PLATFORM_SPI_READ)
+/* ---------------------- Frame memory read-back ---------------------- */
+
+/* Pixels per read command: the dummy byte and 3 bytes per pixel fit in the temporary display buffer */
+#define ILI_READ_CHUNK_PX   ((ILI_TMP_DISP_BUF_PX_CNT * 2 - 1) / 3)
+
+/*
+ * Read `n` (up to ILI_READ_CHUNK_PX) pixels of the address window into `dst`, which may be the
+ * temporary display buffer itself. `first` starts at the window start (RAMRD), else the read goes
+ * on where the last one stopped (RAMRDC). The panel sends a dummy byte, then red, green and blue
+ * with 6 bits each, in the upper bits of their bytes.
+ */
+static void _ili_read_chunk(ili_dev_t *dev, uint8_t first, uint16_t *dst, uint32_t n)
+{
+	uint8_t *raw = (uint8_t *)dev->tmp_disp_buffer;
+
+	_ILI_WAIT_IDLE(dev->bus);
+	ili_platform_spi_read_cmd(dev->bus, first ? ILI_RAMRD : ILI_RAMRDC, raw, 1 + n * 3);
+	// Safe in place: pixel i goes to bytes 2i and 2i+1, its own bytes start at 3i+1
+	for (uint32_t i = 0; i < n; i++)
+	{
+		const uint8_t *rgb = raw + 1 + i * 3;
+		dst[i] = ((uint16_t)(rgb[0] & 0xF8) << 8) | ((uint16_t)(rgb[1] & 0xFC) << 3) | (rgb[2] >> 3);
+	}
+}
+
+
+/**
+ * Read a `w`x`h` area of the frame memory back into `buf`, row by row. The panel sends 18-bit
+ * RGB666 pixels at ILI_SPI_READ_FREQ, they are converted to RGB565, which gives back exactly
+ * the colors that were drawn. Parts outside the display are not read, `buf` keeps w*h layout.
+ * Reads the panel, not an attached framebuffer: call ili_flush() before if there's one.
+ * Frame memory is not affected by scrolling, partial or idle mode.
+ * @param x Start col address
+ * @param y Start row address
+ * @param w Width of the area
+ * @param h Height of the area
+ * @param buf w*h pixels
+ */
+void ili_dev_read_pixels(ili_dev_t *dev, uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t *buf)
+{
+	if (x >= dev->width || y >= dev->height || w == 0 || h == 0)
+		return;
+	uint16_t cw = ((uint32_t)x + w > dev->width) ? dev->width - x : w;
+	uint16_t ch = ((uint32_t)y + h > dev->height) ? dev->height - y : h;
+
+	// Reading ends the RAMWR stream
+	_ili_send_window(dev, dev->bus, x, y, x + cw - 1, y + ch - 1);
+	dev->wp_valid = 0;
+
+	// Unclipped rows lie back to back in `buf`, the whole area is one run
+	uint32_t run = (cw == w) ? (uint32_t)cw * ch : cw;
+	uint16_t runs = (cw == w) ? 1 : ch;
+	uint8_t first = 1;
+	for (uint16_t i = 0; i < runs; i++)
+	{
+		uint16_t *dst = buf + (uint32_t)i * w;
+		for (uint32_t done = 0; done < run; )
+		{
+			uint32_t n = run - done;
+			n = (n > ILI_READ_CHUNK_PX) ? ILI_READ_CHUNK_PX : n;
+			_ili_read_chunk(dev, first, dst + done, n);
+			first = 0;
+			done += n;
+		}
+	}
+}
+
+
+/**
+ * Move the `w`x`h` area at (src_x, src_y) to (dst_x, dst_y) on the display, through the
+ * temporary display buffer, without a framebuffer. Source and destination may overlap.
+ * The area is clipped so that both fit on the display. The source keeps its content
+ * where the destination doesn't cover it. Reading takes longer than writing, see
+ * ili_read_pixels(): it pays off over content that is slow to render, not over plain fills.
+ * Copies are done right away, even while a display list is recorded.
+ * @param src_x Start col address of the source
+ * @param src_y Start row address of the source
+ * @param w Width of the area
+ * @param h Height of the area
+ * @param dst_x Start col address of the destination
+ * @param dst_y Start row address of the destination
+ */
+void ili_dev_copy_rect(ili_dev_t *dev, uint16_t src_x, uint16_t src_y, uint16_t w, uint16_t h, uint16_t dst_x, uint16_t dst_y)
+{
+	if (src_x >= dev->width || dst_x >= dev->width || src_y >= dev->height || dst_y >= dev->height)
+		return;
+	uint16_t max_x = (src_x > dst_x) ? src_x : dst_x;
+	uint16_t max_y = (src_y > dst_y) ? src_y : dst_y;
+	w = ((uint32_t)max_x + w > dev->width) ? dev->width - max_x : w;
+	h = ((uint32_t)max_y + h > dev->height) ? dev->height - max_y : h;
+	if (w == 0 || h == 0 || (src_x == dst_x && src_y == dst_y))
+		return;
+
+	// Blocks of whole rows, or pieces of a single row when it's wider than a block
+	uint16_t seg_w = (w > ILI_READ_CHUNK_PX) ? ILI_READ_CHUNK_PX : w;
+	uint16_t rows = (w > ILI_READ_CHUNK_PX) ? 1 : ILI_READ_CHUNK_PX / w;
+	// Every block is read before anything is written over it: bottom up when
+	// moving down, right to left when moving right
+	uint8_t from_bottom = dst_y > src_y;
+	uint8_t from_right = dst_x > src_x;
+
+	for (uint16_t i = 0; i < h; i += rows)
+	{
+		uint16_t bh = (h - i < rows) ? h - i : rows;
+		uint16_t by = from_bottom ? h - i - bh : i;
+		for (uint16_t j = 0; j < w; j += seg_w)
+		{
+			uint16_t bw = (w - j < seg_w) ? w - j : seg_w;
+			uint16_t bx = from_right ? w - j - bw : j;
+			uint32_t len = (uint32_t)bw * bh;
+
+			_ili_send_window(dev, dev->bus, src_x + bx, src_y + by, src_x + bx + bw - 1, src_y + by + bh - 1);
+			dev->wp_valid = 0;
+			_ili_read_chunk(dev, 1, dev->tmp_disp_buffer, len);
+			ili_dev_set_address_window(dev, dst_x + bx, dst_y + by, bw, bh);
+			ili_dev_draw_pixels_buffer(dev, dev->tmp_disp_buffer, len);
+		}
+	}
+}
+
+
+/**
+ * Read the whole display, row by row, and hand each row to `cb`, e.g. to write it to a file
+ * or a serial port. Only one row is held in RAM.
+ * @param row_buf Room for one display row (display width pixels)
+ * @param cb Called for every row, top to bottom
+ * @param user_data Passed to `cb`
+ */
+void ili_dev_screenshot(ili_dev_t *dev, uint16_t *row_buf, ili_screenshot_cb_t cb, void *user_data)
+{
+	for (uint16_t y = 0; y < dev->height; y++)
+	{
+		ili_dev_read_pixels(dev, 0, y, dev->width, 1, row_buf);
+		cb(row_buf, y, dev->width, user_data);
+	}
+}
+#endif /* defined(ILI_BUS_TYPE_SPI) && defined(ILI_PLATFORM_SPI_READ) */
+
+/* ---------------------- Init ---------------------- */
+
+/* _ili_frame_rate_params() at compile time, for the init sequence */
+#define _ILI_RTN(hz, div)           ((ILI_OSC_HZ + (uint32_t)(hz) * ILI_FRAME_LINES * (1UL << (div)) / 2) / \
+                                        ((uint32_t)(hz) * ILI_FRAME_LINES * (1UL << (div))))
+#define _ILI_FRAME_RATE_DIV(hz)     ((_ILI_RTN(hz, 0) <= 31) ? 0 : (_ILI_RTN(hz, 1) <= 31) ? 1 : \
+                                        (_ILI_RTN(hz, 2) <= 31) ? 2 : 3)
+#define _ILI_FRAME_RATE_RTN(hz)     ((_ILI_RTN(hz, _ILI_FRAME_RATE_DIV(hz)) > 31) ? 31 : \
+                                        (_ILI_RTN(hz, _ILI_FRAME_RATE_DIV(hz)) < 16) ? 16 : \
+                                        _ILI_RTN(hz, _ILI_FRAME_RATE_DIV(hz)))
+
+/* Sleep out takes 5ms before the next command, the supplies settle while the first frame is written */
+#define _ILI_SEQ_SLEEP_OUT          ILI_SLPOUT, ILI_SEQ_WAIT | 0, 5
+
+const uint8_t ili_init_seq_1[] =
+{
+	0xEF, 3, 0x03, 0x80, 0x02,
+	0xCF, 3, 0x00, 0xC1, 0x30,
+	0xED, 4, 0x64, 0x03, 0x12, 0x81,
+	0xE8, 3, 0x85, 0x00, 0x78,
+	0xCB, 5, 0x39, 0x2C, 0x00, 0x34, 0x02,
+	0xF7, 1, 0x20,
+	0xEA, 2, 0x00, 0x00,
+	ILI_PWCTR1, 1, 0x23,                        // Power control, VRH[5:0]
+	ILI_PWCTR2, 1, 0x10,                        // Power control, SAP[2:0];BT[3:0]
+	ILI_VMCTR1, 2, 0x3E, 0x28,                  // VCM control
+	ILI_VMCTR2, 1, 0x86,                        // VCM control2
+	ILI_MADCTL, 1, 0x40 | ILI_MAD_COLOR_ORDER,  // Rotation 0 (portrait mode)
+	ILI_PIXFMT, 1, 0x55,
+	ILI_FRMCTR1, 2, _ILI_FRAME_RATE_DIV(ILI_FRAME_RATE_HZ), _ILI_FRAME_RATE_RTN(ILI_FRAME_RATE_HZ),
+	ILI_DFUNCTR, 3, 0x08, 0x82, 0x27,           // Display Function Control
+	0xF2, 1, 0x00,                              // 3Gamma Function Disable
+	ILI_GAMMASET, 1, 0x01,                      // Gamma curve selected
+	ILI_GMCTRP1, 15, 0x0F, 0x31, 0x2B, 0x0C, 0x0E, 0x08, 0x4E, 0xF1, 0x37, 0x07, 0x10, 0x03, 0x0E, 0x09, 0x00,
+	ILI_GMCTRN1, 15, 0x00, 0x0E, 0x14, 0x03, 0x11, 0x07, 0x31, 0xC1, 0x48, 0x08, 0x0F, 0x0C, 0x31, 0x36, 0x0F,
+	_ILI_SEQ_SLEEP_OUT,
+	ILI_SEQ_END
+};
+
+const uint8_t ili_init_seq_2[] =
+{
+	0xCF, 3, 0x00, 0xC1, 0x30,
+	0xED, 4, 0x64, 0x03, 0x12, 0x81,
+	0xE8, 3, 0x85, 0x00, 0x78,
+	0xCB, 5, 0x39, 0x2C, 0x00, 0x34, 0x02,
+	0xF7, 1, 0x20,
+	0xEA, 2, 0x00, 0x00,
+	ILI_PWCTR1, 1, 0x10,                        // Power control, VRH[5:0]
+	ILI_PWCTR2, 1, 0x00,                        // Power control, SAP[2:0];BT[3:0]
+	ILI_VMCTR1, 2, 0x30, 0x30,                  // VCM control
+	ILI_VMCTR2, 1, 0xB7,                        // VCM control2
+	ILI_PIXFMT, 1, 0x55,
+	ILI_MADCTL, 1, 0x40 | ILI_MAD_COLOR_ORDER,  // Rotation 0 (portrait mode)
+	ILI_FRMCTR1, 2, 0x00, 0x1A,
+	ILI_DFUNCTR, 3, 0x08, 0x82, 0x27,           // Display Function Control
+	0xF2, 1, 0x00,                              // 3Gamma Function Disable
+	ILI_GAMMASET, 1, 0x01,                      // Gamma curve selected
+	ILI_GMCTRP1, 15, 0x0F, 0x2A, 0x28, 0x08, 0x0E, 0x08, 0x54, 0xA9, 0x43, 0x0A, 0x0F, 0x00, 0x00, 0x00, 0x00,
+	ILI_GMCTRN1, 15, 0x00, 0x15, 0x17, 0x07, 0x11, 0x06, 0x2B, 0x56, 0x3C, 0x05, 0x10, 0x0F, 0x3F, 0x3F, 0x0F,
+	ILI_PASET, 4, 0x00, 0x00, 0x01, 0x3F,
+	ILI_CASET, 4, 0x00, 0x00, 0x00, 0xEF,
+	_ILI_SEQ_SLEEP_OUT,
+	ILI_SEQ_END
+};
+
+/* Send an init sequence, each command with its parameters in one burst */
+static void _ili_run_seq(ili_bus_t *bus, const uint8_t *seq)
+{
+	while (seq[0] != ILI_SEQ_END)
+	{
+		uint8_t n = seq[1] & ~ILI_SEQ_WAIT;
+		_ili_write_command_params(bus, seq[0], (n > 0) ? &seq[2] : NULL, n);
+		if (seq[1] & ILI_SEQ_WAIT)
+		{
+			ili_platform_delay(seq[2 + n]);
+			seq++;
+		}
+		seq += 2 + n;
+	}
+}
+
+/**
+ * Reset the panel and run the init sequence `seq`. The built-in ones end with sleep out and leave
+ * the display off, so the first frame can be written while the supplies settle.
+ * The reset brings back rotation 0 (240x320) and no scroll area, the instance follows it.
+ * @param seq Init sequence, see ILI_SEQ_WAIT
+ */
+void ili_dev_init_seq(ili_dev_t *dev, const uint8_t *seq)
+{
+	// Same as after ili_dev_setup(), the sequences send MADCTL for rotation 0
+	dev->width = 240;
+	dev->height = 320;
+	dev->rotation = 0;
+	dev->scroll_tfa = 0;
+	dev->scroll_vsa = 0;
+	dev->scroll_top = 0;
+	dev->scroll_on = 0;
+	dev->te_on = 0;
+	_ili_window_invalidate(dev);
+
+// Hardware reset is not mandatory if software rest is done
+#if defined(ILI_PLATFORM_RST_LOW) && defined(ILI_PLATFORM_RST_HIGH)
+	ILI_PLATFORM_RST_LOW(dev->bus);
+	ili_platform_delay(1);    // 10us minimum
+	ILI_PLATFORM_RST_HIGH(dev->bus);
+#else
+	_ili_write_command_params(dev->bus, ILI_SWRESET, NULL, 0);
+#endif
+	ili_platform_delay(ILI_RESET_WAIT_MS);
+
+	_ili_run_seq(dev->bus, seq);
+	_ili_window_invalidate(dev);
+}
+
+/**
+ * Turn the display on or off, frame memory is kept
+ * @param on 1 to show the frame memory, 0 to blank the display
+ */
+void ili_dev_display_on(ili_dev_t *dev, uint8_t on)
+{
+	_ili_window_invalidate(dev);
+	_ili_write_command_params(dev->bus, on ? ILI_DISPON : ILI_DISPOFF, NULL, 0);
+}
+
+/**
+ * Enter or leave sleep mode, frame memory and registers are kept
+ * @param enable 1 to enter sleep mode, 0 to leave it
+ */
+void ili_dev_sleep(ili_dev_t *dev, uint8_t enable)
+{
+	_ili_window_invalidate(dev);
+	_ili_write_command_params(dev->bus, enable ? ILI_SLPIN : ILI_SLPOUT, NULL, 0);
+	ili_platform_delay(5);
+}
+
+/**
+ * Initialize the display driver: reset, init sequence ILI_INIT_SEQ and display on
+ */
+void ili_dev_init(ili_dev_t *dev)
+{
+	ili_dev_init_seq(dev, ILI_INIT_SEQ);
+	ili_dev_display_on(dev, 1);
+}
+
+
+/* ---------------------- Default instance ---------------------- */
+/* The API without a handle, each function runs its ili_dev_* variant on g_ili_dev */
+#if !defined(ILI_NO_DEFAULT_INSTANCE)
+
+void ili_bus_init(void)
+{
+	ili_dev_bus_init(&g_ili_dev);
+}
+
+void ili_bus_deinit(void)
+{
+	ili_dev_bus_deinit(&g_ili_dev);
+}
+
+void ili_init(void)
+{
+	ili_dev_init(&g_ili_dev);
+}
+
+void ili_init_seq(const uint8_t *seq)
+{
+	ili_dev_init_seq(&g_ili_dev, seq);
+}
+
+void ili_display_on(uint8_t on)
+{
+	ili_dev_display_on(&g_ili_dev, on);
+}
+
+void ili_sleep(uint8_t enable)
+{
+	ili_dev_sleep(&g_ili_dev, enable);
+}
+
+void ili_set_address_window(uint16_t x, uint16_t y, uint16_t w, uint16_t h)
+{
+	ili_dev_set_address_window(&g_ili_dev, x, y, w, h);
+}
+
+void ili_draw_pixels_buffer(uint16_t *color_buffer, uint32_t len)
+{
+	ili_dev_draw_pixels_buffer(&g_ili_dev, color_buffer, len);
+}
+
+void ili_draw_pixels_buffer_stride(uint16_t *color_buffer, uint16_t w, uint16_t h, uint32_t stride)
+{
+	ili_dev_draw_pixels_buffer_stride(&g_ili_dev, color_buffer, w, h, stride);
+}
+
+void ili_draw_pixels_buffer_async(uint16_t *color_buffer, uint32_t len, ili_xfer_done_cb_t cb, void *user_data)
+{
+	ili_dev_draw_pixels_buffer_async(&g_ili_dev, color_buffer, len, cb, user_data);
+}
+
+void ili_wait_idle(void)
+{
+	ili_dev_wait_idle(&g_ili_dev);
+}
+
+void ili_fill_color(uint16_t color, uint32_t len)
+{
+	ili_dev_fill_color(&g_ili_dev, color, len);
+}
+
+void ili_fb_attach(uint16_t *buf, uint16_t x, uint16_t y, uint16_t w, uint16_t h)
+{
+	ili_dev_fb_attach(&g_ili_dev, buf, x, y, w, h);
+}
+
+void ili_fb_detach(void)
+{
+	ili_dev_fb_detach(&g_ili_dev);
+}
+
+void ili_flush(void)
+{
+	ili_dev_flush(&g_ili_dev);
+}
+
+void ili_render_strips(uint16_t *buf0, uint16_t *buf1, uint16_t strip_h, ili_strip_render_cb_t render, void *user_data)
+{
+	ili_dev_render_strips(&g_ili_dev, buf0, buf1, strip_h, render, user_data);
+}
+
+void ili_dl_begin(ili_dl_t *dl)
+{
+	ili_dev_dl_begin(&g_ili_dev, dl);
+}
+
+void ili_dl_end(void)
+{
+	ili_dev_dl_end(&g_ili_dev);
+}
+
+void ili_dl_optimize(ili_dl_t *dl)
+{
+	ili_dev_dl_optimize(&g_ili_dev, dl);
+}
+
+void ili_dl_replay(const ili_dl_t *dl)
+{
+	ili_dev_dl_replay(&g_ili_dev, dl);
+}
+
+void ili_fill_rect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color)
+{
+	ili_dev_fill_rect(&g_ili_dev, x, y, w, h, color);
+}
+
+void ili_draw_bitmap(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t *bitmap)
+{
+	ili_dev_draw_bitmap(&g_ili_dev, x, y, w, h, bitmap);
+}
+
+void ili_draw_image_rle(uint16_t x, uint16_t y, const ili_image_rle_t *img)
+{
+	ili_dev_draw_image_rle(&g_ili_dev, x, y, img);
+}
+
+void ili_draw_image_indexed(uint16_t x, uint16_t y, const ili_image_indexed_t *img, const uint16_t *palette)
+{
+	ili_dev_draw_image_indexed(&g_ili_dev, x, y, img, palette);
+}
+
+void ili_fill_rect_alpha(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color, uint8_t alpha, uint16_t bg_color)
+{
+	ili_dev_fill_rect_alpha(&g_ili_dev, x, y, w, h, color, alpha, bg_color);
+}
+
+void ili_draw_bitmap_alpha(uint16_t x, uint16_t y, uint16_t w, uint16_t h, const uint16_t *bitmap, const uint8_t *alpha, uint16_t bg_color)
+{
+	ili_dev_draw_bitmap_alpha(&g_ili_dev, x, y, w, h, bitmap, alpha, bg_color);
+}
+
+void ili_draw_pixels_rgb888(const void *src, uint32_t len, uint8_t format, uint8_t flags)
+{
+	ili_dev_draw_pixels_rgb888(&g_ili_dev, src, len, format, flags);
+}
+
+void ili_fill_rect_fast(uint16_t x1, uint16_t y1, uint16_t w, uint16_t h, uint16_t color)
+{
+	ili_dev_fill_rect_fast(&g_ili_dev, x1, y1, w, h, color);
+}
+
+void ili_fill_screen(uint16_t color)
+{
+	ili_dev_fill_screen(&g_ili_dev, color);
+}
+
+void ili_draw_rectangle(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color)
+{
+	ili_dev_draw_rectangle(&g_ili_dev, x, y, w, h, color);
+}
+
+void ili_fill_ellipse(uint16_t x0, uint16_t y0, uint16_t rx, uint16_t ry, uint16_t color)
+{
+	ili_dev_fill_ellipse(&g_ili_dev, x0, y0, rx, ry, color);
+}
+
+void ili_draw_ellipse(uint16_t x0, uint16_t y0, uint16_t rx, uint16_t ry, uint16_t color)
+{
+	ili_dev_draw_ellipse(&g_ili_dev, x0, y0, rx, ry, color);
+}
+
+void ili_fill_circle(uint16_t x0, uint16_t y0, uint16_t r, uint16_t color)
+{
+	ili_dev_fill_circle(&g_ili_dev, x0, y0, r, color);
+}
+
+void ili_draw_circle(uint16_t x0, uint16_t y0, uint16_t r, uint16_t color)
+{
+	ili_dev_draw_circle(&g_ili_dev, x0, y0, r, color);
+}
+
+void ili_fill_arc(uint16_t x0, uint16_t y0, uint16_t r_outer, uint16_t r_inner, int16_t start_angle, int16_t end_angle, uint16_t color)
+{
+	ili_dev_fill_arc(&g_ili_dev, x0, y0, r_outer, r_inner, start_angle, end_angle, color);
+}
+
+void ili_draw_arc(uint16_t x0, uint16_t y0, uint16_t r, int16_t start_angle, int16_t end_angle, uint16_t color)
+{
+	ili_dev_draw_arc(&g_ili_dev, x0, y0, r, start_angle, end_angle, color);
+}
+
+void ili_fill_round_rect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t r, uint16_t color)
+{
+	ili_dev_fill_round_rect(&g_ili_dev, x, y, w, h, r, color);
+}
+
+void ili_draw_round_rect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t r, uint16_t color)
+{
+	ili_dev_draw_round_rect(&g_ili_dev, x, y, w, h, r, color);
+}
+
+void ili_fill_polygon(const ili_point_t *points, uint16_t count, uint16_t color)
+{
+	ili_dev_fill_polygon(&g_ili_dev, points, count, color);
+}
+
+void ili_fill_triangle(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint16_t color)
+{
+	ili_dev_fill_triangle(&g_ili_dev, x0, y0, x1, y1, x2, y2, color);
+}
+
+void ili_draw_string(uint16_t x, uint16_t y, const char *str, const ili_font_t *font, uint16_t color, uint16_t bg_color)
+{
+	ili_dev_draw_string(&g_ili_dev, x, y, str, font, color, bg_color);
+}
+
+void ili_text_cache_attach(uint16_t *pool, uint32_t pool_px)
+{
+	ili_dev_text_cache_attach(&g_ili_dev, pool, pool_px);
+}
+
+void ili_text_cache_detach(void)
+{
+	ili_dev_text_cache_detach(&g_ili_dev);
+}
+
+void ili_draw_polyline_ex(const ili_point_t *points, uint16_t count, uint8_t width, uint16_t color, uint8_t join, uint8_t cap)
+{
+	ili_dev_draw_polyline_ex(&g_ili_dev, points, count, width, color, join, cap);
+}
+
+void ili_draw_line(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint8_t width, uint16_t color)
+{
+	ili_dev_draw_line(&g_ili_dev, x0, y0, x1, y1, width, color);
+}
+
+void ili_draw_polyline(const ili_point_t *points, uint16_t count, uint8_t width, uint16_t color)
+{
+	ili_dev_draw_polyline(&g_ili_dev, points, count, width, color);
+}
+
+void ili_draw_pixel(uint16_t x, uint16_t y, uint16_t color)
+{
+	ili_dev_draw_pixel(&g_ili_dev, x, y, color);
+}
+
+void ili_rotate_display(uint8_t rotation)
+{
+	ili_dev_rotate_display(&g_ili_dev, rotation);
+}
+
+uint8_t ili_display_get_rotation(void)
+{
+	return ili_dev_display_get_rotation(&g_ili_dev);
+}
+
+void ili_get_display_size(uint16_t *width, uint16_t *height, uint8_t *rotation)
+{
+	ili_dev_get_display_size(&g_ili_dev, width, height, rotation);
+}
+
+void ili_scroll_define(uint16_t top, uint16_t area, uint16_t bottom)
+{
+	ili_dev_scroll_define(&g_ili_dev, top, area, bottom);
+}
+
+void ili_scroll_to(uint16_t line)
+{
+	ili_dev_scroll_to(&g_ili_dev, line);
+}
+
+void ili_scroll_stop(void)
+{
+	ili_dev_scroll_stop(&g_ili_dev);
+}
+
+void ili_partial_area(uint16_t start, uint16_t end)
+{
+	ili_dev_partial_area(&g_ili_dev, start, end);
+}
+
+void ili_partial_off(void)
+{
+	ili_dev_partial_off(&g_ili_dev);
+}
+
+void ili_idle_mode(uint8_t enable)
+{
+	ili_dev_idle_mode(&g_ili_dev, enable);
+}
+
+void ili_set_low_power_frame_rate(uint16_t hz)
+{
+	ili_dev_set_low_power_frame_rate(&g_ili_dev, hz);
+}
+
+void ili_set_frame_rate(uint16_t hz)
+{
+	ili_dev_set_frame_rate(&g_ili_dev, hz);
+}
+
+void ili_te_enable(uint16_t scanline)
+{
+	ili_dev_te_enable(&g_ili_dev, scanline);
+}
+
+void ili_te_disable(void)
+{
+	ili_dev_te_disable(&g_ili_dev);
+}
+
+#if defined(ILI_PLATFORM_TE)
+void ili_wait_te(void)
+{
+	ili_dev_wait_te(&g_ili_dev);
+}
+
+void ili_flush_vsync(void)
+{
+	ili_dev_flush_vsync(&g_ili_dev);
+}
+#endif /* defined(ILI_PLATFORM_TE) */
+
+void ili_console_init(ili_console_t *con, const ili_font_t *font, uint16_t top, uint16_t bottom, uint16_t color, uint16_t bg_color)
+{
+	ili_dev_console_init(&g_ili_dev, con, font, top, bottom, color, bg_color);
+}
+
+void ili_console_print(ili_console_t *con, const char *str)
+{
+	ili_dev_console_print(&g_ili_dev, con, str);
+}
+
+#if defined(ILI_BUS_TYPE_SPI) && defined(ILI_PLATFORM_SPI_READ)
+void ili_read_pixels(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t *buf)
+{
+	ili_dev_read_pixels(&g_ili_dev, x, y, w, h, buf);
+}
+
+void ili_copy_rect(uint16_t src_x, uint16_t src_y, uint16_t w, uint16_t h, uint16_t dst_x, uint16_t dst_y)
+{
+	ili_dev_copy_rect(&g_ili_dev, src_x, src_y, w, h, dst_x, dst_y);
+}
+
+void ili_screenshot(uint16_t *row_buf, ili_screenshot_cb_t cb, void *user_data)
+{
+	ili_dev_screenshot(&g_ili_dev, row_buf, cb, user_data);
 }
+#endif /* defined(ILI_BUS_TYPE_SPI) && defined(ILI_PLATFORM_SPI_READ) */
+#endif /* !defined(ILI_NO_DEFAULT_INSTANCE) */
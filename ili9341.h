@@ -1,7 +1,17 @@
 #ifndef _ILI9341_H_
 #define _ILI9341_H_
 
-#include "platform_mtb_psoc6_spi.h"
+#if defined(ILI_PLATFORM_HOST_SIM)
+    #include "platform_host_sim.h"
+#elif defined(ILI_PLATFORM_MTB_PSOC6_PARALLEL)
+    #include "platform_mtb_psoc6_parallel.h"
+#else
+    #include "platform_mtb_psoc6_spi.h"
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
 
 /* Mode: 0 (CPOL 0, CPHA 0 */
 #define SPI_CPOL        0
@@ -13,25 +23,62 @@
     #define ILI_SPI_FREQ 20000000UL    /* 20MHz */
 #endif
 
+/* SPI clock while reading from the panel (ILI_PLATFORM_SPI_READ). Its serial read cycle is 150ns at least */
+#ifndef ILI_SPI_READ_FREQ
+    #define ILI_SPI_READ_FREQ 6000000UL    /* 6MHz */
+#endif
+
+/* Normal mode frame rate ili_init() sets with init sequence 1, in Hz. See ili_set_frame_rate() */
+#ifndef ILI_FRAME_RATE_HZ
+    #define ILI_FRAME_RATE_HZ 100
+#endif
+
+/* Init sequence ili_init() runs, see ili_init_seq() */
+#ifndef ILI_INIT_SEQ
+    #define ILI_INIT_SEQ ili_init_seq_1
+#endif
+
+/*
+ * Wait after a reset before the init sequence, in ms. The panel takes commands 5ms after a reset,
+ * but sleep out only 120ms after it if it was reset out of sleep. When it was asleep (ili_sleep())
+ * or just powered up, 5 is enough
+ */
+#ifndef ILI_RESET_WAIT_MS
+    #define ILI_RESET_WAIT_MS 120
+#endif
+
+/* ili_flush_vsync() only waits for the tearing effect pulse when at least this many pixels are dirty */
+#ifndef ILI_VSYNC_MIN_PX
+    #define ILI_VSYNC_MIN_PX 4096
+#endif
+
 
 #if defined(ILI_BUS_TYPE_PARALLEL8) || defined(ILI_BUS_TYPE_SPI)
-    #define _ILI_DC_CMD()   ILI_PLATFORM_DC_LOW()
-    #define _ILI_DC_DATA()  ILI_PLATFORM_DC_HIGH()
+    #if defined(ILI_BUS_TYPE_SPI) && defined(ILI_PLATFORM_SPI_ASYNC)
+        // A DMA transfer may still be feeding the bus. DC must not change and nothing else
+        // may be written until it's done, so every bus access starts with this wait.
+        #define _ILI_WAIT_IDLE(bus)    ili_platform_spi_wait_idle(bus)
+    #else
+        #define _ILI_WAIT_IDLE(bus)    ((void)(bus))
+    #endif
+
+    #define _ILI_DC_CMD(bus)   {_ILI_WAIT_IDLE(bus); ILI_PLATFORM_DC_LOW(bus);}
+    #define _ILI_DC_DATA(bus)  {_ILI_WAIT_IDLE(bus); ILI_PLATFORM_DC_HIGH(bus);}
 
 
     #if defined(ILI_BUS_TYPE_PARALLEL8)
-		#define _ILI_WRITE8(byte)  ili_platform_parallel_send8(byte)
+		#define _ILI_WRITE8(bus, byte)  ili_platform_parallel_send8(bus, byte)
         #if defined(ILI_PLATFORM_WR_LOW) && defined(ILI_PLATFORM_WR_HIGH)
             // WR_STROBE is used to repeatedly and rapidly send the last byte. It's optional.
-            #define _ILI_PLATFORM_WR_STROBE()   {ILI_PLATFORM_WR_LOW(); ILI_PLATFORM_WR_HIGH();}
+            #define _ILI_PLATFORM_WR_STROBE(bus)   {ILI_PLATFORM_WR_LOW(bus); ILI_PLATFORM_WR_HIGH(bus);}
         #endif
 
         #if defined(ILI_PLATFORM_RD_LOW) && defined(ILI_PLATFORM_RD_HIGH)
             // RD_STROBE is not used by the driver yet. Maybe in future!!
-            #define _ILI_PLATFORM_RD_STROBE()   {ILI_PLATFORM_RD_LOW(); ILI_PLATFORM_RD_HIGH();}
+            #define _ILI_PLATFORM_RD_STROBE(bus)   {ILI_PLATFORM_RD_LOW(bus); ILI_PLATFORM_RD_HIGH(bus);}
         #endif
 	#elif defined(ILI_BUS_TYPE_SPI)
-		#define _ILI_WRITE8(byte)  ili_platform_spi_send8(byte)
+		#define _ILI_WRITE8(bus, byte)  ili_platform_spi_send8(bus, byte)
 	#endif
 
 
@@ -40,33 +87,350 @@
 #endif /* defined(ILI_BUS_TYPE_PARALLEL8) || defined(ILI_BUS_TYPE_SPI) */
 
 
-__attribute__((always_inline)) static inline void _ili_write_command_8bit(uint8_t cmd)
+__attribute__((always_inline)) static inline void _ili_write_command_8bit(ili_bus_t *bus, uint8_t cmd)
 {
-    _ILI_DC_CMD();
-    _ILI_WRITE8(cmd);
+    _ILI_DC_CMD(bus);
+    _ILI_WRITE8(bus, cmd);
 }
 
 /*
  * inline function to send 8 bit data to the display
  * User need not call it
  */
-__attribute__((always_inline)) static inline void _ili_write_data_8bit(uint8_t dat)
+__attribute__((always_inline)) static inline void _ili_write_data_8bit(ili_bus_t *bus, uint8_t dat)
+{
+    _ILI_DC_DATA(bus);
+    _ILI_WRITE8(bus, dat);
+}
+
+/*
+ * inline function to send a command followed by its `n` parameter bytes.
+ * On SPI, DC is toggled once and the parameters are streamed as a burst.
+ * User need not call it
+ */
+__attribute__((always_inline)) static inline void _ili_write_command_params(ili_bus_t *bus, uint8_t cmd, const uint8_t *params, uint32_t n)
 {
-    _ILI_DC_DATA();
-    _ILI_WRITE8(dat);
+#if defined(ILI_BUS_TYPE_SPI)
+    _ILI_WAIT_IDLE(bus);
+    ili_platform_spi_send_cmd(bus, cmd, params, n);
+#else
+    _ILI_DC_CMD(bus);
+    _ILI_WRITE8(bus, cmd);
+    _ILI_DC_DATA(bus);
+    for (uint32_t i = 0; i < n; i++)
+    {
+        _ILI_WRITE8(bus, params[i]);
+    }
+#endif
 }
 
 /*
  * inline function to send 16 bit data to the display
  * User need not call it
  */
-__attribute__((always_inline)) static inline void _ili_write_data_16bit(uint16_t dat)
+__attribute__((always_inline)) static inline void _ili_write_data_16bit(ili_bus_t *bus, uint16_t dat)
 {
-    _ILI_DC_DATA();
-    _ILI_WRITE8((uint8_t)(dat >> 8));
-    _ILI_WRITE8((uint8_t)dat);
+    _ILI_DC_DATA(bus);
+    _ILI_WRITE8(bus, (uint8_t)(dat >> 8));
+    _ILI_WRITE8(bus, (uint8_t)dat);
 }
 
+/*
+ * Completion callback of the non-blocking transfers.
+ * On target it's called from interrupt context, on the host simulator from a worker thread.
+ */
+typedef void (*ili_xfer_done_cb_t)(void *user_data);
+
+/*
+ * Strip render callback of ili_render_strips(). Fill `strip`, which holds the `h` rows of the
+ * display starting at row `y`, full display width, row by row.
+ */
+typedef void (*ili_strip_render_cb_t)(uint16_t *strip, uint16_t y, uint16_t h, void *user_data);
+
+/*
+ * Row callback of ili_screenshot(). `row` holds the `w` pixels of display row `y`, RGB565.
+ * It's only valid during the call
+ */
+typedef void (*ili_screenshot_cb_t)(const uint16_t *row, uint16_t y, uint16_t w, void *user_data);
+
+/* A point on the display, used by the multi-point primitives */
+typedef struct
+{
+    uint16_t x;
+    uint16_t y;
+} ili_point_t;
+
+/* Op types of a display list */
+#define ILI_DL_FILL     0
+#define ILI_DL_LINE     1
+#define ILI_DL_PIXEL    2
+#define ILI_DL_BITMAP   3
+#define ILI_DL_NONE     0xFF    /* Removed op */
+
+/*
+ * One recorded drawing call. Fills, pixels and bitmaps use (x0, y0)-(x1, y1) as their
+ * inclusive area, lines as their end points.
+ */
+typedef struct
+{
+    uint8_t type;
+    uint8_t width;          /* Line width */
+    uint16_t color;
+    uint16_t x0, y0;
+    uint16_t x1, y1;
+    uint16_t *bitmap;       /* Bitmap pixels, must stay valid as long as the list is replayed */
+} ili_dl_op_t;
+
+/* Display list. Storage is provided by the user */
+typedef struct
+{
+    ili_dl_op_t *ops;
+    uint16_t capacity;      /* Number of ops `ops` can hold */
+    uint16_t count;         /* Number of ops recorded */
+    uint8_t overflow;       /* Set when ops were dropped for lack of space */
+} ili_dl_t;
+
+/*
+ * One glyph of a bitmap font. Its pixels are `width` x `height` values of the font's `bpp`,
+ * row by row, packed MSB first with no padding between rows.
+ */
+typedef struct
+{
+    uint32_t bitmap_offset; /* First byte of the glyph in the font's bitmap */
+    uint8_t width;
+    uint8_t height;
+    uint8_t x_advance;      /* Cursor step to the next glyph */
+    int8_t x_offset;        /* Glyph's top-left corner from the cursor */
+    int8_t y_offset;        /* Glyph's top row from the top of the line */
+} ili_glyph_t;
+
+/* Bitmap font covering the characters `first` to `last`. tools/ili_fontconvert.py makes them */
+typedef struct
+{
+    const uint8_t *bitmap;
+    const ili_glyph_t *glyphs;  /* `last - first + 1` glyphs */
+    uint8_t first;
+    uint8_t last;
+    uint8_t y_advance;      /* Line height */
+    uint8_t bpp;            /* 1 (on/off) or 4 (16 level anti-aliased) */
+} ili_font_t;
+
+/* Scrolling text console, see ili_console_init() */
+typedef struct
+{
+    const ili_font_t *font;
+    uint16_t color;
+    uint16_t bg_color;
+    uint16_t top;           /* First display line of the console */
+    uint16_t rows;          /* Rows of text, 0 if the console could not be started */
+    uint32_t count;         /* Lines printed so far */
+} ili_console_t;
+
+/*
+ * Run-length encoded RGB565 image, tools/ili_imgconvert.py makes them. `data` is a sequence of
+ * packets. Each one starts with a header word: bit 15 set is a run of `(header & 0x7FFF) + 1`
+ * pixels of the color in the next word; bit 15 clear is a literal of `header + 1` pixels in
+ * the next words. Packets run across rows.
+ */
+typedef struct
+{
+    uint16_t width;
+    uint16_t height;
+    uint32_t length;        /* Number of words in `data` */
+    const uint16_t *data;
+} ili_image_rle_t;
+
+#define ILI_RLE_RUN         0x8000  /* Header bit of a run packet */
+
+/*
+ * Palette indexed image of 1, 2, 4 or 8 bits per pixel. Pixels are packed MSB first, each row
+ * starts on a new byte. tools/ili_imgconvert.py makes them
+ */
+typedef struct
+{
+    uint16_t width;
+    uint16_t height;
+    uint8_t bpp;
+    const uint8_t *data;
+    const uint16_t *palette;    /* `1 << bpp` RGB565 colors */
+} ili_image_indexed_t;
+
+/* Source formats of ili_convert_to_rgb565() and ili_draw_pixels_rgb888() */
+#define ILI_FMT_RGB888      0   /* 3 bytes per pixel: red, green, blue */
+#define ILI_FMT_BGR888      1   /* 3 bytes per pixel: blue, green, red */
+#define ILI_FMT_ARGB8888    2   /* 32-bit words 0xAARRGGBB, alpha is ignored */
+
+/* Flags of ili_convert_to_rgb565() and ili_draw_pixels_rgb888() */
+#define ILI_CONV_DITHER     0x01    /* 4x4 ordered (Bayer) dither instead of truncating */
+#define ILI_CONV_SWAP_RB    0x02    /* Swap red and blue, BGR565 result */
+#define ILI_CONV_BYTESWAP   0x04    /* High byte first in memory, see ili_byteswap_buffer() */
+
+/* ---------------------- Driver instance ---------------------- */
+/*
+ * Everything the driver keeps about one panel: geometry, the mirror of the panel's address window,
+ * the framebuffer, display list and text cache state, the scratch buffers, and the bus it sits on.
+ * The ili_* functions run on a default instance on the platform's default bus, the ili_dev_*
+ * variants on the instance they are given. Instances share nothing, so panels on separate buses
+ * can be driven from separate threads. Members are private, start an instance with ili_dev_setup().
+ * The buffers below make up most of an instance, about 5 KB with the defaults: define smaller
+ * sizes for the whole project to save RAM, and ILI_SHARED_SCRATCH to share the rasterizers'
+ * working memory between instances.
+ */
+
+/* Number of pixels in the temporary display buffer.
+ * The temporary buffer is used by `ili_fill_color()`, the indexed color blits and the read-back
+ */
+#ifndef ILI_TMP_DISP_BUF_PX_CNT
+    #define ILI_TMP_DISP_BUF_PX_CNT     256
+#endif
+/* Number of dirty rectangles a framebuffer keeps before merging them */
+#ifndef ILI_FB_MAX_DIRTY
+    #define ILI_FB_MAX_DIRTY            16
+#endif
+/* Pixels in the buffer a line of text is rendered into, when it is not cached. Lines taller than
+ * ILI_TEXT_BUF_PX_CNT / width are sent in bands, so it has to hold one row of the widest line */
+#ifndef ILI_TEXT_BUF_PX_CNT
+    #define ILI_TEXT_BUF_PX_CNT         2048
+#endif
+/* Number of lines the label cache holds */
+#ifndef ILI_TEXT_CACHE_SLOTS
+    #define ILI_TEXT_CACHE_SLOTS        8
+#endif
+/* Longest line the label cache holds, including the terminator */
+#ifndef ILI_TEXT_CACHE_STR_LEN
+    #define ILI_TEXT_CACHE_STR_LEN      24
+#endif
+/* Polygons with more points than this are not drawn */
+#ifndef ILI_POLY_MAX_POINTS
+    #define ILI_POLY_MAX_POINTS         32
+#endif
+
+#if ILI_TMP_DISP_BUF_PX_CNT < 2 || ILI_TEXT_BUF_PX_CNT < 320
+    #error "ILI_TMP_DISP_BUF_PX_CNT has to be 2 or more, ILI_TEXT_BUF_PX_CNT 320 or more"
+#endif
+#if ILI_TEXT_CACHE_SLOTS < 1 || ILI_TEXT_CACHE_SLOTS > 255 || ILI_POLY_MAX_POINTS < 3 || ILI_POLY_MAX_POINTS > 255
+    #error "ILI_TEXT_CACHE_SLOTS has to be 1 to 255, ILI_POLY_MAX_POINTS 3 to 255"
+#endif
+
+/*
+ * Define ILI_SHARED_SCRATCH to keep one working memory of the text, polygon and thick line
+ * rasterizers for all instances instead of one each. Saves ILI_TEXT_BUF_PX_CNT * 2 bytes per
+ * instance, but text, polygons and thick lines can then only be drawn from one thread at a time
+ */
+/* Number of thick line pieces buffered before they are drawn. Longer polylines are drawn in
+ * chunks, the joins at chunk boundaries may send a few pixels twice */
+#define _ILI_THICK_MAX_PIECES       32
+
+typedef struct
+{
+    uint16_t x0, y0, x1, y1;    /* Inclusive */
+} _ili_rect_t;
+
+typedef struct
+{
+    const ili_font_t *font;
+    uint16_t color, bg_color;
+    uint16_t w, h;              /* Visible size of the rendered line */
+    uint32_t last_used;         /* 0: slot is empty */
+    char str[ILI_TEXT_CACHE_STR_LEN];
+} _ili_text_slot_t;
+
+typedef struct
+{
+    int64_t x;                  /* 16.16 x at the current row, the whole uint16_t range */
+    int64_t dxdy;               /* 16.16 x step per row */
+    int32_t x_min;              /* 16.16 x range of the whole edge, within the guard band */
+    int32_t x_max;
+    int32_t y_top;              /* First and last row, inclusive */
+    int32_t y_bot;
+} _ili_poly_edge_t;
+
+typedef struct
+{
+    float x[4];                 /* Polygon vertices. For a disc x[0], y[0] is the center and x[1] the radius */
+    float y[4];
+    uint8_t n;                  /* 3 or 4 vertices, 0 for a disc */
+    int16_t row_min;            /* Rows touched by the piece */
+    int16_t row_max;
+} _ili_piece_t;
+
+/* Working memory of the text, polygon and thick line rasterizers. They never run nested */
+typedef union
+{
+    uint16_t text_buf[ILI_TEXT_BUF_PX_CNT];
+    struct
+    {
+        _ili_poly_edge_t edges[ILI_POLY_MAX_POINTS];
+        _ili_rect_t horiz[ILI_POLY_MAX_POINTS];     /* Horizontal edges, they only add their own span */
+        uint8_t active[ILI_POLY_MAX_POINTS];
+        int32_t xs[ILI_POLY_MAX_POINTS];            /* Crossing at the row center, sort key */
+        int32_t xs_lo[ILI_POLY_MAX_POINTS];         /* x range the edge covers within the row */
+        int32_t xs_hi[ILI_POLY_MAX_POINTS];
+        int16_t span_start[ILI_POLY_MAX_POINTS];
+        int16_t span_end[ILI_POLY_MAX_POINTS];
+    } poly;
+    struct
+    {
+        _ili_piece_t pieces[_ILI_THICK_MAX_PIECES];
+        uint8_t piece_cnt;
+        int16_t span_start[_ILI_THICK_MAX_PIECES];
+        int16_t span_end[_ILI_THICK_MAX_PIECES];
+    } thick;
+} _ili_scratch_t;
+
+typedef struct
+{
+    ili_bus_t *bus;             /* Bus the panel sits on, see the platform header */
+
+    uint16_t width;             /* Display size in the current rotation */
+    uint16_t height;
+    uint8_t rotation;
+
+    /* Hardware scroll area, in frame memory lines, see ili_scroll_define() */
+    uint16_t scroll_tfa;
+    uint16_t scroll_vsa;
+    uint16_t scroll_top;        /* Same area, in display lines */
+    uint8_t scroll_on;
+
+    /*
+     * Mirror of the panel's address window (CASET/PASET) and GRAM write pointer.
+     * Lets ili_set_address_window() skip what the panel already has.
+     * The write pointer is only valid while the RAMWR stream is open, i.e. no other
+     * command was sent since the last pixel.
+     */
+    uint16_t win_sc, win_ec;    /* Column start/end */
+    uint16_t win_sp, win_ep;    /* Page start/end */
+    uint8_t win_valid;
+    uint16_t wp_col, wp_page;   /* Where the next pixel goes */
+    uint8_t wp_valid;
+
+    uint8_t te_on;              /* Tearing effect output enabled, see ili_te_enable() */
+
+    /* Framebuffer, see ili_fb_attach() */
+    uint16_t *fb_buf;
+    uint16_t fb_x, fb_y, fb_w, fb_h;        /* Area of the display covered by the framebuffer */
+    uint16_t fb_sc, fb_ec, fb_sp, fb_ep;    /* Address window, display coordinates */
+    uint16_t fb_col, fb_page;               /* Write pointer, display coordinates */
+    _ili_rect_t fb_dirty[ILI_FB_MAX_DIRTY];
+    uint8_t fb_dirty_cnt;
+
+    ili_dl_t *dl_rec;           /* Display list being recorded, see ili_dl_begin() */
+
+    /* Label cache, see ili_text_cache_attach() */
+    uint16_t *text_pool;
+    uint32_t text_slot_px;
+    uint32_t text_clock;
+    _ili_text_slot_t text_slots[ILI_TEXT_CACHE_SLOTS];
+
+    /* Used by `ili_fill_color()`, `ili_draw_image_indexed()` and `ili_copy_rect()` */
+    uint16_t tmp_disp_buffer[ILI_TMP_DISP_BUF_PX_CNT];
+
+#if !defined(ILI_SHARED_SCRATCH)
+    _ili_scratch_t scratch;     /* See ILI_SHARED_SCRATCH */
+#endif
+} ili_dev_t;
+
+
 /*
 * function prototypes
 */
@@ -82,13 +446,55 @@ void ili_bus_init(void);
 void ili_bus_deinit(void);
 
 /**
- * Initialize the display driver.  Can be called only if ili_bus_init() is called
+ * Initialize the display driver.  Can be called only if ili_bus_init() is called.
+ * Resets the panel, runs the init sequence ILI_INIT_SEQ and turns the display on
  */
 void ili_init(void);
 
+/*
+ * Init sequences for ili_init_seq(): entries of a command, the number of its parameters, the
+ * parameters, and a wait in ms after them if ILI_SEQ_WAIT is set in the number.
+ * ILI_SEQ_END ends the sequence.
+ *     ILI_PIXFMT, 1, 0x55,
+ *     ILI_SLPOUT, ILI_SEQ_WAIT | 0, 5,
+ *     ILI_SEQ_END
+ */
+#define ILI_SEQ_WAIT    0x80
+#define ILI_SEQ_END     ILI_NOP
+
+/* Default power, VCOM and gamma settings, ILI_FRAME_RATE_HZ */
+extern const uint8_t ili_init_seq_1[];
+/* Another set of power, VCOM and gamma settings found on some modules, 73Hz */
+extern const uint8_t ili_init_seq_2[];
+
+/**
+ * Reset the panel and run the init sequence `seq`. The built-in ones end with sleep out and leave
+ * the display off: the first frame can be written while the panel's supplies settle, then shown
+ * whole with ili_display_on(). ili_init() is ili_init_seq(ILI_INIT_SEQ) then ili_display_on(1).
+ * Rotation and scroll area are back to rotation 0 (240x320) and none, as after the reset.
+ * @param seq Init sequence, see ILI_SEQ_WAIT
+ */
+void ili_init_seq(const uint8_t *seq);
+
+/**
+ * Turn the display on or off. Frame memory is kept and can be written while the display is off
+ * @param on 1 to show the frame memory, 0 to blank the display
+ */
+void ili_display_on(uint8_t on);
+
+/**
+ * Enter or leave sleep mode. Asleep the panel stops refreshing and its supplies are off, frame
+ * memory and registers are kept, so waking up needs no init. Takes 5ms each way, and leaving
+ * sleep has to be 120ms from entering it. A reset while asleep only needs ILI_RESET_WAIT_MS of 5.
+ * @param enable 1 to enter sleep mode, 0 to leave it
+ */
+void ili_sleep(uint8_t enable);
+
 /**
  * Set an area for drawing on the display with start row,col and end row,col.
  * User don't need to call it usually, call it only before some functions who don't call it by default.
+ * The driver remembers the panel's window and write pointer, and only sends the part that changed.
+ * If the next pixel would land on the window start anyway, nothing is sent at all.
  * @param x1 start column address.
  * @param y1 start row address.
  * @param x2 end column address.
@@ -112,8 +518,106 @@ void ili_fill_color(uint16_t color, uint32_t len);
  */
 void ili_draw_pixels_buffer(uint16_t *color_buffer, uint32_t len);
 
+/**
+ * Draw a `w`x`h` area of a larger bitmap whose rows are `stride` pixels apart.
+ * Call ili_set_address_window() with `w` and `h` before calling this function.
+ * @param color_buffer Pointer to the first pixel of the area
+ * @param w Width of the area
+ * @param h Height of the area
+ * @param stride Number of pixels between the starts of two rows of `color_buffer`
+ */
+void ili_draw_pixels_buffer_stride(uint16_t *color_buffer, uint16_t w, uint16_t h, uint32_t stride);
+
+/**
+ * Non-blocking version of ili_draw_pixels_buffer(). Returns as soon as the transfer is started.
+ * `color_buffer` must stay valid and unmodified until `cb` is called or ili_wait_idle() returns.
+ * Any other ili_* call waits for the transfer to finish before touching the bus.
+ * If the platform has no DMA support, the transfer is blocking and `cb` is called before returning.
+ * @param color_buffer Buffer of 16-bit RGB565 color values
+ * @param len 32-bit number of pixels
+ * @param cb Called when the last pixel is out on the bus. Can be NULL
+ * @param user_data Passed to `cb`
+ */
+void ili_draw_pixels_buffer_async(uint16_t *color_buffer, uint32_t len, ili_xfer_done_cb_t cb, void *user_data);
+
+/**
+ * Wait until the ongoing non-blocking transfer (if any) is finished
+ */
+void ili_wait_idle(void);
+
+/**
+ * Attach a RAM framebuffer covering the area (x, y, w, h) of the display.
+ * From now on all drawing goes into `buf` instead of the bus, and the touched areas are recorded
+ * as dirty rectangles. Drawing outside the area is discarded. Call ili_flush() to send the changes.
+ * The buffer is neither cleared nor read back from the display. Coordinates are of the current rotation.
+ * @param buf w*h pixels, row by row. Must stay valid until ili_fb_detach()
+ * @param x Start col address of the area
+ * @param y Start row address of the area
+ * @param w Width of the area
+ * @param h Height of the area
+ */
+void ili_fb_attach(uint16_t *buf, uint16_t x, uint16_t y, uint16_t w, uint16_t h);
+
+/**
+ * Flush the framebuffer and go back to drawing directly on the display
+ */
+void ili_fb_detach(void);
+
+/**
+ * Send the dirty rectangles of the framebuffer to the display, one address window each.
+ * Rectangles are merged first wherever one window is cheaper than two.
+ * Does nothing when no framebuffer is attached.
+ */
+void ili_flush(void);
+
+/**
+ * Render the whole screen in strips of `strip_h` rows, alternating between two strip buffers.
+ * `render` fills strip k+1 while strip k is being sent, and the whole frame goes out under one
+ * address window. During `render` the strip is attached as framebuffer, so it can either write
+ * the pixels itself or use any ili_* drawing function (clipped to the strip).
+ * Returns when the last strip is sent. An attached framebuffer is flushed and detached first.
+ * @param buf0 First strip buffer, `strip_h` rows of the display width
+ * @param buf1 Second strip buffer, same size. If NULL, buf0 is reused and nothing overlaps
+ * @param strip_h Number of rows per strip
+ * @param render Called once per strip
+ * @param user_data Passed to `render`
+ */
+void ili_render_strips(uint16_t *buf0, uint16_t *buf1, uint16_t strip_h, ili_strip_render_cb_t render, void *user_data);
+
+/**
+ * Start recording into `dl`. Until ili_dl_end(), ili_fill_rect(), ili_fill_rect_fast(), ili_fill_screen(),
+ * ili_draw_line(), ili_draw_pixel(), ili_draw_bitmap() and everything drawn with them (rectangles,
+ * polylines) are appended to `dl` instead of being drawn. Raw ili_set_address_window() writes are not recorded.
+ * Coordinates are of the current rotation. Recording appends to what `dl` already holds.
+ * @param dl Display list, set up with ops storage and capacity. `overflow` is set if it runs out
+ */
+void ili_dl_begin(ili_dl_t *dl);
+
+/**
+ * Stop recording
+ */
+void ili_dl_end(void);
+
+/**
+ * Optimize a recorded display list in place. The result draws the same picture with less traffic:
+ * - ops completely covered by a later fill or bitmap are removed
+ * - same color fills that together form a rectangle are merged (pixels count as 1x1 fills)
+ * - independent ops are reordered top to bottom, left to right, so consecutive windows share
+ *   rows and columns and the address window cache skips more CASET/PASET
+ * Work is quadratic in the number of ops, meant to be done once for static screens.
+ * @param dl Display list to optimize
+ */
+void ili_dl_optimize(ili_dl_t *dl);
+
+/**
+ * Draw all the ops of a display list
+ * @param dl Display list to draw
+ */
+void ili_dl_replay(const ili_dl_t *dl);
+
 /**
  * Draw a line from (x0,y0) to (x1,y1) with `width` and `color`.
+ * Thick diagonal lines have butt caps, see ili_draw_polyline_ex() for the band they cover.
  * @param x0 start column address.
  * @param y0 start row address.
  * @param x1 end column address.
@@ -123,6 +627,31 @@ void ili_draw_pixels_buffer(uint16_t *color_buffer, uint32_t len);
  */
 void ili_draw_line(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint8_t width, uint16_t color);
 
+/**
+ * Draw connected line segments through `count` points.
+ * Every vertex is drawn once, segments don't repeat the end point of the previous one.
+ * Thick polylines use miter joins and butt caps, see ili_draw_polyline_ex().
+ * @param points Array of points
+ * @param count Number of points
+ * @param width width or thickness of the line
+ * @param color 16-bit RGB565 color of the line
+ */
+void ili_draw_polyline(const ili_point_t *points, uint16_t count, uint8_t width, uint16_t color);
+
+/**
+ * Draw connected thick line segments through `count` points with selectable joins and caps.
+ * Every pixel is sent once. A line of `width` covers the band centered on
+ * (x + (width-1)/2, y + (width-1)/2), the same band as `width`x`width` squares with their top-left
+ * corner on the line would. Width 1 is the plain Bresenham polyline, joins and caps don't apply.
+ * @param points Array of points
+ * @param count Number of points
+ * @param width width or thickness of the line
+ * @param color 16-bit RGB565 color of the line
+ * @param join ILI_LINE_JOIN_MITER, ILI_LINE_JOIN_BEVEL or ILI_LINE_JOIN_ROUND
+ * @param cap ILI_LINE_CAP_BUTT or ILI_LINE_CAP_ROUND
+ */
+void ili_draw_polyline_ex(const ili_point_t *points, uint16_t count, uint8_t width, uint16_t color, uint8_t join, uint8_t cap);
+
 /**
  * Experimental
  * Draw a rectangle without filling it
@@ -133,6 +662,149 @@ void ili_draw_line(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint8_t w
  */
 void ili_draw_rectangle(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color);
 
+/**
+ * Draw a filled ellipse
+ * @param x0 Center col address
+ * @param y0 Center row address
+ * @param rx Horizontal radius
+ * @param ry Vertical radius
+ * @param color 16-bit RGB565 color
+ */
+void ili_fill_ellipse(uint16_t x0, uint16_t y0, uint16_t rx, uint16_t ry, uint16_t color);
+
+/**
+ * Draw the 1 pixel outline of an ellipse
+ * @param x0 Center col address
+ * @param y0 Center row address
+ * @param rx Horizontal radius
+ * @param ry Vertical radius
+ * @param color 16-bit RGB565 color
+ */
+void ili_draw_ellipse(uint16_t x0, uint16_t y0, uint16_t rx, uint16_t ry, uint16_t color);
+
+/**
+ * Draw a filled circle
+ * @param x0 Center col address
+ * @param y0 Center row address
+ * @param r Radius
+ * @param color 16-bit RGB565 color
+ */
+void ili_fill_circle(uint16_t x0, uint16_t y0, uint16_t r, uint16_t color);
+
+/**
+ * Draw the 1 pixel outline of a circle
+ * @param x0 Center col address
+ * @param y0 Center row address
+ * @param r Radius
+ * @param color 16-bit RGB565 color
+ */
+void ili_draw_circle(uint16_t x0, uint16_t y0, uint16_t r, uint16_t color);
+
+/**
+ * Draw a filled arc: the part of the ring between `r_inner` and `r_outer` from `start_angle` to
+ * `end_angle`. With `r_inner` 0 it's a sector (pie slice).
+ * Angles are in degrees, 0 points right and angles grow clockwise. A sweep of 360 or more is a full ring.
+ * @param x0 Center col address
+ * @param y0 Center row address
+ * @param r_outer Outer radius
+ * @param r_inner Inner radius, the ring is `r_outer - r_inner` pixels thick
+ * @param start_angle Start angle
+ * @param end_angle End angle
+ * @param color 16-bit RGB565 color
+ */
+void ili_fill_arc(uint16_t x0, uint16_t y0, uint16_t r_outer, uint16_t r_inner, int16_t start_angle, int16_t end_angle, uint16_t color);
+
+/**
+ * Draw the 1 pixel outline of a circle from `start_angle` to `end_angle`.
+ * Angles are in degrees, 0 points right and angles grow clockwise. A sweep of 360 or more is a full circle.
+ * @param x0 Center col address
+ * @param y0 Center row address
+ * @param r Radius
+ * @param start_angle Start angle
+ * @param end_angle End angle
+ * @param color 16-bit RGB565 color
+ */
+void ili_draw_arc(uint16_t x0, uint16_t y0, uint16_t r, int16_t start_angle, int16_t end_angle, uint16_t color);
+
+/**
+ * Draw a filled rectangle with rounded corners
+ * @param x Start col address
+ * @param y Start row address
+ * @param w Width of rectangle
+ * @param h Height of rectangle
+ * @param r Corner radius, limited to fit the rectangle
+ * @param color 16-bit RGB565 color
+ */
+void ili_fill_round_rect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t r, uint16_t color);
+
+/**
+ * Draw the 1 pixel outline of a rectangle with rounded corners
+ * @param x Start col address
+ * @param y Start row address
+ * @param w Width of rectangle
+ * @param h Height of rectangle
+ * @param r Corner radius, limited to fit the rectangle
+ * @param color 16-bit RGB565 color
+ */
+void ili_draw_round_rect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t r, uint16_t color);
+
+/**
+ * Draw a filled polygon through `count` points (even-odd rule, may be concave or self-intersecting).
+ * The edges and vertices are part of the polygon. At most ILI_POLY_MAX_POINTS points.
+ * @param points Array of points
+ * @param count Number of points
+ * @param color 16-bit RGB565 color
+ */
+void ili_fill_polygon(const ili_point_t *points, uint16_t count, uint16_t color);
+
+/**
+ * Draw a filled triangle. The edges and vertices are part of the triangle.
+ * @param x0 First vertex col address
+ * @param y0 First vertex row address
+ * @param x1 Second vertex col address
+ * @param y1 Second vertex row address
+ * @param x2 Third vertex col address
+ * @param y2 Third vertex row address
+ * @param color 16-bit RGB565 color
+ */
+void ili_fill_triangle(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint16_t color);
+
+/**
+ * Draw a string with its top-left corner at (x, y). Each line (up to a '\n') is drawn as one
+ * solid `bg_color` box, font->y_advance high, with the glyphs blended on it, sent through one
+ * address window. Characters the font does not have are skipped. Parts outside the display are skipped.
+ * Text is drawn right away, even while a display list is recorded.
+ * @param x Start col address
+ * @param y Start row address
+ * @param str Null terminated string
+ * @param font Font to draw with
+ * @param color 16-bit RGB565 text color
+ * @param bg_color 16-bit RGB565 background color
+ */
+void ili_draw_string(uint16_t x, uint16_t y, const char *str, const ili_font_t *font, uint16_t color, uint16_t bg_color);
+
+/**
+ * Width in pixels of the first line of `str`, as drawn by ili_draw_string()
+ * @param str Null terminated string
+ * @param font Font to measure with
+ */
+uint16_t ili_text_width(const char *str, const ili_font_t *font);
+
+/**
+ * Give ili_draw_string() a pool to cache rendered lines in. The pool is split in
+ * ILI_TEXT_CACHE_SLOTS equal slots, the least recently used one is replaced. Lines that are
+ * longer than ILI_TEXT_CACHE_STR_LEN - 1 characters or do not fit a slot are not cached.
+ * Redrawing a cached line (same text, font, colors and visible size) only sends its pixels.
+ * @param pool RGB565 pixels, must stay valid until ili_text_cache_detach(). NULL disables the cache
+ * @param pool_px Number of pixels in `pool`
+ */
+void ili_text_cache_attach(uint16_t *pool, uint32_t pool_px);
+
+/**
+ * Stop caching rendered lines and forget the cached ones
+ */
+void ili_text_cache_detach(void);
+
 /**
  * Rotate the display clockwise or anti-clockwie set by `rotation`
  * @param rotation Type of rotation. Supported values 0, 1, 2, 3
@@ -147,6 +819,165 @@ void ili_rotate_display(uint8_t rotation);
  */
 void ili_get_display_size(uint16_t *width, uint16_t *height, uint8_t *rotation);
 
+/**
+ * Split the display, along the direction the panel scrolls, into a fixed area, a scrolling area
+ * and another fixed area. That's top to bottom in rotations 0 and 2, left to right in 1 and 3.
+ * The three must add up to 320 lines. Nothing moves until ili_scroll_to() is called.
+ * @param top Lines of the first fixed area
+ * @param area Lines of the scrolling area
+ * @param bottom Lines of the last fixed area
+ */
+void ili_scroll_define(uint16_t top, uint16_t area, uint16_t bottom);
+
+/**
+ * Scroll the area set by ili_scroll_define() so that `line` is shown at its start. The lines
+ * before it wrap around to the end of the area. Drawing is not affected, it still goes to
+ * where the display showed it before scrolling.
+ * @param line Line of the scrolling area, from `top` to `top + area - 1`
+ */
+void ili_scroll_to(uint16_t line);
+
+/**
+ * Stop scrolling, the display shows the frame memory as it is again
+ */
+void ili_scroll_stop(void);
+
+/**
+ * Start a scrolling text console on the display lines `top` to `319 - bottom`.
+ * Needs rotation 0 or 2, the panel can't scroll lines of text in the other rotations.
+ * The console area is cleared with `bg_color`.
+ * @param con Console state, kept by the user
+ * @param font Font of the text
+ * @param top Lines above the console that stay fixed
+ * @param bottom Lines below the console that stay fixed. Lines that don't make a whole text row are added to it
+ * @param color 16-bit RGB565 text color
+ * @param bg_color 16-bit RGB565 background color
+ */
+void ili_console_init(ili_console_t *con, const ili_font_t *font, uint16_t top, uint16_t bottom, uint16_t color, uint16_t bg_color);
+
+/**
+ * Print a line at the bottom of the console, the older lines move up. Once the console is full,
+ * the line is drawn over the oldest one, which the scroll brings to the bottom, so only
+ * one row of text is sent per line. Each '\n' in `str` starts a new line.
+ * @param con Console started by ili_console_init()
+ * @param str Null terminated string
+ */
+void ili_console_print(ili_console_t *con, const char *str);
+
+/**
+ * Only refresh the display lines `start` to `end` (partial mode), the rest of the panel is not
+ * driven and shows the non-display color. Lines run along the panel's 320 pixel side, like
+ * the scroll area: display rows in rotations 0 and 2, display columns in 1 and 3.
+ * Leaves scrolling. The partial mode frame rate is set by ili_set_low_power_frame_rate().
+ * @param start First line of the partial area
+ * @param end Last line of the partial area
+ */
+void ili_partial_area(uint16_t start, uint16_t end);
+
+/**
+ * Leave partial mode (and scrolling), the whole display is refreshed again
+ */
+void ili_partial_off(void);
+
+/**
+ * Enter or leave idle mode. In idle mode the panel shows 8 colors, only the most significant
+ * bit of red, green and blue, and runs at the frame rate set by ili_set_low_power_frame_rate().
+ * Frame memory keeps all the colors, they are back when idle mode is left.
+ * @param enable 1 to enter idle mode, 0 to leave it
+ */
+void ili_idle_mode(uint8_t enable);
+
+/**
+ * Set the frame rate of idle mode and partial mode (FRMCTR2 and FRMCTR3). A static screen
+ * doesn't need the normal mode rate, and every frame costs panel power.
+ * Reachable rates are about 8 to 118 Hz, the closest one is used.
+ * @param hz Frame rate in Hz
+ */
+void ili_set_low_power_frame_rate(uint16_t hz);
+
+/**
+ * Set the normal mode frame rate (FRMCTR1). ili_init() sets ILI_FRAME_RATE_HZ.
+ * A lower rate gives a write more time to stay ahead of the refresh, see ili_flush_vsync().
+ * Reachable rates are about 8 to 118 Hz, the closest one is used.
+ * @param hz Frame rate in Hz
+ */
+void ili_set_frame_rate(uint16_t hz);
+
+/**
+ * Turn on the tearing effect output of the panel (TE pin). It pulses once per frame, when the
+ * refresh reaches line `scanline`. Line 0 is the start of the vertical blanking, the first
+ * display line follows two lines later. Display lines run along the panel's 320 pixel side
+ * from the top of rotation 0, like the scroll area.
+ * @param scanline Line the pulse comes at
+ */
+void ili_te_enable(uint16_t scanline);
+
+/**
+ * Turn off the tearing effect output, ili_wait_te() doesn't wait anymore
+ */
+void ili_te_disable(void);
+
+#if defined(ILI_PLATFORM_TE)
+/**
+ * Wait for the transfer in progress, then for the next tearing effect pulse.
+ * Returns at once if the output is off. Needs the TE pin wired to the platform (ILI_PLATFORM_TE).
+ */
+void ili_wait_te(void);
+
+/**
+ * ili_flush(), synchronized to the refresh. When at least ILI_VSYNC_MIN_PX pixels are dirty the
+ * rectangles are sorted in scan order and sent from the next tearing effect pulse on, so the
+ * write pointer follows the refresh instead of crossing it. Smaller updates go out at once.
+ * In rotation 0, where rows are written in scan order, an update doesn't tear if it takes:
+ * - less than a frame period, from a pulse at line 0: it stays ahead of the refresh
+ * - less than two frame periods, from a pulse a few lines later (ili_te_enable(8)): it stays
+ *   behind the refresh. A full frame takes 30.7ms at 40MHz SPI, 60Hz is slow enough
+ * Rows skipped between two rectangles let the write jump ahead of a refresh it was following.
+ */
+void ili_flush_vsync(void);
+#endif /* defined(ILI_PLATFORM_TE) */
+
+#if defined(ILI_BUS_TYPE_SPI) && defined(ILI_PLATFORM_SPI_READ)
+/**
+ * Read a `w`x`h` area of the frame memory back into `buf`, row by row. The panel sends 18-bit
+ * RGB666 pixels at ILI_SPI_READ_FREQ, they are converted to RGB565, which gives back exactly
+ * the colors that were drawn. Parts outside the display are not read, `buf` keeps w*h layout.
+ * Reads the panel, not an attached framebuffer: call ili_flush() before if there's one.
+ * Frame memory is not affected by scrolling, partial or idle mode.
+ * @param x Start col address
+ * @param y Start row address
+ * @param w Width of the area
+ * @param h Height of the area
+ * @param buf w*h pixels
+ */
+void ili_read_pixels(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t *buf);
+
+/**
+ * Move the `w`x`h` area at (src_x, src_y) to (dst_x, dst_y) on the display, through the
+ * temporary display buffer, without a framebuffer. Source and destination may overlap.
+ * The area is clipped so that both fit on the display. The source keeps its content
+ * where the destination doesn't cover it. Reading takes longer than writing, see
+ * ili_read_pixels(): it pays off over content that is slow to render, not over plain fills.
+ * Copies are done right away, even while a display list is recorded.
+ * @param src_x Start col address of the source
+ * @param src_y Start row address of the source
+ * @param w Width of the area
+ * @param h Height of the area
+ * @param dst_x Start col address of the destination
+ * @param dst_y Start row address of the destination
+ */
+void ili_copy_rect(uint16_t src_x, uint16_t src_y, uint16_t w, uint16_t h, uint16_t dst_x, uint16_t dst_y);
+
+/**
+ * Read the whole display, row by row, and hand each row to `cb`, e.g. to write it to a file
+ * or a serial port. Only one row is held in RAM.
+ * @param row_buf Room for one display row (display width pixels)
+ * @param cb Called for every row, top to bottom
+ * @param user_data Passed to `cb`
+ */
+void ili_screenshot(uint16_t *row_buf, ili_screenshot_cb_t cb, void *user_data);
+#endif /* defined(ILI_BUS_TYPE_SPI) && defined(ILI_PLATFORM_SPI_READ) */
+
 /**
  * Fills a rectangular area with `color`.
  * Before filling, performs area bound checking
@@ -158,6 +989,143 @@ void ili_get_display_size(uint16_t *width, uint16_t *height, uint8_t *rotation);
  */
 void ili_fill_rect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color);
 
+/**
+ * Draw a `w`x`h` bitmap with its top-left corner at (x, y).
+ * Before drawing, performs area bound checking. Parts outside the display are skipped
+ * @param x Start col address
+ * @param y Start row address
+ * @param w Width of the bitmap
+ * @param h Height of the bitmap
+ * @param bitmap w*h RGB565 pixels, row by row
+ */
+void ili_draw_bitmap(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t *bitmap);
+
+/**
+ * Draw a run-length encoded image with its top-left corner at (x, y). The packets are streamed
+ * to the display as they are decoded: runs with ili_fill_color(), literals straight from `img`
+ * with ili_draw_pixels_buffer(). Parts outside the display are skipped.
+ * Images are drawn right away, even while a display list is recorded.
+ * @param x Start col address
+ * @param y Start row address
+ * @param img Image to draw
+ */
+void ili_draw_image_rle(uint16_t x, uint16_t y, const ili_image_rle_t *img);
+
+/**
+ * Draw a palette indexed image with its top-left corner at (x, y). The indexes are expanded
+ * through the palette into the temporary display buffer, and sent one buffer at a time.
+ * Parts outside the display are skipped.
+ * Images are drawn right away, even while a display list is recorded.
+ * @param x Start col address
+ * @param y Start row address
+ * @param img Image to draw
+ * @param palette `1 << img->bpp` RGB565 colors to draw with instead of img->palette, or NULL
+ */
+void ili_draw_image_indexed(uint16_t x, uint16_t y, const ili_image_indexed_t *img, const uint16_t *palette);
+
+/**
+ * Blend two RGB565 colors. This is the reference of all the blending functions, they give
+ * the same result pixel for pixel.
+ * @param fg Foreground color
+ * @param bg Background color
+ * @param alpha Opacity of `fg`, 0 (only `bg`) to 255 (only `fg`)
+ * @return Blended color
+ */
+uint16_t ili_blend_color(uint16_t fg, uint16_t bg, uint8_t alpha);
+
+/**
+ * Blend `color` with a constant `alpha` over a `w`x`h` area of a RAM buffer, e.g. a strip of
+ * ili_render_strips() or a framebuffer, before it's sent.
+ * @param buf First pixel of the area
+ * @param stride Number of pixels between the starts of two rows of `buf`
+ * @param w Width of the area
+ * @param h Height of the area
+ * @param color 16-bit RGB565 color
+ * @param alpha Opacity of `color`, 0 to 255
+ */
+void ili_blend_fill_buffer(uint16_t *buf, uint32_t stride, uint16_t w, uint16_t h, uint16_t color, uint8_t alpha);
+
+/**
+ * Blend a `w`x`h` bitmap with an alpha value per pixel over the same sized area of a RAM buffer,
+ * e.g. an anti-aliased icon over a strip of ili_render_strips().
+ * @param buf First pixel of the area
+ * @param stride Number of pixels between the starts of two rows of `buf`
+ * @param w Width of the bitmap
+ * @param h Height of the bitmap
+ * @param bitmap w*h RGB565 pixels, row by row
+ * @param alpha w*h opacities (0 to 255) of the bitmap pixels, row by row
+ */
+void ili_blend_bitmap_buffer(uint16_t *buf, uint32_t stride, uint16_t w, uint16_t h, const uint16_t *bitmap, const uint8_t *alpha);
+
+/**
+ * Fill a rectangular area with `color` seen through with `alpha` over a plain `bg_color`.
+ * Before filling, performs area bound checking
+ * @param x Start col address
+ * @param y Start row address
+ * @param w Width of rectangle
+ * @param h Height of rectangle
+ * @param color 16-bit RGB565 color
+ * @param alpha Opacity of `color`, 0 to 255
+ * @param bg_color 16-bit RGB565 color of the area below
+ */
+void ili_fill_rect_alpha(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color, uint8_t alpha, uint16_t bg_color);
+
+/**
+ * Draw a `w`x`h` bitmap with an alpha value per pixel over a plain `bg_color`, with its
+ * top-left corner at (x, y). Rows are blended into the temporary display buffer and sent
+ * one buffer at a time. Parts outside the display are skipped.
+ * Bitmaps with alpha are drawn right away, even while a display list is recorded.
+ * @param x Start col address
+ * @param y Start row address
+ * @param w Width of the bitmap
+ * @param h Height of the bitmap
+ * @param bitmap w*h RGB565 pixels, row by row
+ * @param alpha w*h opacities (0 to 255) of the bitmap pixels, row by row
+ * @param bg_color 16-bit RGB565 color below the bitmap
+ */
+void ili_draw_bitmap_alpha(uint16_t x, uint16_t y, uint16_t w, uint16_t h, const uint16_t *bitmap, const uint8_t *alpha, uint16_t bg_color);
+
+/**
+ * Convert `n` pixels of one row of a 24-bit image to RGB565. With ILI_CONV_DITHER the
+ * pixels get the ordered dither pattern of display position (x, y) onwards.
+ * @param dst `n` RGB565 pixels
+ * @param src `n` pixels in `format`
+ * @param n Number of pixels
+ * @param format ILI_FMT_RGB888, ILI_FMT_BGR888 or ILI_FMT_ARGB8888
+ * @param flags ILI_CONV_DITHER, ILI_CONV_SWAP_RB, ILI_CONV_BYTESWAP or 0
+ * @param x Display column of the first pixel, only used with ILI_CONV_DITHER
+ * @param y Display row of the pixels, only used with ILI_CONV_DITHER
+ */
+void ili_convert_to_rgb565(uint16_t *dst, const void *src, uint32_t n, uint8_t format, uint8_t flags, uint16_t x, uint16_t y);
+
+/**
+ * Swap the red and blue channels of RGB565 pixels, RGB565 to BGR565 and back
+ * @param buf Pixels to swap in place
+ * @param n Number of pixels
+ */
+void ili_swap_rb_buffer(uint16_t *buf, uint32_t n);
+
+/**
+ * Swap the two bytes of each pixel. For transfers that send the buffer byte by byte in memory
+ * order, e.g. DMA to an 8-bit bus on a little-endian MCU, or images stored high byte first.
+ * The driver's own functions send the high byte first already.
+ * @param buf Pixels to swap in place
+ * @param n Number of pixels
+ */
+void ili_byteswap_buffer(uint16_t *buf, uint32_t n);
+
+/**
+ * Draw 24-bit pixels, e.g. a camera frame or a decoded image, converted to RGB565 one
+ * temporary display buffer at a time, red and blue swapped when ILI_MAD_COLOR_ORDER is ILI_MAD_RGB.
+ * Call ili_set_address_window() before calling this function; with ILI_CONV_DITHER the
+ * pattern follows the position in the address window, so an image sent in pieces has no seams.
+ * @param src `len` pixels in `format`
+ * @param len Number of pixels
+ * @param format ILI_FMT_RGB888, ILI_FMT_BGR888 or ILI_FMT_ARGB8888
+ * @param flags ILI_CONV_DITHER or 0
+ */
+void ili_draw_pixels_rgb888(const void *src, uint32_t len, uint8_t format, uint8_t flags);
+
 /*
  * Same as `ili_fill_rect()` but does not do bound checking, so it's slightly faster
  */
@@ -177,30 +1145,124 @@ void ili_fill_screen(uint16_t color);
 void ili_draw_pixel(uint16_t x, uint16_t y, uint16_t color);
 
 
+/* -------------------- Multiple panels -------------------- */
+/**
+ * Start a driver instance for a panel on `bus`, with cleared state: 240x320, rotation 0.
+ * Then call ili_dev_bus_init() and ili_dev_init() on it, the same way as ili_bus_init() and ili_init()
+ * @param dev Instance, must stay valid as long as it is in use
+ * @param bus Bus of the panel, see the platform header. Not shared with another instance
+ */
+void ili_dev_setup(ili_dev_t *dev, ili_bus_t *bus);
+
+/**
+ * Instance the functions without a handle run on. It sits on the platform's default bus.
+ * Define ILI_NO_DEFAULT_INSTANCE when only ili_dev_* functions (or the C++ front-end) are used:
+ * the default instance and the functions without a handle are then left out
+ */
+ili_dev_t *ili_dev_default(void);
+
+/*
+ * Handle variants: ili_dev_xxx(dev, ...) is ili_xxx(...) on the instance `dev`.
+ * ili_blend_*(), ili_convert_to_rgb565(), ili_swap_rb_buffer(), ili_byteswap_buffer() and
+ * ili_text_width() don't touch a panel and have no variant.
+ */
+void ili_dev_bus_init(ili_dev_t *dev);
+void ili_dev_bus_deinit(ili_dev_t *dev);
+void ili_dev_init(ili_dev_t *dev);
+void ili_dev_init_seq(ili_dev_t *dev, const uint8_t *seq);
+void ili_dev_display_on(ili_dev_t *dev, uint8_t on);
+void ili_dev_sleep(ili_dev_t *dev, uint8_t enable);
+void ili_dev_set_address_window(ili_dev_t *dev, uint16_t x, uint16_t y, uint16_t w, uint16_t h);
+void ili_dev_draw_pixels_buffer(ili_dev_t *dev, uint16_t *color_buffer, uint32_t len);
+void ili_dev_draw_pixels_buffer_stride(ili_dev_t *dev, uint16_t *color_buffer, uint16_t w, uint16_t h, uint32_t stride);
+void ili_dev_draw_pixels_buffer_async(ili_dev_t *dev, uint16_t *color_buffer, uint32_t len, ili_xfer_done_cb_t cb, void *user_data);
+void ili_dev_wait_idle(ili_dev_t *dev);
+void ili_dev_fill_color(ili_dev_t *dev, uint16_t color, uint32_t len);
+void ili_dev_fb_attach(ili_dev_t *dev, uint16_t *buf, uint16_t x, uint16_t y, uint16_t w, uint16_t h);
+void ili_dev_fb_detach(ili_dev_t *dev);
+void ili_dev_flush(ili_dev_t *dev);
+void ili_dev_render_strips(ili_dev_t *dev, uint16_t *buf0, uint16_t *buf1, uint16_t strip_h, ili_strip_render_cb_t render, void *user_data);
+void ili_dev_dl_begin(ili_dev_t *dev, ili_dl_t *dl);
+void ili_dev_dl_end(ili_dev_t *dev);
+void ili_dev_dl_optimize(ili_dev_t *dev, ili_dl_t *dl);
+void ili_dev_dl_replay(ili_dev_t *dev, const ili_dl_t *dl);
+void ili_dev_fill_rect(ili_dev_t *dev, uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color);
+void ili_dev_draw_bitmap(ili_dev_t *dev, uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t *bitmap);
+void ili_dev_draw_image_rle(ili_dev_t *dev, uint16_t x, uint16_t y, const ili_image_rle_t *img);
+void ili_dev_draw_image_indexed(ili_dev_t *dev, uint16_t x, uint16_t y, const ili_image_indexed_t *img, const uint16_t *palette);
+void ili_dev_fill_rect_alpha(ili_dev_t *dev, uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color, uint8_t alpha, uint16_t bg_color);
+void ili_dev_draw_bitmap_alpha(ili_dev_t *dev, uint16_t x, uint16_t y, uint16_t w, uint16_t h, const uint16_t *bitmap, const uint8_t *alpha, uint16_t bg_color);
+void ili_dev_draw_pixels_rgb888(ili_dev_t *dev, const void *src, uint32_t len, uint8_t format, uint8_t flags);
+void ili_dev_fill_rect_fast(ili_dev_t *dev, uint16_t x1, uint16_t y1, uint16_t w, uint16_t h, uint16_t color);
+void ili_dev_fill_screen(ili_dev_t *dev, uint16_t color);
+void ili_dev_draw_rectangle(ili_dev_t *dev, uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color);
+void ili_dev_fill_ellipse(ili_dev_t *dev, uint16_t x0, uint16_t y0, uint16_t rx, uint16_t ry, uint16_t color);
+void ili_dev_draw_ellipse(ili_dev_t *dev, uint16_t x0, uint16_t y0, uint16_t rx, uint16_t ry, uint16_t color);
+void ili_dev_fill_circle(ili_dev_t *dev, uint16_t x0, uint16_t y0, uint16_t r, uint16_t color);
+void ili_dev_draw_circle(ili_dev_t *dev, uint16_t x0, uint16_t y0, uint16_t r, uint16_t color);
+void ili_dev_fill_arc(ili_dev_t *dev, uint16_t x0, uint16_t y0, uint16_t r_outer, uint16_t r_inner, int16_t start_angle, int16_t end_angle, uint16_t color);
+void ili_dev_draw_arc(ili_dev_t *dev, uint16_t x0, uint16_t y0, uint16_t r, int16_t start_angle, int16_t end_angle, uint16_t color);
+void ili_dev_fill_round_rect(ili_dev_t *dev, uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t r, uint16_t color);
+void ili_dev_draw_round_rect(ili_dev_t *dev, uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t r, uint16_t color);
+void ili_dev_fill_polygon(ili_dev_t *dev, const ili_point_t *points, uint16_t count, uint16_t color);
+void ili_dev_fill_triangle(ili_dev_t *dev, uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint16_t color);
+void ili_dev_draw_string(ili_dev_t *dev, uint16_t x, uint16_t y, const char *str, const ili_font_t *font, uint16_t color, uint16_t bg_color);
+void ili_dev_text_cache_attach(ili_dev_t *dev, uint16_t *pool, uint32_t pool_px);
+void ili_dev_text_cache_detach(ili_dev_t *dev);
+void ili_dev_draw_polyline_ex(ili_dev_t *dev, const ili_point_t *points, uint16_t count, uint8_t width, uint16_t color, uint8_t join, uint8_t cap);
+void ili_dev_draw_line(ili_dev_t *dev, uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint8_t width, uint16_t color);
+void ili_dev_draw_polyline(ili_dev_t *dev, const ili_point_t *points, uint16_t count, uint8_t width, uint16_t color);
+void ili_dev_draw_pixel(ili_dev_t *dev, uint16_t x, uint16_t y, uint16_t color);
+void ili_dev_rotate_display(ili_dev_t *dev, uint8_t rotation);
+uint8_t ili_dev_display_get_rotation(ili_dev_t *dev);
+void ili_dev_get_display_size(ili_dev_t *dev, uint16_t *width, uint16_t *height, uint8_t *rotation);
+void ili_dev_scroll_define(ili_dev_t *dev, uint16_t top, uint16_t area, uint16_t bottom);
+void ili_dev_scroll_to(ili_dev_t *dev, uint16_t line);
+void ili_dev_scroll_stop(ili_dev_t *dev);
+void ili_dev_partial_area(ili_dev_t *dev, uint16_t start, uint16_t end);
+void ili_dev_partial_off(ili_dev_t *dev);
+void ili_dev_idle_mode(ili_dev_t *dev, uint8_t enable);
+void ili_dev_set_low_power_frame_rate(ili_dev_t *dev, uint16_t hz);
+void ili_dev_set_frame_rate(ili_dev_t *dev, uint16_t hz);
+void ili_dev_te_enable(ili_dev_t *dev, uint16_t scanline);
+void ili_dev_te_disable(ili_dev_t *dev);
+#if defined(ILI_PLATFORM_TE)
+void ili_dev_wait_te(ili_dev_t *dev);
+void ili_dev_flush_vsync(ili_dev_t *dev);
+#endif /* defined(ILI_PLATFORM_TE) */
+void ili_dev_console_init(ili_dev_t *dev, ili_console_t *con, const ili_font_t *font, uint16_t top, uint16_t bottom, uint16_t color, uint16_t bg_color);
+void ili_dev_console_print(ili_dev_t *dev, ili_console_t *con, const char *str);
+#if defined(ILI_BUS_TYPE_SPI) && defined(ILI_PLATFORM_SPI_READ)
+void ili_dev_read_pixels(ili_dev_t *dev, uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t *buf);
+void ili_dev_copy_rect(ili_dev_t *dev, uint16_t src_x, uint16_t src_y, uint16_t w, uint16_t h, uint16_t dst_x, uint16_t dst_y);
+void ili_dev_screenshot(ili_dev_t *dev, uint16_t *row_buf, ili_screenshot_cb_t cb, void *user_data);
+#endif /* defined(ILI_BUS_TYPE_SPI) && defined(ILI_PLATFORM_SPI_READ) */
+
+
 /* --------------------- Private functions -------------------- */
 /*
  * Called by ili_draw_line().
  * User need not call it
  */
-void _ili_plot_line_low(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint8_t width, uint16_t color);
+void _ili_plot_line_low(ili_dev_t *dev, uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint8_t width, uint16_t color);
 
 /*
  * Called by ili_draw_line().
  * User need not call it
  */
-void _ili_plot_line_high(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint8_t width, uint16_t color);
+void _ili_plot_line_high(ili_dev_t *dev, uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint8_t width, uint16_t color);
 
 /*
  * Called by ili_draw_line().
  * User need not call it
  */
-void _ili_draw_fast_h_line(uint16_t x0, uint16_t y0, uint16_t x1, uint8_t width, uint16_t color);
+void _ili_draw_fast_h_line(ili_dev_t *dev, uint16_t x0, uint16_t y0, uint16_t x1, uint8_t width, uint16_t color);
 
 /*
  * Called by ili_draw_line().
  * User need not call it
  */
-void _ili_draw_fast_v_line(uint16_t x0, uint16_t y0, uint16_t y1, uint8_t width, uint16_t color);
+void _ili_draw_fast_v_line(ili_dev_t *dev, uint16_t x0, uint16_t y0, uint16_t y1, uint8_t width, uint16_t color);
 
 
 /* --------------------- ILI9341 registers -------------------- */
@@ -232,8 +1294,16 @@ void _ili_draw_fast_v_line(uint16_t x0, uint16_t y0, uint16_t y1, uint8_t width,
 #define ILI_RAMRD   0x2E
 
 #define ILI_PTLAR   0x30
+#define ILI_VSCRDEF 0x33
+#define ILI_TEOFF   0x34
+#define ILI_TEON    0x35
 #define ILI_MADCTL  0x36
+#define ILI_VSCRSADD 0x37
+#define ILI_IDMOFF  0x38
+#define ILI_IDMON   0x39
 #define ILI_PIXFMT  0x3A
+#define ILI_RAMRDC  0x3E	/* Read memory continue */
+#define ILI_STE     0x44	/* Set tear scanline */
 
 #define ILI_FRMCTR1 0xB1
 #define ILI_FRMCTR2 0xB2
@@ -282,7 +1352,109 @@ void _ili_draw_fast_v_line(uint16_t x0, uint16_t y0, uint16_t y1, uint8_t width,
 	((uint16_t)(G >> 2) << ILI_G_POS_BGR) | \
 	((uint16_t)(B >> 3) << ILI_B_POS_BGR))
 
+/* Joins and caps of ili_draw_polyline_ex() */
+#define ILI_LINE_JOIN_MITER     0
+#define ILI_LINE_JOIN_BEVEL     1
+#define ILI_LINE_JOIN_ROUND     2
+#define ILI_LINE_CAP_BUTT       0
+#define ILI_LINE_CAP_ROUND      1
+
 #define ILI_SWAP(a, b)		{uint16_t temp; temp = a; a = b; b = temp;}
 
+/*
+ * Address window mirror of an instance (win_* and wp_* in ili_dev_t), shared by ili9341.c
+ * and ili9341.hpp. User need not call them
+ */
+
+/*
+ * Forget the address window and write pointer.
+ * Must be called whenever a command other than CASET/PASET/RAMWR is sent.
+ */
+static inline void _ili_window_invalidate(ili_dev_t *dev)
+{
+    dev->win_valid = 0;
+    dev->wp_valid = 0;
+}
+
+/* Move the write pointer by `len` pixels, the same way the panel auto-increments and wraps */
+__attribute__((always_inline)) static inline void _ili_write_pointer_advance(ili_dev_t *dev, uint32_t len)
+{
+    if (!dev->wp_valid)
+        return;
+
+    if (len == 1)
+    {
+        if (dev->wp_col < dev->win_ec)
+        {
+            dev->wp_col++;
+            return;
+        }
+        dev->wp_col = dev->win_sc;
+        dev->wp_page = (dev->wp_page < dev->win_ep) ? dev->wp_page + 1 : dev->win_sp;
+        return;
+    }
+
+    uint32_t win_w = (uint32_t)(dev->win_ec - dev->win_sc) + 1;
+    uint32_t win_h = (uint32_t)(dev->win_ep - dev->win_sp) + 1;
+    uint32_t pos = (uint32_t)(dev->wp_page - dev->win_sp) * win_w + (dev->wp_col - dev->win_sc) + len;
+    pos %= win_w * win_h;
+    dev->wp_page = dev->win_sp + (uint16_t)(pos / win_w);
+    dev->wp_col = dev->win_sc + (uint16_t)(pos % win_w);
+}
+
+/* CASET, PASET or RAMWR, with the platform's inline write when it has one */
+__attribute__((always_inline)) static inline void _ili_write_window_command(ili_bus_t *bus, uint8_t cmd, const uint8_t *params, uint32_t n)
+{
+#if defined(ILI_PLATFORM_SPI_INLINE)
+    _ILI_WAIT_IDLE(bus);
+    ili_platform_spi_send_cmd_inline(bus, cmd, params, n);
+#else
+    _ili_write_command_params(bus, cmd, params, n);
+#endif
+}
+
+/* Send CASET and PASET, only the ones the panel doesn't have yet */
+__attribute__((always_inline)) static inline void _ili_send_window(ili_dev_t *dev, ili_bus_t *bus, uint16_t x, uint16_t y, uint16_t x2, uint16_t y2)
+{
+    if (!dev->win_valid || dev->win_sc != x || dev->win_ec != x2)
+    {
+        uint8_t params[4] = {(uint8_t)(x >> 8), (uint8_t)x, (uint8_t)(x2 >> 8), (uint8_t)x2};
+        _ili_write_window_command(bus, ILI_CASET, params, 4);
+        dev->win_sc = x;
+        dev->win_ec = x2;
+    }
+
+    if (!dev->win_valid || dev->win_sp != y || dev->win_ep != y2)
+    {
+        uint8_t params[4] = {(uint8_t)(y >> 8), (uint8_t)y, (uint8_t)(y2 >> 8), (uint8_t)y2};
+        _ili_write_window_command(bus, ILI_PASET, params, 4);
+        dev->win_sp = y;
+        dev->win_ep = y2;
+    }
+    dev->win_valid = 1;
+}
+
+/*
+ * Address window (x, y)-(x2, y2) on the panel, followed by RAMWR. `bus` is dev->bus, a
+ * constant when the caller knows it at compile time (ili9341.hpp)
+ */
+__attribute__((always_inline)) static inline void _ili_open_window(ili_dev_t *dev, ili_bus_t *bus, uint16_t x, uint16_t y, uint16_t x2, uint16_t y2)
+{
+    // Write continuation: auto-increment already points to (x, y), and walks the same columns
+    if (dev->wp_valid && dev->wp_col == x && dev->wp_page == y && dev->win_ec == x2 && dev->win_ep >= y2 &&
+        (y == y2 || dev->win_sc == x))
+        return;
+
+    _ili_send_window(dev, bus, x, y, x2, y2);
+    _ili_write_window_command(bus, ILI_RAMWR, NULL, 0);
+    dev->wp_col = x;
+    dev->wp_page = y;
+    dev->wp_valid = 1;
+}
+
 //------------------------------------------------------------------------
+#ifdef __cplusplus
+}
+#endif
+
 #endif /* _ILI9341_H_ */
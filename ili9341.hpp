@@ -0,0 +1,164 @@
+#ifndef _ILI9341_HPP_
+#define _ILI9341_HPP_
+
+/*
+ * C++ front-end of the driver, header only. The panel's bus and rotation are template parameters,
+ * so the display size is a constant: bound checks and clipping of constant arguments fold away,
+ * and drawing a pixel or a rectangle inlines down to the platform's command and data writes.
+ *
+ *     ili::Display<ili::PlatformBus<&ili_platform_default_bus>, 1> lcd;   // Landscape
+ *     lcd.begin();
+ *     lcd.fill_rect(10, 10, 50, 20, 0xF800);
+ *     ili_dev_draw_string(lcd.dev(), 10, 40, "Hi", &font, 0xFFFF, 0x0000);   // Everything else
+ *
+ * A Display is a driver instance (ili_dev_t) of its own. Its bus must not be used by another
+ * instance, a Display on ili_platform_default_bus replaces the ili_* functions without a handle.
+ * Don't rotate it through dev(), the rotation is fixed by the type.
+ */
+
+#include "ili9341.h"
+
+namespace ili
+{
+
+/*
+ * Bus policy: the ili_bus_t of the panel, bound at compile time. The platform under it is the one
+ * selected for the C driver (ILI_PLATFORM_xx). The bus address is a constant, no pointer is passed
+ * around. On the parallel bus the port stores and WR strobes are inlined, on the PSoC6 SPI bus
+ * (ILI_PLATFORM_SPI_INLINE) pixels and address window commands are single TX FIFO writes.
+ * Platforms without inline functions get their out of line send functions called.
+ * Another policy only has to provide the same three static functions; the address window is
+ * sent by the C driver's inline helpers (_ili_open_window()) on bus().
+ */
+template <ili_bus_t *B>
+struct PlatformBus
+{
+    static ili_bus_t *bus() { return B; }
+
+    /* A command and its parameters, see _ili_write_window_command() */
+    __attribute__((always_inline)) static inline void command(uint8_t cmd, const uint8_t *params, uint32_t n)
+    {
+        _ili_write_window_command(B, cmd, params, n);
+    }
+
+    /* One pixel, after RAMWR */
+    __attribute__((always_inline)) static inline void pixel(uint16_t color)
+    {
+#if defined(ILI_PLATFORM_SPI_INLINE)
+        _ILI_DC_DATA(B);
+        ili_platform_spi_send16(B, color);
+#elif defined(ILI_BUS_TYPE_SPI)
+        _ILI_DC_DATA(B);
+        ili_platform_spi_send_buffer16(B, &color, 1);
+#else
+        _ili_write_data_16bit(B, color);
+#endif
+    }
+};
+
+typedef PlatformBus<&ili_platform_default_bus> DefaultBus;
+
+
+/*
+ * A panel on `Bus`, in rotation `Rotation` (0 to 3, as ili_rotate_display()).
+ * The hot primitives are inline here, they keep the instance's address window mirror up to date
+ * so they mix freely with the ili_dev_* functions on dev(). While a framebuffer is attached or a
+ * display list is recorded they hand over to the C functions.
+ */
+template <class Bus = DefaultBus, uint8_t Rotation = 0>
+class Display
+{
+    static_assert(Rotation < 4, "Rotation is 0, 1, 2 or 3");
+
+public:
+    static constexpr uint16_t width = (Rotation & 1) ? 320 : 240;
+    static constexpr uint16_t height = (Rotation & 1) ? 240 : 320;
+    /* MADCTL of the rotation, same as ili_rotate_display() sends */
+    static constexpr uint8_t madctl = ((Rotation == 0) ? 0x40 : (Rotation == 1) ? 0x20 :
+            (Rotation == 2) ? 0x80 : 0xE0) | ILI_MAD_COLOR_ORDER;
+
+    Display()
+    {
+        ili_dev_setup(&m_dev, Bus::bus());
+    }
+
+    /* Initialize the bus and the panel, then set the rotation */
+    void begin()
+    {
+        ili_dev_bus_init(&m_dev);
+        ili_dev_init(&m_dev);
+        m_dev.width = width;
+        m_dev.height = height;
+        m_dev.rotation = Rotation;
+        _ili_window_invalidate(&m_dev);
+        uint8_t params = madctl;
+        Bus::command(ILI_MADCTL, &params, 1);
+    }
+
+    /* The instance, for the ili_dev_* functions */
+    ili_dev_t *dev() { return &m_dev; }
+
+    /* ili_set_address_window() */
+    inline void set_address_window(uint16_t x, uint16_t y, uint16_t w, uint16_t h)
+    {
+        if (m_dev.fb_buf)
+        {
+            ili_dev_set_address_window(&m_dev, x, y, w, h);
+            return;
+        }
+        _ili_open_window(&m_dev, Bus::bus(), x, y, x + w - 1, y + h - 1);
+    }
+
+    /* ili_draw_pixels_buffer() */
+    inline void draw_pixels(uint16_t *buf, uint32_t len)
+    {
+        ili_dev_draw_pixels_buffer(&m_dev, buf, len);
+    }
+
+    /* ili_draw_pixel() */
+    __attribute__((always_inline)) inline void draw_pixel(uint16_t x, uint16_t y, uint16_t color)
+    {
+        if (x >= width || y >= height)
+            return;
+        if (m_dev.fb_buf || m_dev.dl_rec)
+        {
+            ili_dev_draw_pixel(&m_dev, x, y, color);
+            return;
+        }
+
+        // Window runs to the right edge, so a pixel right after this one needs no re-addressing
+        _ili_open_window(&m_dev, Bus::bus(), x, y, width - 1, y);
+        Bus::pixel(color);
+        _ili_write_pointer_advance(&m_dev, 1);
+    }
+
+    /* ili_fill_rect() */
+    __attribute__((always_inline)) inline void fill_rect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color)
+    {
+        if (x >= width || y >= height || w == 0 || h == 0)
+            return;
+        if (x + w > width)
+            w = width - x;
+        if (y + h > height)
+            h = height - y;
+        if (m_dev.fb_buf || m_dev.dl_rec)
+        {
+            ili_dev_fill_rect(&m_dev, x, y, w, h, color);
+            return;
+        }
+
+        _ili_open_window(&m_dev, Bus::bus(), x, y, x + w - 1, y + h - 1);
+        ili_dev_fill_color(&m_dev, color, (uint32_t)w * h);
+    }
+
+    inline void draw_hline(uint16_t x, uint16_t y, uint16_t w, uint16_t color) { fill_rect(x, y, w, 1, color); }
+    inline void draw_vline(uint16_t x, uint16_t y, uint16_t h, uint16_t color) { fill_rect(x, y, 1, h, color); }
+    inline void fill_screen(uint16_t color) { fill_rect(0, 0, width, height, color); }
+
+private:
+    ili_dev_t m_dev;
+};
+
+} // namespace ili
+
+#endif /* _ILI9341_HPP_ */
@@ -0,0 +1,782 @@
+#include <ili9341.h>
+#include <stdio.h>
+#include <pthread.h>
+#include <time.h>
+
+/*
+ * In-memory model of an ILI9341 panel behind a 4-wire SPI bus, or the 8-bit parallel (8080) bus.
+ * Command bytes (DC low) and data bytes (DC high) are decoded the way the
+ * controller does it. CASET/PASET/RAMWR/MADCTL, frame memory read (RAMRD/RAMRDC),
+ * vertical scrolling (VSCRDEF/VSCRSADD), partial mode (PTLAR/PTLON, both left with NORON),
+ * idle mode (IDMON/IDMOFF), the normal mode frame rate (FRMCTR1) and the tearing effect output
+ * (TEON/TEOFF/STE) are modelled; everything else is only counted.
+ *
+ * The refresh runs on the panel's own clock, which only advances by the wire time of the bytes
+ * the panel receives or sends, and by waits for the tearing effect pulse. It doesn't see CPU time
+ * or ili_platform_delay(), so the refresh and tearing figures are exact for back to back transfers
+ * and don't depend on the host.
+ */
+
+/* MADCTL bits */
+#define _SIM_MAD_MY   0x80
+#define _SIM_MAD_MX   0x40
+#define _SIM_MAD_MV   0x20
+#define _SIM_MAD_BGR  0x08
+
+/*
+ * Refresh: frames of _SIM_FRAME_LINES lines, a line lasts (clocks per line * 2^division ratio)
+ * cycles of the internal oscillator. Line 0 starts the vertical blanking, GRAM line y is
+ * refreshed at line _SIM_VBP + y. Partial and idle mode frame rates are not modelled
+ */
+#define _SIM_OSC_HZ         615000ULL
+#define _SIM_FRAME_LINES    324
+#define _SIM_VBP            2
+
+/* Wire time of a byte, in ps */
+#if defined(ILI_BUS_TYPE_PARALLEL8)
+	#define _SIM_BYTE_PS        (ILI_SIM_WR_CYCLE_NS * 1000ULL)
+#else
+	#define _SIM_BYTE_PS        (8ULL * 1000000000000ULL / ILI_SPI_FREQ)
+#endif
+#define _SIM_READ_BYTE_PS   (8ULL * 1000000000000ULL / ILI_SPI_READ_FREQ)
+
+ili_bus_t ili_platform_default_bus = ILI_SIM_BUS_INIT;
+
+/* Sum of all delays, the panels only keep where their counters started */
+static uint64_t g_sim_delay_ms = 0;
+static pthread_mutex_t g_sim_delay_lock = PTHREAD_MUTEX_INITIALIZER;
+
+
+/* Register values after a hardware or software reset */
+static void _sim_reset_registers(ili_bus_t *bus)
+{
+	bus->cmd = ILI_NOP;
+	bus->param_idx = 0;
+	bus->madctl = 0;
+	bus->sc = 0;
+	bus->ec = ILI_SIM_GRAM_WIDTH - 1;
+	bus->sp = 0;
+	bus->ep = ILI_SIM_GRAM_HEIGHT - 1;
+	bus->col = 0;
+	bus->page = 0;
+	bus->tfa = 0;
+	bus->vsa = ILI_SIM_GRAM_HEIGHT;
+	bus->vsp = 0;
+	bus->scroll_on = 0;
+	bus->ptl_sr = 0;
+	bus->ptl_er = ILI_SIM_GRAM_HEIGHT - 1;
+	bus->partial_on = 0;
+	bus->idle_on = 0;
+	bus->frmctr1[0] = 0x00;
+	bus->frmctr1[1] = 0x1B;
+	bus->te_on = 0;
+	bus->te_line = 0;
+	bus->wr_open = 0;
+}
+
+/* Duration of a refresh line, in ps */
+static uint64_t _sim_line_ps(ili_bus_t *bus)
+{
+	uint64_t rtn = bus->frmctr1[1] & 0x1F;
+	rtn = (rtn < 16) ? 16 : rtn;
+	return (rtn << (bus->frmctr1[0] & 0x03)) * 1000000000000ULL / _SIM_OSC_HZ;
+}
+
+/*
+ * End of a RAMWR stream: count the refreshes that showed it half written. A refresh reads the
+ * GRAM lines in order, a line shows the stream's content if it was written before the refresh
+ * got there. A refresh with some lines of the stream new and others still old is torn.
+ * Lines are the unit, a line being written while it is refreshed counts as written.
+ */
+static void _sim_wr_stream_end(ili_bus_t *bus)
+{
+	uint64_t line_ps = _sim_line_ps(bus);
+	uint64_t frame_ps = line_ps * _SIM_FRAME_LINES;
+
+	bus->wr_open = 0;
+	for (uint64_t frame = bus->wr_start / frame_ps; frame * frame_ps <= bus->wr_end; frame++)
+	{
+		uint8_t seen_old = 0;
+		uint8_t seen_new = 0;
+		for (uint16_t y = bus->wr_row_min; y <= bus->wr_row_max; y++)
+		{
+			if (bus->row_stream[y] != bus->wr_stream)
+				continue;
+			if (bus->row_time[y] <= frame * frame_ps + (_SIM_VBP + y) * line_ps)
+				seen_new = 1;
+			else
+				seen_old = 1;
+		}
+		if (seen_old && seen_new)
+			bus->stats.torn_frames++;
+	}
+}
+
+/* GRAM index of the logical (column, page) position, mapped through MADCTL. -1 if it's outside */
+static int32_t _sim_gram_index(ili_bus_t *bus, uint16_t col, uint16_t page)
+{
+	uint16_t x = col;
+	uint16_t y = page;
+
+	if (bus->madctl & _SIM_MAD_MV)
+	{
+		x = page;
+		y = col;
+	}
+	if (x >= ILI_SIM_GRAM_WIDTH || y >= ILI_SIM_GRAM_HEIGHT)
+		return -1;
+	if (bus->madctl & _SIM_MAD_MX)
+		x = ILI_SIM_GRAM_WIDTH - 1 - x;
+	if (bus->madctl & _SIM_MAD_MY)
+		y = ILI_SIM_GRAM_HEIGHT - 1 - y;
+
+	return (int32_t)y * ILI_SIM_GRAM_WIDTH + x;
+}
+
+/* Store a pixel at the logical (column, page) position */
+static void _sim_store_pixel(ili_bus_t *bus, uint16_t col, uint16_t page, uint16_t color)
+{
+	int32_t idx = _sim_gram_index(bus, col, page);
+	if (idx < 0)
+		return;
+
+	bus->gram[idx] = color;
+	bus->stats.pixels_written++;
+
+	uint16_t y = (uint16_t)(idx / ILI_SIM_GRAM_WIDTH);
+	if (!bus->wr_open)
+	{
+		bus->wr_open = 1;
+		bus->wr_stream++;
+		bus->wr_start = bus->clock_ps;
+		bus->wr_row_min = y;
+		bus->wr_row_max = y;
+	}
+	bus->wr_row_min = (y < bus->wr_row_min) ? y : bus->wr_row_min;
+	bus->wr_row_max = (y > bus->wr_row_max) ? y : bus->wr_row_max;
+	bus->row_time[y] = bus->clock_ps;
+	bus->row_stream[y] = bus->wr_stream;
+	bus->wr_end = bus->clock_ps;
+}
+
+/* Column first, then page. Wraps back to the window start after the last pixel */
+static void _sim_advance_write_pointer(ili_bus_t *bus)
+{
+	if (bus->col < bus->ec)
+	{
+		bus->col++;
+		return;
+	}
+	bus->col = bus->sc;
+	bus->page = (bus->page < bus->ep) ? bus->page + 1 : bus->sp;
+}
+
+static void _sim_rx_command(ili_bus_t *bus, uint8_t cmd)
+{
+	bus->stats.cmd_count++;
+	bus->stats.cmd_hist[cmd]++;
+
+	if (bus->wr_open)
+		_sim_wr_stream_end(bus);
+
+	bus->cmd = cmd;
+	bus->param_idx = 0;
+
+	switch (cmd)
+	{
+		case ILI_SWRESET:
+			_sim_reset_registers(bus);
+			break;
+		case ILI_RAMWR:
+		case ILI_RAMRD:
+			bus->col = bus->sc;
+			bus->page = bus->sp;
+			break;
+		case ILI_NORON:
+			bus->scroll_on = 0;
+			bus->partial_on = 0;
+			break;
+		case ILI_PTLON:
+			bus->scroll_on = 0;
+			bus->partial_on = 1;
+			break;
+		case ILI_IDMON:
+		case ILI_IDMOFF:
+			bus->idle_on = (cmd == ILI_IDMON);
+			break;
+		case ILI_TEON:
+		case ILI_TEOFF:
+			bus->te_on = (cmd == ILI_TEON);
+			break;
+	}
+}
+
+static void _sim_rx_data(ili_bus_t *bus, uint8_t dat)
+{
+	bus->stats.data_bytes++;
+
+	switch (bus->cmd)
+	{
+		case ILI_CASET:
+		case ILI_PASET:
+			if (bus->param_idx >= 4)
+				break;
+			bus->params[bus->param_idx++] = dat;
+			if (bus->param_idx == 4)
+			{
+				uint16_t start = ((uint16_t)bus->params[0] << 8) | bus->params[1];
+				uint16_t end = ((uint16_t)bus->params[2] << 8) | bus->params[3];
+				if (bus->cmd == ILI_CASET)
+				{
+					bus->sc = start;
+					bus->ec = end;
+				}
+				else
+				{
+					bus->sp = start;
+					bus->ep = end;
+				}
+			}
+			break;
+
+		case ILI_MADCTL:
+			if (bus->param_idx++ == 0)
+				bus->madctl = dat;
+			break;
+
+		case ILI_VSCRDEF:
+			if (bus->param_idx >= 6)
+				break;
+			bus->params[bus->param_idx++] = dat;
+			if (bus->param_idx == 6)
+			{
+				bus->tfa = ((uint16_t)bus->params[0] << 8) | bus->params[1];
+				bus->vsa = ((uint16_t)bus->params[2] << 8) | bus->params[3];
+			}
+			break;
+
+		case ILI_PTLAR:
+			if (bus->param_idx >= 4)
+				break;
+			bus->params[bus->param_idx++] = dat;
+			if (bus->param_idx == 4)
+			{
+				bus->ptl_sr = ((uint16_t)bus->params[0] << 8) | bus->params[1];
+				bus->ptl_er = ((uint16_t)bus->params[2] << 8) | bus->params[3];
+			}
+			break;
+
+		case ILI_FRMCTR1:
+			if (bus->param_idx < 2)
+				bus->frmctr1[bus->param_idx] = dat;
+			bus->param_idx++;
+			break;
+
+		case ILI_STE:
+			if (bus->param_idx >= 2)
+				break;
+			bus->params[bus->param_idx++] = dat;
+			if (bus->param_idx == 2)
+				bus->te_line = (((uint16_t)bus->params[0] << 8) | bus->params[1]) % _SIM_FRAME_LINES;
+			break;
+
+		case ILI_VSCRSADD:
+			if (bus->param_idx >= 2)
+				break;
+			bus->params[bus->param_idx++] = dat;
+			if (bus->param_idx == 2)
+			{
+				bus->vsp = ((uint16_t)bus->params[0] << 8) | bus->params[1];
+				bus->scroll_on = 1;
+			}
+			break;
+
+		case ILI_RAMWR:
+			if ((bus->param_idx++ & 1) == 0)
+			{
+				bus->px_high = dat;
+				break;
+			}
+			_sim_store_pixel(bus, bus->col, bus->page, ((uint16_t)bus->px_high << 8) | dat);
+			_sim_advance_write_pointer(bus);
+			/* Window full, the pixels that follow overwrite it: that's the next stream */
+			if (bus->wr_open && bus->col == bus->sc && bus->page == bus->sp)
+				_sim_wr_stream_end(bus);
+			break;
+
+		default:
+			bus->param_idx++;
+			break;
+	}
+}
+
+/*
+ * Byte the panel drives on MISO. Frame memory reads start with a dummy byte, then each pixel is
+ * sent as red, green and blue bytes, 6 bits each in the upper bits. A 16-bit pixel is stored as
+ * 18 bits, red and blue get their most significant bit copied in as least significant one.
+ * Other read commands are not modelled and read as 0
+ */
+static uint8_t _sim_tx_byte(ili_bus_t *bus)
+{
+	if (bus->cs || !bus->rst)
+		return 0xFF;
+	bus->stats.read_bytes++;
+	bus->clock_ps += _SIM_READ_BYTE_PS;
+
+	uint32_t idx = bus->param_idx++;
+	if ((bus->cmd != ILI_RAMRD && bus->cmd != ILI_RAMRDC) || idx == 0)
+		return 0;
+
+	uint16_t px = bus->rd_px;
+	switch ((idx - 1) % 3)
+	{
+		case 0:
+		{
+			int32_t gram_idx = _sim_gram_index(bus, bus->col, bus->page);
+			px = bus->rd_px = (gram_idx < 0) ? 0 : bus->gram[gram_idx];
+			_sim_advance_write_pointer(bus);
+			uint8_t r5 = px >> 11;
+			return (uint8_t)(((r5 << 1) | (r5 >> 4)) << 2);
+		}
+		case 1:
+			return (uint8_t)(((px >> 5) & 0x3F) << 2);
+		default:
+		{
+			uint8_t b5 = px & 0x1F;
+			return (uint8_t)(((b5 << 1) | (b5 >> 4)) << 2);
+		}
+	}
+}
+
+/* Every byte that reaches the panel goes through here */
+static void _sim_rx_byte(ili_bus_t *bus, uint8_t byte)
+{
+	if (bus->cs || !bus->rst)
+		return;
+	bus->clock_ps += _SIM_BYTE_PS;
+	if (bus->dc)
+		_sim_rx_data(bus, byte);
+	else
+		_sim_rx_command(bus, byte);
+}
+
+/* Same rule as the PSoC6 platform: the SCB has to be reconfigured when the frame width changes */
+static void _sim_set_tx_width(ili_bus_t *bus, uint8_t width)
+{
+	if (bus->tx_width != width)
+	{
+		bus->tx_width = width;
+		bus->stats.width_switches++;
+	}
+}
+
+
+/*
+ * Non-blocking transfers are decoded by a worker thread, one per bus. The bus lock protects its panel
+ * model, so a bus access from the application while a transfer is in flight is
+ * serialized (and counted as an ordering violation) instead of corrupting the model.
+ */
+
+/* Called with the lock held by everything the application can do to the bus */
+static void _sim_check_order(ili_bus_t *bus)
+{
+	if (bus->async_busy)
+		bus->stats.order_violations++;
+}
+
+static void *_sim_worker(void *arg)
+{
+	ili_bus_t *bus = (ili_bus_t *)arg;
+	pthread_mutex_lock(&bus->lock);
+	while (1)
+	{
+		while (!bus->async_pending)
+			pthread_cond_wait(&bus->cond, &bus->lock);
+		bus->async_pending = 0;
+
+		/* Keep the transfer in flight for its wire time, so that out of order accesses get caught */
+		uint64_t wire_ns = (uint64_t)bus->async_len * 16ULL * 1000000000ULL / ILI_SPI_FREQ;
+		struct timespec ts = {(time_t)(wire_ns / 1000000000ULL), (long)(wire_ns % 1000000000ULL)};
+		pthread_mutex_unlock(&bus->lock);
+		nanosleep(&ts, NULL);
+		pthread_mutex_lock(&bus->lock);
+
+		for (uint32_t i = 0; i < bus->async_len; i++)
+		{
+			_sim_rx_byte(bus, (uint8_t)(bus->async_buf[i] >> 8));
+			_sim_rx_byte(bus, (uint8_t)bus->async_buf[i]);
+		}
+
+		/* Bus is free before the callback runs, same as on target */
+		void (*cb)(void *) = bus->async_cb;
+		void *cb_data = bus->async_cb_data;
+		bus->async_busy = 0;
+		pthread_cond_broadcast(&bus->cond);
+
+		if (cb)
+		{
+			pthread_mutex_unlock(&bus->lock);
+			cb(cb_data);
+			pthread_mutex_lock(&bus->lock);
+		}
+	}
+	return NULL;
+}
+
+
+void ili_sim_set_dc(ili_bus_t *bus, uint8_t level)
+{
+	level = !!level;
+	pthread_mutex_lock(&bus->lock);
+	_sim_check_order(bus);
+	if (bus->dc != level)
+	{
+		bus->dc = level;
+		bus->stats.dc_toggles++;
+	}
+	pthread_mutex_unlock(&bus->lock);
+}
+
+void ili_sim_set_cs(ili_bus_t *bus, uint8_t level)
+{
+	pthread_mutex_lock(&bus->lock);
+	_sim_check_order(bus);
+	bus->cs = !!level;
+	pthread_mutex_unlock(&bus->lock);
+}
+
+void ili_sim_set_rst(ili_bus_t *bus, uint8_t level)
+{
+	level = !!level;
+	/* Rising edge ends the hardware reset */
+	if (!bus->rst && level)
+		_sim_reset_registers(bus);
+	bus->rst = level;
+}
+
+void ili_sim_port_write(ili_bus_t *bus, uint8_t byte)
+{
+	bus->port = byte;
+	bus->stats.port_writes++;
+}
+
+void ili_sim_set_wr(ili_bus_t *bus, uint8_t level)
+{
+	level = !!level;
+	/* The panel latches whatever is on the data port at the rising edge */
+	if (!bus->wr && level)
+	{
+		_sim_rx_byte(bus, bus->port);
+		bus->stats.wr_strobes++;
+	}
+	bus->wr = level;
+}
+
+void ili_sim_bus_reset(ili_bus_t *bus)
+{
+	ili_platform_spi_wait_idle(bus);
+	memset(bus->gram, 0, sizeof(bus->gram));
+	bus->dc = 1;
+	bus->cs = 1;
+	bus->rst = 1;
+	bus->tx_width = 8;
+	bus->wr = 1;
+	_sim_reset_registers(bus);
+	ili_sim_bus_reset_stats(bus);
+}
+
+void ili_sim_bus_reset_stats(ili_bus_t *bus)
+{
+	memset(&bus->stats, 0, sizeof(bus->stats));
+	bus->clock_base = bus->clock_ps;
+	pthread_mutex_lock(&g_sim_delay_lock);
+	bus->delay_base = g_sim_delay_ms;
+	pthread_mutex_unlock(&g_sim_delay_lock);
+}
+
+const ili_sim_stats_t *ili_sim_bus_get_stats(ili_bus_t *bus)
+{
+	pthread_mutex_lock(&bus->lock);
+	if (bus->wr_open)
+		_sim_wr_stream_end(bus);
+	bus->stats.clock_ns = (bus->clock_ps - bus->clock_base) / 1000ULL;
+	pthread_mutex_unlock(&bus->lock);
+	pthread_mutex_lock(&g_sim_delay_lock);
+	bus->stats.delay_ms = g_sim_delay_ms - bus->delay_base;
+	pthread_mutex_unlock(&g_sim_delay_lock);
+	return &bus->stats;
+}
+
+uint16_t ili_sim_bus_get_pixel(ili_bus_t *bus, uint16_t x, uint16_t y)
+{
+	if (x >= ILI_SIM_GRAM_WIDTH || y >= ILI_SIM_GRAM_HEIGHT)
+		return 0;
+	/* Lines outside the partial area are not driven, they show black */
+	if (bus->partial_on && (y < bus->ptl_sr || y > bus->ptl_er))
+		return 0;
+	/* Lines of the scroll area show GRAM from the scroll start on, wrapping around inside the area */
+	if (bus->scroll_on && y >= bus->tfa && y < bus->tfa + bus->vsa && bus->vsp >= bus->tfa)
+		y = bus->tfa + (y - bus->tfa + bus->vsp - bus->tfa) % bus->vsa;
+	uint16_t px = bus->gram[y * ILI_SIM_GRAM_WIDTH + (ILI_SIM_GRAM_WIDTH - 1 - x)];
+	/* Idle mode only shows the most significant bit of each color */
+	if (bus->idle_on)
+		px = ((px & 0x8000) ? 0xF800 : 0) | ((px & 0x0400) ? 0x07E0 : 0) | ((px & 0x0010) ? 0x001F : 0);
+	return px;
+}
+
+uint32_t ili_sim_bus_checksum(ili_bus_t *bus)
+{
+	uint32_t hash = 2166136261UL;
+	for (uint16_t y = 0; y < ILI_SIM_GRAM_HEIGHT; y++)
+	{
+		for (uint16_t x = 0; x < ILI_SIM_GRAM_WIDTH; x++)
+		{
+			uint16_t px = ili_sim_bus_get_pixel(bus, x, y);
+			hash = (hash ^ (uint8_t)(px >> 8)) * 16777619UL;
+			hash = (hash ^ (uint8_t)px) * 16777619UL;
+		}
+	}
+	return hash;
+}
+
+int ili_sim_bus_dump_ppm(ili_bus_t *bus, const char *path)
+{
+	FILE *fp = fopen(path, "wb");
+	if (fp == NULL)
+		return -1;
+
+	fprintf(fp, "P6\n%d %d\n255\n", ILI_SIM_GRAM_WIDTH, ILI_SIM_GRAM_HEIGHT);
+	for (uint16_t y = 0; y < ILI_SIM_GRAM_HEIGHT; y++)
+	{
+		for (uint16_t x = 0; x < ILI_SIM_GRAM_WIDTH; x++)
+		{
+			uint16_t px = ili_sim_bus_get_pixel(bus, x, y);
+			uint8_t r5 = (px >> 11) & 0x1F;
+			uint8_t g6 = (px >> 5) & 0x3F;
+			uint8_t b5 = px & 0x1F;
+			/* The glass is BGR. MADCTL BGR bit set means RGB565 data shows up as-is */
+			if (!(bus->madctl & _SIM_MAD_BGR))
+			{
+				uint8_t tmp = r5;
+				r5 = b5;
+				b5 = tmp;
+			}
+			uint8_t rgb[3] = {
+				(uint8_t)((r5 << 3) | (r5 >> 2)),
+				(uint8_t)((g6 << 2) | (g6 >> 4)),
+				(uint8_t)((b5 << 3) | (b5 >> 2))
+			};
+			fwrite(rgb, 1, sizeof(rgb), fp);
+		}
+	}
+	return (fclose(fp) == 0) ? 0 : -1;
+}
+
+void ili_sim_reset(void)
+{
+	ili_sim_bus_reset(&ili_platform_default_bus);
+}
+
+void ili_sim_reset_stats(void)
+{
+	ili_sim_bus_reset_stats(&ili_platform_default_bus);
+}
+
+const ili_sim_stats_t *ili_sim_get_stats(void)
+{
+	return ili_sim_bus_get_stats(&ili_platform_default_bus);
+}
+
+uint16_t ili_sim_get_pixel(uint16_t x, uint16_t y)
+{
+	return ili_sim_bus_get_pixel(&ili_platform_default_bus, x, y);
+}
+
+uint32_t ili_sim_checksum(void)
+{
+	return ili_sim_bus_checksum(&ili_platform_default_bus);
+}
+
+int ili_sim_dump_ppm(const char *path)
+{
+	return ili_sim_bus_dump_ppm(&ili_platform_default_bus, path);
+}
+
+
+void ili_platform_spi_init(ili_bus_t *bus, uint64_t spi_freq, uint8_t cpol, uint8_t cpha, uint8_t is_lsbfirst)
+{
+	/* Nothing to configure. The panel model only cares about the byte stream */
+	(void)spi_freq;
+	(void)cpol;
+	(void)cpha;
+	(void)is_lsbfirst;
+	bus->tx_width = 8;
+}
+
+void ili_platform_spi_deinit(ili_bus_t *bus)
+{
+	(void)bus;
+}
+
+void ili_platform_spi_send8(ili_bus_t *bus, uint8_t data)
+{
+	pthread_mutex_lock(&bus->lock);
+	_sim_check_order(bus);
+	_sim_set_tx_width(bus, 8);
+	_sim_rx_byte(bus, data);
+	bus->stats.tx_drains++;
+	pthread_mutex_unlock(&bus->lock);
+}
+
+void ili_platform_spi_send_buffer16(ili_bus_t *bus, uint16_t *buf, uint32_t items_count)
+{
+	pthread_mutex_lock(&bus->lock);
+	_sim_check_order(bus);
+	_sim_set_tx_width(bus, 16);
+	for (uint32_t i = 0; i < items_count; i++)
+	{
+		/* MSB first, same as the 16-bit SCB frames */
+		_sim_rx_byte(bus, (uint8_t)(buf[i] >> 8));
+		_sim_rx_byte(bus, (uint8_t)buf[i]);
+	}
+	bus->stats.tx_drains++;
+	pthread_mutex_unlock(&bus->lock);
+}
+
+/* Same policy as the PSoC6 platform, see ili_platform_spi_send_cmd() there */
+void ili_platform_spi_send_cmd(ili_bus_t *bus, uint8_t cmd, const uint8_t *params, uint32_t n)
+{
+	uint8_t is_16bit = (bus->tx_width == 16) && !(n & 1);
+
+	ILI_PLATFORM_DC_LOW(bus);
+	pthread_mutex_lock(&bus->lock);
+	_sim_check_order(bus);
+	if (is_16bit)
+		_sim_rx_byte(bus, ILI_NOP);
+	else
+		_sim_set_tx_width(bus, 8);
+	_sim_rx_byte(bus, cmd);
+	bus->stats.tx_drains++;
+	pthread_mutex_unlock(&bus->lock);
+
+	if (n == 0)
+		return;
+
+	ILI_PLATFORM_DC_HIGH(bus);
+	pthread_mutex_lock(&bus->lock);
+	for (uint32_t i = 0; i < n; i++)
+	{
+		_sim_rx_byte(bus, params[i]);
+	}
+	bus->stats.tx_drains++;
+	pthread_mutex_unlock(&bus->lock);
+}
+
+void ili_platform_spi_send_buffer16_async(ili_bus_t *bus, uint16_t *buf, uint32_t items_count, void (*done_cb)(void *user_data), void *user_data)
+{
+	ili_platform_spi_wait_idle(bus);
+	if (items_count == 0)
+	{
+		if (done_cb)
+			done_cb(user_data);
+		return;
+	}
+
+	pthread_mutex_lock(&bus->lock);
+	if (!bus->worker_started)
+	{
+		pthread_create(&bus->worker, NULL, _sim_worker, bus);
+		pthread_detach(bus->worker);
+		bus->worker_started = 1;
+	}
+	_sim_set_tx_width(bus, 16);
+	bus->stats.async_xfers++;
+
+	bus->async_buf = buf;
+	bus->async_len = items_count;
+	bus->async_cb = done_cb;
+	bus->async_cb_data = user_data;
+	bus->async_busy = 1;
+	bus->async_pending = 1;
+	pthread_cond_broadcast(&bus->cond);
+	pthread_mutex_unlock(&bus->lock);
+}
+
+/* Same sequence as the PSoC6 platform, see ili_platform_spi_read_cmd() there */
+void ili_platform_spi_read_cmd(ili_bus_t *bus, uint8_t cmd, uint8_t *buf, uint32_t n)
+{
+	ILI_PLATFORM_DC_LOW(bus);
+	pthread_mutex_lock(&bus->lock);
+	_sim_check_order(bus);
+	_sim_set_tx_width(bus, 8);
+	_sim_rx_byte(bus, cmd);
+	bus->stats.tx_drains++;
+	pthread_mutex_unlock(&bus->lock);
+
+	ILI_PLATFORM_DC_HIGH(bus);
+	pthread_mutex_lock(&bus->lock);
+	bus->stats.read_cmds++;
+	for (uint32_t i = 0; i < n; i++)
+	{
+		buf[i] = _sim_tx_byte(bus);
+	}
+	pthread_mutex_unlock(&bus->lock);
+
+	ILI_PLATFORM_CS_HIGH(bus);
+	ILI_PLATFORM_CS_LOW(bus);
+}
+
+void ili_platform_spi_wait_idle(ili_bus_t *bus)
+{
+	pthread_mutex_lock(&bus->lock);
+	while (bus->async_busy)
+		pthread_cond_wait(&bus->cond, &bus->lock);
+	pthread_mutex_unlock(&bus->lock);
+}
+
+#if defined(ILI_BUS_TYPE_PARALLEL8)
+void ili_platform_parallel_init(ili_bus_t *bus)
+{
+	bus->wr = 1;
+}
+
+void ili_platform_parallel_deinit(ili_bus_t *bus)
+{
+	(void)bus;
+}
+
+/* Same as the PSoC6 parallel platform: one store to the data port, then a WR strobe */
+void ili_platform_parallel_send8(ili_bus_t *bus, uint8_t byte)
+{
+	ili_sim_port_write(bus, byte);
+	ILI_PLATFORM_WR_LOW(bus);
+	ILI_PLATFORM_WR_HIGH(bus);
+}
+#endif /*ILI_BUS_TYPE_PARALLEL8*/
+
+void ili_platform_delay(uint64_t ms)
+{
+	pthread_mutex_lock(&g_sim_delay_lock);
+	g_sim_delay_ms += ms;
+	pthread_mutex_unlock(&g_sim_delay_lock);
+}
+
+/*
+ * The panel's clock jumps to the next tearing effect pulse. Without the output on there's no
+ * pulse, the hardware would wait forever; the simulator returns at once
+ */
+void ili_platform_te_wait(ili_bus_t *bus)
+{
+	pthread_mutex_lock(&bus->lock);
+	if (bus->te_on && bus->rst)
+	{
+		uint64_t line_ps = _sim_line_ps(bus);
+		uint64_t frame_ps = line_ps * _SIM_FRAME_LINES;
+		uint64_t pulse = (bus->clock_ps / frame_ps) * frame_ps + bus->te_line * line_ps;
+		if (pulse < bus->clock_ps)
+			pulse += frame_ps;
+		bus->clock_ps = pulse;
+		bus->stats.te_waits++;
+	}
+	pthread_mutex_unlock(&bus->lock);
+}
@@ -0,0 +1,239 @@
+// NOTE: Only to be included by ili9341.h. User should NOT include it
+// Host (Linux/macOS) simulator platform. Select it with `-DILI_PLATFORM_HOST_SIM`
+// The panel sits on SPI, or on the 8-bit parallel (8080) bus with `-DILI_SIM_BUS_PARALLEL8`
+
+#ifndef _PLATFORM_HOST_SIM_
+#define _PLATFORM_HOST_SIM_
+
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Size of the simulated panel's frame memory (GRAM), in native portrait orientation */
+#define ILI_SIM_GRAM_WIDTH   240
+#define ILI_SIM_GRAM_HEIGHT  320
+
+
+/* ====================================================== */
+/*      Mandatory Config Macros needed by ili9341.c/h     */
+/* ====================================================== */
+#if defined(ILI_SIM_BUS_PARALLEL8)
+	#define ILI_BUS_TYPE_PARALLEL8
+#else
+	#define ILI_BUS_TYPE_SPI
+#endif
+
+/* ============[ End: Mandatory Config Macros]=========== */
+
+
+/* ====================================================== */
+/*  Optional Config Macros (default values in ili9341.h)  */
+/* ====================================================== */
+/* Same as the PSoC6 SPI platform so that wire time estimations are comparable */
+#ifndef ILI_SPI_FREQ
+	#define ILI_SPI_FREQ    40000000UL    /* 40MHz */
+#endif
+#if defined(ILI_BUS_TYPE_SPI)
+	#define ILI_PLATFORM_SPI_ASYNC        /* Non-blocking transfers are completed by a worker thread after their wire time */
+	#define ILI_PLATFORM_SPI_READ         /* MISO is modelled, frame memory can be read back */
+#endif
+/* 8080 write cycle of the panel (twc), the shortest time a byte takes on the parallel bus */
+#define ILI_SIM_WR_CYCLE_NS   66
+/* Tearing effect pulses come from the refresh model, on the panel's own clock */
+#define ILI_PLATFORM_TE
+
+/* ============[ End: Optional Config Macros]============ */
+
+
+/* ====================================================== */
+/*        Mandatory Macros needed by ili9341.c/h          */
+/* ====================================================== */
+#define ILI_PLATFORM_DC_HIGH(bus)    {ili_sim_set_dc(bus, 1);}
+#define ILI_PLATFORM_DC_LOW(bus)     {ili_sim_set_dc(bus, 0);}
+/* ===============[ End: Mandatory Macros]=============== */
+
+
+/* ====================================================== */
+/*         Optional Macros needed by ili9341.c/h          */
+/* ====================================================== */
+#define ILI_PLATFORM_CS_HIGH(bus)    {ili_sim_set_cs(bus, 1);}
+#define ILI_PLATFORM_CS_LOW(bus)     {ili_sim_set_cs(bus, 0);}
+#define ILI_PLATFORM_RST_HIGH(bus)   {ili_sim_set_rst(bus, 1);}
+#define ILI_PLATFORM_RST_LOW(bus)    {ili_sim_set_rst(bus, 0);}
+#if defined(ILI_BUS_TYPE_PARALLEL8)
+	#define ILI_PLATFORM_WR_HIGH(bus)    {ili_sim_set_wr(bus, 1);}
+	#define ILI_PLATFORM_WR_LOW(bus)     {ili_sim_set_wr(bus, 0);}
+#endif
+/* ================[ End: Optional Macros]=============== */
+
+
+/*
+ * Bus traffic counters. Everything is counted as it would be seen on the wire
+ * of the PSoC6 SPI or parallel platform, so numbers are directly comparable between changes.
+ */
+typedef struct
+{
+	uint32_t cmd_count;         /* Number of command bytes (DC low) */
+	uint32_t data_bytes;        /* Number of parameter and pixel bytes (DC high) */
+	uint32_t pixels_written;    /* Number of pixels stored into GRAM by RAMWR */
+	uint32_t dc_toggles;        /* Number of DC pin level changes */
+	uint32_t width_switches;    /* Number of 8 <-> 16 bit SPI frame width reconfigurations */
+	uint32_t tx_drains;         /* Number of blocking waits for the TX FIFO to drain */
+	uint32_t async_xfers;       /* Number of non-blocking transfers */
+	uint32_t order_violations;  /* Bus accesses (DC/CS change, write) while a non-blocking transfer was in flight */
+	uint32_t read_cmds;         /* Number of read commands. Each one switches the SCB to read settings and back */
+	uint32_t read_bytes;        /* Number of bytes clocked in from the panel (MISO), at ILI_SPI_READ_FREQ */
+	uint32_t port_writes;       /* Parallel bus: number of stores to the data port */
+	uint32_t wr_strobes;        /* Parallel bus: number of WR rising edges, i.e. bytes latched by the panel */
+	uint32_t torn_frames;       /* Refreshes that showed a RAMWR stream half written: old content on some lines, new on others */
+	uint32_t te_waits;          /* Number of waits for a tearing effect pulse */
+	uint64_t clock_ns;          /* Panel clock: wire time of every byte received or sent, plus the tearing effect waits */
+	uint64_t delay_ms;          /* Sum of all ili_platform_delay() calls, whichever panel they were for. The simulator does not sleep */
+	uint32_t cmd_hist[256];     /* Number of times each command was sent */
+} ili_sim_stats_t;
+
+/*
+ * One simulated panel and the bus it sits on. Each bus has its own frame memory, counters and
+ * worker thread, so panels on separate buses run independently. Members are private.
+ * Define one with ILI_SIM_BUS_INIT and power it up with ili_sim_bus_reset() before use.
+ */
+typedef struct
+{
+	uint16_t gram[ILI_SIM_GRAM_WIDTH * ILI_SIM_GRAM_HEIGHT];
+	ili_sim_stats_t stats;
+	uint64_t delay_base;        /* Delay sum when the counters were reset */
+
+	uint8_t  dc, cs, rst;
+	uint8_t  tx_width;
+	uint8_t  port;              /* Parallel bus: data port output register */
+	uint8_t  wr;
+
+	uint8_t  cmd;
+	uint32_t param_idx;
+	uint8_t  params[6];
+
+	uint8_t  madctl;
+	uint16_t sc, ec;            /* Column start/end */
+	uint16_t sp, ep;            /* Page start/end */
+	uint16_t col, page;         /* Write pointer, also used by reads */
+	uint8_t  px_high;           /* First byte of a pixel, waiting for the second one */
+	uint16_t rd_px;             /* Pixel being read, sent one color byte at a time */
+	uint16_t tfa, vsa;          /* Vertical scroll top fixed and scroll area, in GRAM lines */
+	uint16_t vsp;               /* GRAM line shown first in the scroll area */
+	uint8_t  scroll_on;
+	uint16_t ptl_sr, ptl_er;    /* Partial area, in GRAM lines */
+	uint8_t  partial_on;
+	uint8_t  idle_on;
+
+	/* Refresh and tearing effect model, on the panel's clock. See platform_host_sim.c */
+	uint64_t clock_ps;
+	uint64_t clock_base;        /* Panel clock when the counters were reset */
+	uint8_t  frmctr1[2];        /* Normal mode division ratio and clocks per line */
+	uint8_t  te_on;
+	uint16_t te_line;           /* Line the tearing effect pulse comes at (STE) */
+	uint8_t  wr_open;           /* A RAMWR stream is being written, no command since its first pixel */
+	uint32_t wr_stream;         /* Number of the current or last RAMWR stream */
+	uint64_t wr_start, wr_end;  /* Panel clock at its first and last pixel */
+	uint16_t wr_row_min, wr_row_max;                /* GRAM lines it wrote */
+	uint64_t row_time[ILI_SIM_GRAM_HEIGHT];         /* Panel clock when each GRAM line was last written */
+	uint32_t row_stream[ILI_SIM_GRAM_HEIGHT];       /* and the stream that wrote it */
+
+	/* Non-blocking transfers, see platform_host_sim.c */
+	pthread_mutex_t lock;
+	pthread_cond_t  cond;
+	pthread_t worker;
+	uint8_t   worker_started;
+	uint8_t   async_pending;    /* Submitted, not picked up by the worker yet */
+	uint8_t   async_busy;       /* Submitted and not finished */
+	uint16_t *async_buf;
+	uint32_t  async_len;
+	void    (*async_cb)(void *user_data);
+	void     *async_cb_data;
+} ili_bus_t;
+
+/* Static initializer of an ili_bus_t: `ili_bus_t bus = ILI_SIM_BUS_INIT;` */
+#define ILI_SIM_BUS_INIT    {.dc = 1, .cs = 1, .rst = 1, .tx_width = 8, .wr = 1, \
+							 .lock = PTHREAD_MUTEX_INITIALIZER, .cond = PTHREAD_COND_INITIALIZER}
+
+/* Bus of the ili_* functions without a handle. The ili_sim_* functions without a bus look at it */
+extern ili_bus_t ili_platform_default_bus;
+
+
+/* ====================================================== */
+/*        Mandatory functions needed by ili9341.c/h       */
+/* ====================================================== */
+void ili_platform_spi_init(ili_bus_t *bus, uint64_t spi_freq, uint8_t cpol, uint8_t cpha, uint8_t is_lsbfirst);
+void ili_platform_spi_deinit(ili_bus_t *bus);
+void ili_platform_spi_send8(ili_bus_t *bus, uint8_t byte);
+void ili_platform_spi_send_buffer16(ili_bus_t *bus, uint16_t *buf, uint32_t items_count);
+void ili_platform_spi_send_cmd(ili_bus_t *bus, uint8_t cmd, const uint8_t *params, uint32_t n);
+void ili_platform_delay(uint64_t ms);
+/* Only needed when ILI_PLATFORM_SPI_ASYNC is defined */
+void ili_platform_spi_send_buffer16_async(ili_bus_t *bus, uint16_t *buf, uint32_t items_count, void (*done_cb)(void *user_data), void *user_data);
+void ili_platform_spi_wait_idle(ili_bus_t *bus);
+/* Only needed when ILI_PLATFORM_SPI_READ is defined */
+void ili_platform_spi_read_cmd(ili_bus_t *bus, uint8_t cmd, uint8_t *buf, uint32_t n);
+/* Only needed when ILI_PLATFORM_TE is defined */
+void ili_platform_te_wait(ili_bus_t *bus);
+#if defined(ILI_BUS_TYPE_PARALLEL8)
+	/* Only for the parallel bus */
+	void ili_platform_parallel_init(ili_bus_t *bus);
+	void ili_platform_parallel_deinit(ili_bus_t *bus);
+	void ili_platform_parallel_send8(ili_bus_t *bus, uint8_t byte);
+#endif
+/* ==============[ End: Mandatory functions]============= */
+
+
+/* ====================================================== */
+/*              Simulator-only functions                  */
+/* ====================================================== */
+
+/* DC, CS and RST pin levels. Called by the ILI_PLATFORM_xx() macros */
+void ili_sim_set_dc(ili_bus_t *bus, uint8_t level);
+void ili_sim_set_cs(ili_bus_t *bus, uint8_t level);
+void ili_sim_set_rst(ili_bus_t *bus, uint8_t level);
+
+/* Parallel bus: data port output register (D0..D7) and WR pin. Called by ili_platform_parallel_send8() and the WR macros */
+void ili_sim_port_write(ili_bus_t *bus, uint8_t byte);
+void ili_sim_set_wr(ili_bus_t *bus, uint8_t level);
+
+/* Power-on reset of the simulated panel. Clears GRAM, registers and counters. Waits for non-blocking transfers */
+void ili_sim_reset(void);
+
+/* Clears only the bus traffic counters */
+void ili_sim_reset_stats(void);
+
+/* Returns the bus traffic counters since the last reset */
+const ili_sim_stats_t *ili_sim_get_stats(void);
+
+/*
+ * Returns the RGB565 pixel visible on the glass at (x, y), 0 <= x < 240, 0 <= y < 320.
+ * The glass is mirrored in X relative to GRAM, like the common ILI9341 modules,
+ * so that rotation 0 (MADCTL MX=1) is upright. Vertical scrolling, partial mode and idle mode are applied.
+ */
+uint16_t ili_sim_get_pixel(uint16_t x, uint16_t y);
+
+/* FNV-1a hash of the whole glass. Handy to check that an optimization did not change the output */
+uint32_t ili_sim_checksum(void);
+
+/* Writes the glass as a binary PPM (P6) image. Returns 0 on success, -1 on failure */
+int ili_sim_dump_ppm(const char *path);
+
+/* Same as above, on the panel of `bus` instead of the default one */
+void ili_sim_bus_reset(ili_bus_t *bus);
+void ili_sim_bus_reset_stats(ili_bus_t *bus);
+const ili_sim_stats_t *ili_sim_bus_get_stats(ili_bus_t *bus);
+uint16_t ili_sim_bus_get_pixel(ili_bus_t *bus, uint16_t x, uint16_t y);
+uint32_t ili_sim_bus_checksum(ili_bus_t *bus);
+int ili_sim_bus_dump_ppm(ili_bus_t *bus, const char *path);
+/* ===========[ End: Simulator-only functions]=========== */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*_PLATFORM_HOST_SIM_*/
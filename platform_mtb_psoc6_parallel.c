@@ -0,0 +1,65 @@
+#include <platform_mtb_psoc6_parallel.h>
+
+/* Both PSoC6 platforms are in the project, only the selected one is built */
+#if defined(ILI_PLATFORM_MTB_PSOC6_PARALLEL)
+
+ili_bus_t ili_platform_default_bus =
+{
+	.data_port = DISP_DATA_PORT,
+	.ctl_port = DISP_CTL_PORT,
+	.dc_num = DISP_DC_NUM,
+	.wr_num = DISP_WR_NUM,
+#ifdef DISP_CS_NUM
+	.cs_num = DISP_CS_NUM,
+#endif
+#ifdef DISP_RD_NUM
+	.rd_num = DISP_RD_NUM,
+#endif
+#ifdef DISP_RST_NUM
+	.rst_num = DISP_RST_NUM,
+#endif
+#ifdef ILI_PLATFORM_TE
+	.te_port = DISP_TE_PORT,
+	.te_num = DISP_TE_NUM,
+	.te_irq = DISP_TE_IRQ,
+#endif
+};
+
+void ili_platform_parallel_init(ili_bus_t *bus)
+{
+	/* Data lines, all driven low */
+	GPIO_PRT_OUT(bus->data_port) = 0;
+	for (uint32_t pin = 0; pin < 8; pin++)
+	{
+		Cy_GPIO_Pin_FastInit(bus->data_port, pin, CY_GPIO_DM_STRONG_IN_OFF, 0, HSIOM_SEL_GPIO);
+	}
+
+	/* WR idles high, a byte is latched on its rising edge */
+	Cy_GPIO_Pin_FastInit(bus->ctl_port, bus->wr_num, CY_GPIO_DM_STRONG_IN_OFF, 1, HSIOM_SEL_GPIO);
+#ifdef DISP_RD_NUM
+	/* RD high keeps the panel from driving the data lines */
+	Cy_GPIO_Pin_FastInit(bus->ctl_port, bus->rd_num, CY_GPIO_DM_STRONG_IN_OFF, 1, HSIOM_SEL_GPIO);
+#endif
+#ifdef ILI_PLATFORM_TE
+	ili_platform_te_init(bus);
+#endif
+}
+
+void ili_platform_parallel_deinit(ili_bus_t *bus)
+{
+	/* Release the data lines for other devices on the bus. WR stays high so nothing gets latched */
+	for (uint32_t pin = 0; pin < 8; pin++)
+	{
+		Cy_GPIO_SetDrivemode(bus->data_port, pin, CY_GPIO_DM_HIGHZ);
+	}
+#ifdef ILI_PLATFORM_TE
+	ili_platform_te_deinit(bus);
+#endif
+}
+
+void ili_platform_delay(uint64_t ms)
+{
+    cyhal_system_delay_ms(ms);
+}
+
+#endif /*ILI_PLATFORM_MTB_PSOC6_PARALLEL*/
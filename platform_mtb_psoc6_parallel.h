@@ -0,0 +1,139 @@
+// NOTE: Only to be included by ili9341.h. User should NOT include it
+// ModusToolbox PSoC6 platform, 8-bit parallel (8080) bus. Select it with `ILI_PLATFORM_MTB_PSOC6_PARALLEL`
+
+#ifndef _PLATFORM_MTB_PSOC6_PARALLEL_
+#define _PLATFORM_MTB_PSOC6_PARALLEL_
+
+#include <stdint.h>
+#include <string.h>
+#include "cybsp.h"
+#include "cyhal.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * D0..D7 must be pins 0..7 of one port, in order, and nothing else may use that port:
+ * a byte goes out with a single store to its output register.
+ * The common Arduino UNO shields spread D0..D7 over two ports, rewire them for this platform.
+ */
+#define DISP_DATA_PORT       GPIO_PRT9
+
+#define DISP_CTL_PORT        P5_0_PORT
+#define DISP_CS_NUM          P5_7_NUM	/* D7 */
+#define DISP_DC_NUM          P5_4_NUM	/* D4 */
+#define DISP_WR_NUM          P5_3_NUM	/* D3 */
+/*Optional*/
+#define DISP_RD_NUM          P5_2_NUM	/* D2, held high. The driver does not read on this bus */
+//#define DISP_RST_NUM         P5_5_NUM	/* D5 */
+
+
+/* ====================================================== */
+/*      Mandatory Config Macros needed by ili9341.c/h     */
+/* ====================================================== */
+#define ILI_BUS_TYPE_PARALLEL8
+
+/* ============[ End: Mandatory Config Macros]=========== */
+
+
+/* ====================================================== */
+/*  Optional Config Macros (default values in ili9341.h)  */
+/* ====================================================== */
+//#define ILI_PLATFORM_TE               /* Enables ili_wait_te() and ili_flush_vsync(). Needs the panel's TE wired to DISP_TE_NUM (D6) */
+
+/* ============[ End: Optional Config Macros]============ */
+
+
+/*
+ * One parallel bus: its data port and the panel's control pins. ili_platform_default_bus is made of
+ * the DISP_xx macros above. A second panel needs its own data port, and its control pins on
+ * a port of their own or on DISP_CTL_PORT. Pass it to ili_dev_setup(). Members after `te_irq` are
+ * the platform's working state, leave them out of the initializer.
+ */
+typedef struct
+{
+	GPIO_PRT_Type *data_port;   /* D0..D7 on pins 0..7 */
+	GPIO_PRT_Type *ctl_port;
+	uint8_t dc_num;
+	uint8_t wr_num;
+#ifdef DISP_CS_NUM
+	uint8_t cs_num;
+#endif
+#ifdef DISP_RD_NUM
+	uint8_t rd_num;
+#endif
+#ifdef DISP_RST_NUM
+	uint8_t rst_num;
+#endif
+#ifdef ILI_PLATFORM_TE
+	GPIO_PRT_Type *te_port;
+	uint8_t te_num;
+	IRQn_Type te_irq;
+
+	uint8_t te_slot;                    /* Entry of the bus in the TE interrupt, 0 when the pin is polled */
+	volatile uint32_t te_count;         /* Pulses counted by the interrupt */
+#endif
+} ili_bus_t;
+
+/* Bus of the ili_* functions without a handle */
+extern ili_bus_t ili_platform_default_bus;
+
+/* TE pin (DISP_TE_xx) and its interrupt, shared with the other PSoC6 bus */
+#include "platform_mtb_psoc6_te.h"
+
+
+/* ====================================================== */
+/*        Mandatory Macros needed by ili9341.c/h          */
+/* ====================================================== */
+#define ILI_PLATFORM_DC_HIGH(bus)    {GPIO_PRT_OUT_SET((bus)->ctl_port) = (1UL << (bus)->dc_num);}
+#define ILI_PLATFORM_DC_LOW(bus)     {GPIO_PRT_OUT_CLR((bus)->ctl_port) = (1UL << (bus)->dc_num);}
+/* ===============[ End: Mandatory Macros]=============== */
+
+
+/* ====================================================== */
+/*         Optional Macros needed by ili9341.c/h          */
+/* ====================================================== */
+#ifdef DISP_CS_NUM
+	#define ILI_PLATFORM_CS_HIGH(bus)    {GPIO_PRT_OUT_SET((bus)->ctl_port) = (1UL << (bus)->cs_num);}
+	#define ILI_PLATFORM_CS_LOW(bus)     {GPIO_PRT_OUT_CLR((bus)->ctl_port) = (1UL << (bus)->cs_num);}
+#endif /*DISP_CS_NUM*/
+#ifdef DISP_RST_NUM
+	#define ILI_PLATFORM_RST_HIGH(bus)   {GPIO_PRT_OUT_SET((bus)->ctl_port) = (1UL << (bus)->rst_num);}
+	#define ILI_PLATFORM_RST_LOW(bus)    {GPIO_PRT_OUT_CLR((bus)->ctl_port) = (1UL << (bus)->rst_num);}
+#endif /*DISP_RST_NUM*/
+/*
+ * With WR_LOW/WR_HIGH defined, fills whose high and low bytes are equal (black, white, ...)
+ * leave the byte on the port and only strobe WR. Each store takes a few cycles on the
+ * peripheral bus, which keeps WR low and high longer than the 15ns the panel needs
+ */
+#define ILI_PLATFORM_WR_HIGH(bus)    {GPIO_PRT_OUT_SET((bus)->ctl_port) = (1UL << (bus)->wr_num);}
+#define ILI_PLATFORM_WR_LOW(bus)     {GPIO_PRT_OUT_CLR((bus)->ctl_port) = (1UL << (bus)->wr_num);}
+/* ================[ End: Optional Macros]=============== */
+
+
+/* ====================================================== */
+/*        Mandatory functions needed by ili9341.c/h       */
+/* ====================================================== */
+void ili_platform_parallel_init(ili_bus_t *bus);
+void ili_platform_parallel_deinit(ili_bus_t *bus);
+void ili_platform_delay(uint64_t ms);
+#ifdef ILI_PLATFORM_TE
+	/* Only needed when ILI_PLATFORM_TE is defined */
+	void ili_platform_te_wait(ili_bus_t *bus);
+#endif /*ILI_PLATFORM_TE*/
+
+/* All 8 data lines with one store, then the WR strobe. The panel latches the byte on the rising edge */
+__attribute__((always_inline)) static inline void ili_platform_parallel_send8(ili_bus_t *bus, uint8_t byte)
+{
+	GPIO_PRT_OUT(bus->data_port) = byte;
+	ILI_PLATFORM_WR_LOW(bus);
+	ILI_PLATFORM_WR_HIGH(bus);
+}
+/* ==============[ End: Mandatory functions]============= */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*_PLATFORM_MTB_PSOC6_PARALLEL_*/
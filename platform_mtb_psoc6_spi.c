@@ -1,9 +1,12 @@
+#include <ili9341.h>	/* ILI_SPI_READ_FREQ */
 #include <platform_mtb_psoc6_spi.h>
 #include <stdio.h>
 
+/* Both PSoC6 platforms are in the project, only the selected one is built */
+#if !defined(ILI_PLATFORM_MTB_PSOC6_PARALLEL)
+
 // TODO:
-// 1. Make spi_send functions inline?
-// 2. Add spi_send16 function? Will make line and pixel drawing faster
+// 1. Make spi_send functions inline? (single words are, see ili_platform_spi_send16())
 
 /* CLK_PERI is set at 50MHz. Can be changed in the device configurator */
 #define _CLK_PERI  50000000UL
@@ -11,24 +14,84 @@
 /* Read Cy_SCB_SPI_Init() in cy_scb_spi.h file to understand this */
 /* Width should be 4, 8, or 16 */
 /* NOTE: is_bytemode is 0 or 1. Any other value will mess up SPI settings*/
-#define _SPI_SET_TX_WIDTH(width, is_bytemode) \
+#define _SPI_SET_TX_WIDTH(scb, width, is_bytemode) \
 	/*Disable SPI*/ \
-	SCB_CTRL(DISP_SPI_SCB) &= (uint32_t) ~SCB_CTRL_ENABLED_Msk; \
+	SCB_CTRL(scb) &= (uint32_t) ~SCB_CTRL_ENABLED_Msk; \
 	/* Enable or disable bytemode */ \
-	SCB_CTRL(DISP_SPI_SCB) =(SCB_CTRL(DISP_SPI_SCB) & (uint32_t) ~SCB_CTRL_BYTE_MODE_Msk) | (is_bytemode << SCB_CTRL_BYTE_MODE_Pos); \
+	SCB_CTRL(scb) =(SCB_CTRL(scb) & (uint32_t) ~SCB_CTRL_BYTE_MODE_Msk) | (is_bytemode << SCB_CTRL_BYTE_MODE_Pos); \
 	/*Changing to 8-bit width from 16*/ \
-	SCB_RX_CTRL(DISP_SPI_SCB) = (SCB_RX_CTRL(DISP_SPI_SCB) & (uint32_t) ~0xFUL) | _VAL2FLD(SCB_RX_CTRL_DATA_WIDTH, ((width) - 1UL));\
+	SCB_RX_CTRL(scb) = (SCB_RX_CTRL(scb) & (uint32_t) ~0xFUL) | _VAL2FLD(SCB_RX_CTRL_DATA_WIDTH, ((width) - 1UL));\
 	/*Changing to 8-bit width from 16*/ \
-	SCB_TX_CTRL(DISP_SPI_SCB) = (SCB_TX_CTRL(DISP_SPI_SCB) & (uint32_t) ~0xFUL) | _VAL2FLD(SCB_TX_CTRL_DATA_WIDTH, ((width) - 1UL)); \
+	SCB_TX_CTRL(scb) = (SCB_TX_CTRL(scb) & (uint32_t) ~0xFUL) | _VAL2FLD(SCB_TX_CTRL_DATA_WIDTH, ((width) - 1UL)); \
 	/*Enable SPI*/ \
-	SCB_CTRL(DISP_SPI_SCB) |= SCB_CTRL_ENABLED_Msk; \
+	SCB_CTRL(scb) |= SCB_CTRL_ENABLED_Msk; \
+
+
+/* Clock dividers of the SCBs are 16.5 bit ones */
+#define _SPI_CLK_DIV_TYPE  CY_SYSCLK_DIV_16_5_BIT
+
+ili_bus_t ili_platform_default_bus =
+{
+	.scb = DISP_SPI_SCB,
+	.scb_clock = DISP_SPI_CLOCK,
+	.clk_div_num = DISP_SPI_CLK_DIV_NUM,
+	.spi_port = DISP_SPI_PORT,
+	.miso_num = DISP_SPI_MISO_NUM,
+	.mosi_num = DISP_SPI_MOSI_NUM,
+	.sclk_num = DISP_SPI_SCLK_NUM,
+	.miso_hsiom = DISP_SPI_MISO_HSIOM,
+	.mosi_hsiom = DISP_SPI_MOSI_HSIOM,
+	.sclk_hsiom = DISP_SPI_SCLK_HSIOM,
+	.ctl_port = DISP_CTL_PORT,
+	.dc_num = DISP_DC_NUM,
+#ifdef DISP_CS_NUM
+	.cs_num = DISP_CS_NUM,
+#endif
+#ifdef DISP_RST_NUM
+	.rst_num = DISP_RST_NUM,
+#endif
+#ifdef ILI_PLATFORM_SPI_ASYNC
+	.spi_irq = DISP_SPI_IRQ,
+	.dma_hw = DISP_DMA_HW,
+	.dma_channel = DISP_DMA_CHANNEL,
+	.dma_irq = DISP_DMA_IRQ,
+	.dma_trigger = DISP_DMA_TRIGGER,
+#endif
+#ifdef ILI_PLATFORM_TE
+	.te_port = DISP_TE_PORT,
+	.te_num = DISP_TE_NUM,
+	.te_irq = DISP_TE_IRQ,
+#endif
+};
+
+#ifdef ILI_PLATFORM_SPI_READ
+/* MISO is only sampled with an oversample of 4 or more */
+#define _SPI_READ_OVERSAMPLE  4UL
+
+static void _spi_set_read_mode(ili_bus_t *bus, uint8_t is_read);
+#endif /*ILI_PLATFORM_SPI_READ*/
 
+#ifdef ILI_PLATFORM_SPI_ASYNC
+/* DataWire X loop moves at most 256 elements, Y loop repeats it at most 256 times */
+#define _DMA_MAX_XCOUNT   256UL
+#define _DMA_MAX_YCOUNT   256UL
 
-static cy_stc_scb_spi_config_t g_spi_config;
+/*
+ * Cy_SysInt_Init() takes handlers without arguments, so every slot has its own pair of handlers
+ * that look the bus up here. Slot 0 is "none", a bus without a slot sends blocking.
+ */
+static ili_bus_t *g_isr_bus[ILI_PLATFORM_MAX_ASYNC_BUSES + 1];
+
+static void _dma_init(ili_bus_t *bus);
+static void _dma_start_chunk(ili_bus_t *bus);
+static void _dma_isr(ili_bus_t *bus);
+static void _spi_done_isr(ili_bus_t *bus);
+static void _xfer_complete(ili_bus_t *bus);
+#endif /*ILI_PLATFORM_SPI_ASYNC*/
 
 
 // Only called if SPI_IS_SHARED is defined
-void ili_platform_spi_init(uint64_t spi_freq, uint8_t cpol, uint8_t cpha, uint8_t is_lsbfirst)
+void ili_platform_spi_init(ili_bus_t *bus, uint64_t spi_freq, uint8_t cpol, uint8_t cpha, uint8_t is_lsbfirst)
 {
 	/**
 	 * We can do the init using HAL too instead of PDL, but HAL sets oversample to minimum 4,
@@ -46,38 +109,38 @@ void ili_platform_spi_init(uint64_t spi_freq, uint8_t cpol, uint8_t cpha, uint8_
     // --------- Init using PDL ---------
     (void)spi_freq; // unused for now, using fixed 25MHz instead
 
-	g_spi_config.spiMode  = CY_SCB_SPI_MASTER;
-	g_spi_config.subMode  = CY_SCB_SPI_MOTOROLA;
-	g_spi_config.sclkMode = (cpol << 1) | cpha /*CY_SCB_SPI_CPHA0_CPOL0*/;
-	g_spi_config.oversample = 2UL; /* If using MISO; minimum is 4; else min is 2 */
-	g_spi_config.rxDataWidth              = 8UL;
-	g_spi_config.txDataWidth              = 8UL;
-	g_spi_config.enableMsbFirst           = !is_lsbfirst;
-	g_spi_config.enableInputFilter        = false;
-	g_spi_config.enableFreeRunSclk        = false;
-	g_spi_config.enableMisoLateSample     = false;
-	g_spi_config.enableTransferSeperation = false;
-	g_spi_config.ssPolarity               = CY_SCB_SPI_ACTIVE_LOW;
-	g_spi_config.enableWakeFromSleep      = false;
-	g_spi_config.rxFifoTriggerLevel  = 0UL;
-	g_spi_config.rxFifoIntEnableMask = 0UL;
-	g_spi_config.txFifoTriggerLevel  = 0UL;
-	g_spi_config.txFifoIntEnableMask = 0UL;
-	g_spi_config.masterSlaveIntEnableMask = 0UL;
-
-    Cy_SCB_SPI_Init(DISP_SPI_SCB, &g_spi_config, NULL);
-
-    /* Configure SCB6 pins for SPI Master operation */
-    /* Connect SCB6 SPI function to pins */
-    Cy_GPIO_Pin_FastInit(DISP_SPI_PORT, DISP_SPI_MISO_NUM, CY_GPIO_DM_HIGHZ, 0, P12_1_SCB6_SPI_MISO);
-    Cy_GPIO_Pin_FastInit(DISP_SPI_PORT, DISP_SPI_MOSI_NUM, CY_GPIO_DM_STRONG_IN_OFF, 0, P12_0_SCB6_SPI_MOSI);
-    Cy_GPIO_Pin_FastInit(DISP_SPI_PORT, DISP_SPI_SCLK_NUM, CY_GPIO_DM_STRONG_IN_OFF, 0, P12_2_SCB6_SPI_CLK);
+	bus->config.spiMode  = CY_SCB_SPI_MASTER;
+	bus->config.subMode  = CY_SCB_SPI_MOTOROLA;
+	bus->config.sclkMode = (cpol << 1) | cpha /*CY_SCB_SPI_CPHA0_CPOL0*/;
+	bus->config.oversample = 2UL; /* If using MISO; minimum is 4; else min is 2 */
+	bus->config.rxDataWidth              = 8UL;
+	bus->config.txDataWidth              = 8UL;
+	bus->config.enableMsbFirst           = !is_lsbfirst;
+	bus->config.enableInputFilter        = false;
+	bus->config.enableFreeRunSclk        = false;
+	bus->config.enableMisoLateSample     = false;
+	bus->config.enableTransferSeperation = false;
+	bus->config.ssPolarity               = CY_SCB_SPI_ACTIVE_LOW;
+	bus->config.enableWakeFromSleep      = false;
+	bus->config.rxFifoTriggerLevel  = 0UL;
+	bus->config.rxFifoIntEnableMask = 0UL;
+	bus->config.txFifoTriggerLevel  = 0UL;
+	bus->config.txFifoIntEnableMask = 0UL;
+	bus->config.masterSlaveIntEnableMask = 0UL;
+
+    Cy_SCB_SPI_Init(bus->scb, &bus->config, NULL);
+
+    /* Configure the SCB pins for SPI Master operation */
+    /* Connect the SCB SPI function to pins */
+    Cy_GPIO_Pin_FastInit(bus->spi_port, bus->miso_num, CY_GPIO_DM_HIGHZ, 0, bus->miso_hsiom);
+    Cy_GPIO_Pin_FastInit(bus->spi_port, bus->mosi_num, CY_GPIO_DM_STRONG_IN_OFF, 0, bus->mosi_hsiom);
+    Cy_GPIO_Pin_FastInit(bus->spi_port, bus->sclk_num, CY_GPIO_DM_STRONG_IN_OFF, 0, bus->sclk_hsiom);
 
     /* Assign divider type and number for SPI */
-    cy_en_divider_types_t spi_clk_div_type = CY_SYSCLK_DIV_16_5_BIT;
-    uint32_t              spi_clk_div_num  = 0;
+    cy_en_divider_types_t spi_clk_div_type = _SPI_CLK_DIV_TYPE;
+    uint32_t              spi_clk_div_num  = bus->clk_div_num;
     /* Connect assigned divider to be a clock source for SPI */
-    Cy_SysClk_PeriphAssignDivider(PCLK_SCB6_CLOCK, spi_clk_div_type, spi_clk_div_num);
+    Cy_SysClk_PeriphAssignDivider(bus->scb_clock, spi_clk_div_type, spi_clk_div_num);
 
     /* The SPI master data rate = ((clk_peri/ divider) / Oversample)).
     * For clk_peri = 100 MHz, select divider value 1 and get SCB clock = (100 MHz / 1) = 100 MHz.
@@ -92,48 +155,397 @@ void ili_platform_spi_init(uint64_t spi_freq, uint8_t cpol, uint8_t cpha, uint8_
     Cy_SysClk_PeriphSetFracDivider(spi_clk_div_type, spi_clk_div_num, div_int-1, div_frac);
     Cy_SysClk_PeriphEnableDivider(spi_clk_div_type, spi_clk_div_num);
 
+#ifdef ILI_PLATFORM_SPI_READ
+    /* The panel can't be read at the write clock. Reads run at ILI_SPI_READ_FREQ, oversample 4 */
+    bus->div_int = div_int - 1;
+    bus->div_frac = div_frac;
+    div = (float)_CLK_PERI / (float)(ILI_SPI_READ_FREQ * _SPI_READ_OVERSAMPLE);
+    div_int = (div < 1.0f) ? 1 : div;
+    bus->read_div_int = div_int - 1;
+    bus->read_div_frac = (div < 1.0f) ? 0 : (div - div_int) * 32;
+#endif
+
     /* Enable SPI to operate */
-    Cy_SCB_SPI_Enable(DISP_SPI_SCB);
+    Cy_SCB_SPI_Enable(bus->scb);
+
+#ifdef ILI_PLATFORM_SPI_ASYNC
+    _dma_init(bus);
+#endif
+#ifdef ILI_PLATFORM_TE
+    ili_platform_te_init(bus);
+#endif
 }
 
-void ili_platform_spi_deinit(void)
+void ili_platform_spi_deinit(ili_bus_t *bus)
 {
 //	cyhal_spi_free(&mSPI);
 
-    Cy_SCB_SPI_Disable(DISP_SPI_SCB, NULL);
-    Cy_SCB_SPI_DeInit(DISP_SPI_SCB);
+#ifdef ILI_PLATFORM_SPI_ASYNC
+	ili_platform_spi_wait_idle(bus);
+	if (bus->isr_slot)
+	{
+		NVIC_DisableIRQ(bus->dma_irq);
+		NVIC_DisableIRQ(bus->spi_irq);
+		Cy_DMA_Channel_DeInit(bus->dma_hw, bus->dma_channel);
+		g_isr_bus[bus->isr_slot] = NULL;
+		bus->isr_slot = 0;
+	}
+#endif
+#ifdef ILI_PLATFORM_TE
+	ili_platform_te_deinit(bus);
+#endif
+
+    Cy_SCB_SPI_Disable(bus->scb, NULL);
+    Cy_SCB_SPI_DeInit(bus->scb);
 
     /* Making pins normal GPIO else they're not pulling low when SPI is stopped */
-	Cy_GPIO_Pin_FastInit(DISP_SPI_PORT, DISP_SPI_MOSI_NUM, CY_GPIO_DM_STRONG_IN_OFF, 0, P12_0_GPIO);
-    Cy_GPIO_Pin_FastInit(DISP_SPI_PORT, DISP_SPI_MISO_NUM, CY_GPIO_DM_HIGHZ, 0, P12_1_GPIO);
-	Cy_GPIO_Pin_FastInit(DISP_SPI_PORT, DISP_SPI_SCLK_NUM, CY_GPIO_DM_STRONG_IN_OFF, 0, P12_2_GPIO);
+	Cy_GPIO_Pin_FastInit(bus->spi_port, bus->mosi_num, CY_GPIO_DM_STRONG_IN_OFF, 0, HSIOM_SEL_GPIO);
+    Cy_GPIO_Pin_FastInit(bus->spi_port, bus->miso_num, CY_GPIO_DM_HIGHZ, 0, HSIOM_SEL_GPIO);
+	Cy_GPIO_Pin_FastInit(bus->spi_port, bus->sclk_num, CY_GPIO_DM_STRONG_IN_OFF, 0, HSIOM_SEL_GPIO);
+}
+
+
+void ili_platform_spi_set_width(ili_bus_t *bus, uint8_t width)
+{
+	if (width == 16)
+	{
+		_SPI_SET_TX_WIDTH(bus->scb, 16, 0); // Width: 16, bytemode: No
+	}
+	else
+	{
+		_SPI_SET_TX_WIDTH(bus->scb, 8, 1); // Width: 8, bytemode: Yes
+	}
 }
 
 
-void ili_platform_spi_send8(uint8_t data)
+void ili_platform_spi_send8(ili_bus_t *bus, uint8_t data)
 {
 	/*If Tx width is 16, set it to 16 before proceeding*/
-	if ((SCB_TX_CTRL(DISP_SPI_SCB) & 0xFUL) == 16UL - 1UL)
+	if ((SCB_TX_CTRL(bus->scb) & 0xFUL) == 16UL - 1UL)
 	{
-		_SPI_SET_TX_WIDTH(8, 1); // Width: 8, bytemode: Yes
+		_SPI_SET_TX_WIDTH(bus->scb, 8, 1); // Width: 8, bytemode: Yes
 	}
-	SCB_TX_FIFO_WR(DISP_SPI_SCB) = data;
-	while(!Cy_SCB_SPI_IsTxComplete(DISP_SPI_SCB));
+	SCB_TX_FIFO_WR(bus->scb) = data;
+	while(!Cy_SCB_SPI_IsTxComplete(bus->scb));
 }
 
 
-void ili_platform_spi_send_buffer16(uint16_t *buf, uint32_t items_count)
+void ili_platform_spi_send_buffer16(ili_bus_t *bus, uint16_t *buf, uint32_t items_count)
 {
 	/*If Tx width is 8, set it to 16 before proceeding*/
-	if ((SCB_TX_CTRL(DISP_SPI_SCB) & 0xFUL) == 8UL- 1UL)
+	if ((SCB_TX_CTRL(bus->scb) & 0xFUL) == 8UL- 1UL)
 	{
-		_SPI_SET_TX_WIDTH(16, 0); // Width: 16, bytemode: No
+		_SPI_SET_TX_WIDTH(bus->scb, 16, 0); // Width: 16, bytemode: No
 	}
-    Cy_SCB_SPI_WriteArrayBlocking(DISP_SPI_SCB, (void *)buf, items_count);
-    while(!Cy_SCB_SPI_IsTxComplete(DISP_SPI_SCB));
+    Cy_SCB_SPI_WriteArrayBlocking(bus->scb, (void *)buf, items_count);
+    while(!Cy_SCB_SPI_IsTxComplete(bus->scb));
+}
+
+/*
+ * Send a command and its parameters. DC toggles once, the parameters are streamed
+ * through the FIFO and the bus is drained only before each DC change.
+ * If the SCB is in 16-bit mode (after pixel data) and the parameters pair up, it stays
+ * in 16-bit mode: the command goes out as NOP + cmd, NOP has no effect on the panel.
+ * That saves two width switches per address window.
+ */
+void ili_platform_spi_send_cmd(ili_bus_t *bus, uint8_t cmd, const uint8_t *params, uint32_t n)
+{
+	uint8_t is_16bit = ((SCB_TX_CTRL(bus->scb) & 0xFUL) == 16UL - 1UL) && !(n & 1UL);
+
+	ILI_PLATFORM_DC_LOW(bus);
+	if (is_16bit)
+	{
+		SCB_TX_FIFO_WR(bus->scb) = (uint32_t)cmd;	/* 0x00 (NOP) in the upper byte */
+	}
+	else
+	{
+		if ((SCB_TX_CTRL(bus->scb) & 0xFUL) == 16UL - 1UL)
+		{
+			_SPI_SET_TX_WIDTH(bus->scb, 8, 1); // Width: 8, bytemode: Yes
+		}
+		SCB_TX_FIFO_WR(bus->scb) = cmd;
+	}
+	while(!Cy_SCB_SPI_IsTxComplete(bus->scb));
+
+	if (n == 0)
+		return;
+
+	ILI_PLATFORM_DC_HIGH(bus);
+	if (is_16bit)
+	{
+		for (uint32_t i = 0; i < n; i += 2)
+		{
+			while (0UL == Cy_SCB_SPI_Write(bus->scb, ((uint32_t)params[i] << 8) | params[i + 1]));
+		}
+	}
+	else
+	{
+		for (uint32_t i = 0; i < n; i++)
+		{
+			while (0UL == Cy_SCB_SPI_Write(bus->scb, params[i]));
+		}
+	}
+	while(!Cy_SCB_SPI_IsTxComplete(bus->scb));
 }
 
 void ili_platform_delay(uint64_t ms)
 {
     cyhal_system_delay_ms(ms);
 }
+
+
+#ifdef ILI_PLATFORM_SPI_READ
+/*
+ * Send a read command and clock in `n` bytes. The SCB runs with oversample 2 for writing, which
+ * leaves MISO unsampled, so it's switched to oversample 4 at ILI_SPI_READ_FREQ for the read and
+ * back afterwards. The FIFO is kept full with dummy bytes, so the clock doesn't stop between bytes.
+ * CS is toggled at the end, that's what stops the panel from driving its output.
+ */
+void ili_platform_spi_read_cmd(ili_bus_t *bus, uint8_t cmd, uint8_t *buf, uint32_t n)
+{
+	ili_platform_spi_send_cmd(bus, cmd, NULL, 0);
+	if ((SCB_TX_CTRL(bus->scb) & 0xFUL) == 16UL - 1UL)
+	{
+		_SPI_SET_TX_WIDTH(bus->scb, 8, 1); // Width: 8, bytemode: Yes
+	}
+	ILI_PLATFORM_DC_HIGH(bus);
+	_spi_set_read_mode(bus, 1);
+	Cy_SCB_SPI_ClearRxFifo(bus->scb);
+
+	uint32_t fifo_size = Cy_SCB_GetFifoSize(bus->scb);
+	uint32_t sent = 0;
+	uint32_t received = 0;
+	while (received < n)
+	{
+		while (sent < n && sent - received < fifo_size)
+		{
+			SCB_TX_FIFO_WR(bus->scb) = 0x00UL;
+			sent++;
+		}
+		while (Cy_SCB_SPI_GetNumInRxFifo(bus->scb))
+		{
+			buf[received++] = (uint8_t)SCB_RX_FIFO_RD(bus->scb);
+		}
+	}
+	_spi_set_read_mode(bus, 0);
+
+#ifdef DISP_CS_NUM
+	ILI_PLATFORM_CS_HIGH(bus);
+	ILI_PLATFORM_CS_LOW(bus);
+#endif
+}
+
+/* Oversample and clock divider for reading (1) or writing (0). The SCB is off while they change */
+static void _spi_set_read_mode(ili_bus_t *bus, uint8_t is_read)
+{
+	uint32_t ovs = is_read ? _SPI_READ_OVERSAMPLE : bus->config.oversample;
+
+	SCB_CTRL(bus->scb) &= (uint32_t) ~SCB_CTRL_ENABLED_Msk;
+	Cy_SysClk_PeriphDisableDivider(_SPI_CLK_DIV_TYPE, bus->clk_div_num);
+	Cy_SysClk_PeriphSetFracDivider(_SPI_CLK_DIV_TYPE, bus->clk_div_num,
+			is_read ? bus->read_div_int : bus->div_int, is_read ? bus->read_div_frac : bus->div_frac);
+	Cy_SysClk_PeriphEnableDivider(_SPI_CLK_DIV_TYPE, bus->clk_div_num);
+	SCB_CTRL(bus->scb) = (SCB_CTRL(bus->scb) & (uint32_t) ~SCB_CTRL_OVS_Msk) | _VAL2FLD(SCB_CTRL_OVS, ovs - 1UL);
+	SCB_CTRL(bus->scb) |= SCB_CTRL_ENABLED_Msk;
+}
+#endif /*ILI_PLATFORM_SPI_READ*/
+
+
+#ifdef ILI_PLATFORM_SPI_ASYNC
+void ili_platform_spi_send_buffer16_async(ili_bus_t *bus, uint16_t *buf, uint32_t items_count, void (*done_cb)(void *user_data), void *user_data)
+{
+	ili_platform_spi_wait_idle(bus);
+	if (items_count == 0 || bus->isr_slot == 0)
+	{
+		/* No interrupt handlers were free for this bus in _dma_init() */
+		ili_platform_spi_send_buffer16(bus, buf, items_count);
+		if (done_cb)
+			done_cb(user_data);
+		return;
+	}
+
+	/*If Tx width is 8, set it to 16 before proceeding*/
+	if ((SCB_TX_CTRL(bus->scb) & 0xFUL) == 8UL- 1UL)
+	{
+		_SPI_SET_TX_WIDTH(bus->scb, 16, 0); // Width: 16, bytemode: No
+	}
+	/* tr_tx_req stays asserted while the FIFO has room for one more entry */
+	Cy_SCB_SetTxFifoLevel(bus->scb, Cy_SCB_GetFifoSize(bus->scb) - 1UL);
+
+	bus->dma_src = buf;
+	bus->dma_remaining = items_count;
+	bus->dma_done_cb = done_cb;
+	bus->dma_done_cb_data = user_data;
+	bus->dma_busy = 1;
+
+	_dma_start_chunk(bus);
+}
+
+void ili_platform_spi_wait_idle(ili_bus_t *bus)
+{
+	while (bus->dma_busy);
+}
+
+
+static void _dma_isr_1(void) { _dma_isr(g_isr_bus[1]); }
+static void _spi_done_isr_1(void) { _spi_done_isr(g_isr_bus[1]); }
+#if ILI_PLATFORM_MAX_ASYNC_BUSES >= 2
+static void _dma_isr_2(void) { _dma_isr(g_isr_bus[2]); }
+static void _spi_done_isr_2(void) { _spi_done_isr(g_isr_bus[2]); }
+#endif
+#if ILI_PLATFORM_MAX_ASYNC_BUSES > 2
+	#error "Add interrupt handlers for the extra buses"
+#endif
+
+static const cy_israddress g_dma_isrs[] = {
+	NULL, _dma_isr_1,
+#if ILI_PLATFORM_MAX_ASYNC_BUSES >= 2
+	_dma_isr_2,
+#endif
+};
+static const cy_israddress g_spi_done_isrs[] = {
+	NULL, _spi_done_isr_1,
+#if ILI_PLATFORM_MAX_ASYNC_BUSES >= 2
+	_spi_done_isr_2,
+#endif
+};
+
+static void _dma_init(ili_bus_t *bus)
+{
+	uint8_t slot;
+
+	for (slot = 1; slot <= ILI_PLATFORM_MAX_ASYNC_BUSES; slot++)
+	{
+		if (g_isr_bus[slot] == NULL || g_isr_bus[slot] == bus)
+			break;
+	}
+	bus->dma_busy = 0;
+	if (slot > ILI_PLATFORM_MAX_ASYNC_BUSES)
+	{
+		/* All handlers are taken, this bus sends blocking */
+		bus->isr_slot = 0;
+		return;
+	}
+	g_isr_bus[slot] = bus;
+	bus->isr_slot = slot;
+
+	cy_stc_dma_descriptor_config_t descr_config =
+	{
+		.retrigger       = CY_DMA_RETRIG_4CYC,	/* Level trigger from SCB needs some cycles to deassert */
+		.interruptType   = CY_DMA_DESCR,
+		.triggerOutType  = CY_DMA_1ELEMENT,
+		.channelState    = CY_DMA_CHANNEL_DISABLED,
+		.triggerInType   = CY_DMA_1ELEMENT,
+		.dataSize        = CY_DMA_HALFWORD,
+		.srcTransferSize = CY_DMA_TRANSFER_SIZE_DATA,
+		.dstTransferSize = CY_DMA_TRANSFER_SIZE_WORD,	/* FIFO write register is 32-bit */
+		.descriptorType  = CY_DMA_2D_TRANSFER,
+		.srcAddress      = NULL,
+		.dstAddress      = (void *)&SCB_TX_FIFO_WR(bus->scb),
+		.srcXincrement   = 1L,
+		.dstXincrement   = 0L,
+		.xCount          = _DMA_MAX_XCOUNT,
+		.srcYincrement   = (int32_t)_DMA_MAX_XCOUNT,
+		.dstYincrement   = 0L,
+		.yCount          = 1UL,
+		.nextDescriptor  = NULL
+	};
+	cy_stc_dma_channel_config_t channel_config =
+	{
+		.descriptor  = &bus->dma_descr,
+		.preemptable = false,
+		.priority    = 0UL,
+		.enable      = false,
+		.bufferable  = false
+	};
+	cy_stc_sysint_t dma_irq_config = {.intrSrc = bus->dma_irq, .intrPriority = 3UL};
+	cy_stc_sysint_t spi_irq_config = {.intrSrc = bus->spi_irq, .intrPriority = 3UL};
+
+	Cy_TrigMux_Select(bus->dma_trigger, false, TRIGGER_TYPE_LEVEL);
+
+	Cy_DMA_Descriptor_Init(&bus->dma_descr, &descr_config);
+	Cy_DMA_Channel_Init(bus->dma_hw, bus->dma_channel, &channel_config);
+	Cy_DMA_Channel_SetInterruptMask(bus->dma_hw, bus->dma_channel, CY_DMA_INTR_MASK);
+	Cy_DMA_Enable(bus->dma_hw);
+
+	Cy_SCB_SetMasterInterruptMask(bus->scb, 0UL);
+	Cy_SysInt_Init(&dma_irq_config, g_dma_isrs[slot]);
+	Cy_SysInt_Init(&spi_irq_config, g_spi_done_isrs[slot]);
+	NVIC_EnableIRQ(bus->dma_irq);
+	NVIC_EnableIRQ(bus->spi_irq);
+}
+
+/* Program the descriptor with as many items as it can take and start it */
+static void _dma_start_chunk(ili_bus_t *bus)
+{
+	uint32_t items;
+
+	if (bus->dma_remaining >= _DMA_MAX_XCOUNT)
+	{
+		uint32_t y_count = bus->dma_remaining / _DMA_MAX_XCOUNT;
+		y_count = (y_count > _DMA_MAX_YCOUNT) ? _DMA_MAX_YCOUNT : y_count;
+		items = y_count * _DMA_MAX_XCOUNT;
+		Cy_DMA_Descriptor_SetDescriptorType(&bus->dma_descr, CY_DMA_2D_TRANSFER);
+		Cy_DMA_Descriptor_SetXloopDataCount(&bus->dma_descr, _DMA_MAX_XCOUNT);
+		Cy_DMA_Descriptor_SetYloopDataCount(&bus->dma_descr, y_count);
+	}
+	else
+	{
+		items = bus->dma_remaining;
+		Cy_DMA_Descriptor_SetDescriptorType(&bus->dma_descr, CY_DMA_1D_TRANSFER);
+		Cy_DMA_Descriptor_SetXloopDataCount(&bus->dma_descr, items);
+	}
+	Cy_DMA_Descriptor_SetSrcAddress(&bus->dma_descr, (void *)bus->dma_src);
+	bus->dma_src += items;
+	bus->dma_remaining -= items;
+
+	Cy_DMA_Channel_SetDescriptor(bus->dma_hw, bus->dma_channel, &bus->dma_descr);
+	Cy_DMA_Channel_Enable(bus->dma_hw, bus->dma_channel);
+}
+
+static void _dma_isr(ili_bus_t *bus)
+{
+	Cy_DMA_Channel_ClearInterrupt(bus->dma_hw, bus->dma_channel);
+
+	if (bus->dma_remaining)
+	{
+		_dma_start_chunk(bus);
+		return;
+	}
+
+	/* Last item is in the FIFO, not on the wire yet. Let the SCB tell when it's out */
+	Cy_SCB_ClearMasterInterrupt(bus->scb, CY_SCB_MASTER_INTR_SPI_DONE);
+	Cy_SCB_SetMasterInterruptMask(bus->scb, CY_SCB_MASTER_INTR_SPI_DONE);
+	/* It may have drained already before the interrupt was cleared */
+	if (Cy_SCB_SPI_IsTxComplete(bus->scb))
+		_xfer_complete(bus);
+}
+
+static void _spi_done_isr(ili_bus_t *bus)
+{
+	/*
+	 * SPI_DONE may have been pending in the NVIC while _dma_isr() completed the transfer itself.
+	 * Its callback may have started the next transfer since, which has SPI_DONE masked until
+	 * its last chunk: only a masked-in SPI_DONE ends a transfer
+	 */
+	if (!(Cy_SCB_GetMasterInterruptStatusMasked(bus->scb) & CY_SCB_MASTER_INTR_SPI_DONE))
+		return;
+
+	Cy_SCB_ClearMasterInterrupt(bus->scb, CY_SCB_MASTER_INTR_SPI_DONE);
+	_xfer_complete(bus);
+}
+
+static void _xfer_complete(ili_bus_t *bus)
+{
+	Cy_SCB_SetMasterInterruptMask(bus->scb, 0UL);
+	if (!bus->dma_busy)
+		return;
+
+	/* Bus is free before the callback runs, so it can start the next transfer */
+	bus->dma_busy = 0;
+	if (bus->dma_done_cb)
+		bus->dma_done_cb(bus->dma_done_cb_data);
+}
+#endif /*ILI_PLATFORM_SPI_ASYNC*/
+
+#endif /*!ILI_PLATFORM_MTB_PSOC6_PARALLEL*/
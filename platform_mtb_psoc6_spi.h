@@ -9,32 +9,46 @@
 #include "cybsp.h"
 #include "cyhal.h"
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 /* Using SCB6 which has SPI3 because we want to use Arduino headers */
 /* If user needs to use different SPI, find which SCB to use using device configurator */
 #define DISP_SPI_SCB         SCB6
+#define DISP_SPI_CLOCK       PCLK_SCB6_CLOCK
+#define DISP_SPI_CLK_DIV_NUM 0UL	/* 16.5 bit peripheral clock divider of the SCB */
 
 #define DISP_SPI_PORT        P12_0_PORT
 #define DISP_SPI_MISO_NUM    P12_1_NUM	/* D12 */
 #define DISP_SPI_MOSI_NUM    P12_0_NUM	/* D11 */
 #define DISP_SPI_SCLK_NUM    P12_2_NUM	/* D13 */
+#define DISP_SPI_MISO_HSIOM  P12_1_SCB6_SPI_MISO
+#define DISP_SPI_MOSI_HSIOM  P12_0_SCB6_SPI_MOSI
+#define DISP_SPI_SCLK_HSIOM  P12_2_SCB6_SPI_CLK
 
 #define DISP_CTL_PORT        P5_0_PORT
 #define DISP_CS_NUM          P5_7_NUM	/* D7 */
 #define DISP_DC_NUM          P5_4_NUM	/* D4 */
 /*Optional*/
 //#define DISP_RST_NUM         P5_5_NUM	/* D5 */
-/* ------------------------------------- */
-	/* Not needed for SPI. Only for parallel */
-	//#define DISP_WR_NUM          P5_3_NUM	/* D3 */
-	//#define DISP_RD_NUM          P5_2_NUM	/* D2 */
-/* ------------------------------------- */
+
+/* Interrupt of the SCB. Used by the non-blocking (DMA) transfers to know when the last bit is out */
+#define DISP_SPI_IRQ         scb_6_interrupt_IRQn
+
+/* DataWire channel feeding the SCB TX FIFO. Only needed when ILI_PLATFORM_SPI_ASYNC is defined */
+#define DISP_DMA_HW          DW0
+#define DISP_DMA_CHANNEL     16UL
+#define DISP_DMA_IRQ         cpuss_interrupts_dw0_16_IRQn
+/* One-to-one trigger routing SCB6 tr_tx_req -> DW0 channel 16.
+ * Name differs between PSoC6 parts, check the trigger section of the device header (gpio_psoc6_xx.h) */
+#define DISP_DMA_TRIGGER     TRIG_OUT_1TO1_0_SCB6_TX_TO_PDMA0_TR_IN16
 
 
 /* ====================================================== */
 /*      Mandatory Config Macros needed by ili9341.c/h     */
 /* ====================================================== */
-#define ILI_BUS_TYPE_SPI
-// #define ILI_BUS_TYPE_PARALLEL8
+#define ILI_BUS_TYPE_SPI    /* For the 8-bit parallel bus, define ILI_PLATFORM_MTB_PSOC6_PARALLEL in the project instead */
 
 /* ============[ End: Mandatory Config Macros]=========== */
 
@@ -43,15 +57,84 @@
 /*  Optional Config Macros (default values in ili9341.h)  */
 /* ====================================================== */
 #define ILI_SPI_FREQ    40000000UL    /* 40MHz  (Min: 10, Max: 50) */
+#define ILI_PLATFORM_SPI_ASYNC        /* Enables DMA transfers for ili_draw_pixels_buffer_async(). Comment out if no DMA channel is free */
+#define ILI_PLATFORM_SPI_READ         /* Enables frame memory read-back (ili_read_pixels()). Needs the panel's SDO wired to MISO (D12) */
+//#define ILI_PLATFORM_TE               /* Enables ili_wait_te() and ili_flush_vsync(). Needs the panel's TE wired to DISP_TE_NUM (D6) */
 
 /* ============[ End: Optional Config Macros]============ */
 
 
+/* Number of buses that can do non-blocking transfers at the same time. Each one has its own interrupt handlers */
+#define ILI_PLATFORM_MAX_ASYNC_BUSES    2
+
+/*
+ * One SPI bus: the SCB, its pins and clock divider, the panel's control pins and the DMA channel.
+ * ili_platform_default_bus is made of the DISP_xx macros above. A second panel needs its own SCB,
+ * clock divider and DataWire channel, pass it to ili_dev_setup(). Members after `te_irq` are
+ * the platform's working state, leave them out of the initializer.
+ */
+typedef struct
+{
+	CySCB_Type *scb;
+	en_clk_dst_t scb_clock;             /* PCLK_SCBx_CLOCK */
+	uint32_t clk_div_num;
+	GPIO_PRT_Type *spi_port;            /* MISO, MOSI and SCLK */
+	uint8_t miso_num, mosi_num, sclk_num;
+	en_hsiom_sel_t miso_hsiom, mosi_hsiom, sclk_hsiom;
+	GPIO_PRT_Type *ctl_port;            /* DC, CS and RST */
+	uint8_t dc_num;
+#ifdef DISP_CS_NUM
+	uint8_t cs_num;
+#endif
+#ifdef DISP_RST_NUM
+	uint8_t rst_num;
+#endif
+#ifdef ILI_PLATFORM_SPI_ASYNC
+	IRQn_Type spi_irq;
+	DW_Type *dma_hw;
+	uint32_t dma_channel;
+	IRQn_Type dma_irq;
+	uint32_t dma_trigger;
+#endif
+#ifdef ILI_PLATFORM_TE
+	GPIO_PRT_Type *te_port;
+	uint8_t te_num;
+	IRQn_Type te_irq;
+#endif
+
+	cy_stc_scb_spi_config_t config;
+#ifdef ILI_PLATFORM_SPI_READ
+	/* Divider settings (integer part - 1, fraction in 1/32) for writing and for reading */
+	uint32_t div_int, div_frac;
+	uint32_t read_div_int, read_div_frac;
+#endif
+#ifdef ILI_PLATFORM_SPI_ASYNC
+	uint8_t isr_slot;                   /* Interrupt handlers of the bus, 0 when it has none */
+	cy_stc_dma_descriptor_t dma_descr;
+	volatile uint8_t dma_busy;
+	uint16_t *dma_src;
+	uint32_t dma_remaining;
+	void (*dma_done_cb)(void *user_data);
+	void *dma_done_cb_data;
+#endif
+#ifdef ILI_PLATFORM_TE
+	uint8_t te_slot;                    /* Entry of the bus in the TE interrupt, 0 when the pin is polled */
+	volatile uint32_t te_count;         /* Pulses counted by the interrupt */
+#endif
+} ili_bus_t;
+
+/* Bus of the ili_* functions without a handle */
+extern ili_bus_t ili_platform_default_bus;
+
+/* TE pin (DISP_TE_xx) and its interrupt, shared with the other PSoC6 bus */
+#include "platform_mtb_psoc6_te.h"
+
+
 /* ====================================================== */
 /*        Mandatory Macros needed by ili9341.c/h          */
 /* ====================================================== */
-#define ILI_PLATFORM_DC_HIGH()    {GPIO_PRT_OUT_SET(DISP_CTL_PORT) = (1 << DISP_DC_NUM);}
-#define ILI_PLATFORM_DC_LOW()     {GPIO_PRT_OUT_CLR(DISP_CTL_PORT) = (1 << DISP_DC_NUM);}
+#define ILI_PLATFORM_DC_HIGH(bus)    {GPIO_PRT_OUT_SET((bus)->ctl_port) = (1UL << (bus)->dc_num);}
+#define ILI_PLATFORM_DC_LOW(bus)     {GPIO_PRT_OUT_CLR((bus)->ctl_port) = (1UL << (bus)->dc_num);}
 /* ===============[ End: Mandatory Macros]=============== */
 
 
@@ -59,41 +142,96 @@
 /*         Optional Macros needed by ili9341.c/h          */
 /* ====================================================== */
 #ifdef DISP_CS_NUM
-	#define ILI_PLATFORM_CS_HIGH()    {GPIO_PRT_OUT_SET(DISP_CTL_PORT) = (1 << DISP_CS_NUM);}
-	#define ILI_PLATFORM_CS_LOW()     {GPIO_PRT_OUT_CLR(DISP_CTL_PORT) = (1 << DISP_CS_NUM);}
+	#define ILI_PLATFORM_CS_HIGH(bus)    {GPIO_PRT_OUT_SET((bus)->ctl_port) = (1UL << (bus)->cs_num);}
+	#define ILI_PLATFORM_CS_LOW(bus)     {GPIO_PRT_OUT_CLR((bus)->ctl_port) = (1UL << (bus)->cs_num);}
 #endif /*DISP_CS_NUM*/
 #ifdef DISP_RST_NUM
-	#define ILI_PLATFORM_RST_HIGH()   {GPIO_PRT_OUT_SET(DISP_CTL_PORT) = (1 << DISP_RST_NUM);}
-	#define ILI_PLATFORM_RST_LOW()    {GPIO_PRT_OUT_CLR(DISP_CTL_PORT) = (1 << DISP_RST_NUM);}
+	#define ILI_PLATFORM_RST_HIGH(bus)   {GPIO_PRT_OUT_SET((bus)->ctl_port) = (1UL << (bus)->rst_num);}
+	#define ILI_PLATFORM_RST_LOW(bus)    {GPIO_PRT_OUT_CLR((bus)->ctl_port) = (1UL << (bus)->rst_num);}
 #endif /*DISP_RST_NUM*/
-/* ------------------------------------- */
-	/* Not needed for SPI. Only for parallel */
-	// #ifdef DISP_WR_NUM
-	// 	#define ILI_PLATFORM_WR_HIGH()    {Cy_GPIO_Write(DISP_CTL_PORT, DISP_WR_NUM, 1);}
-	// 	#define ILI_PLATFORM_WR_LOW()     {Cy_GPIO_Write(DISP_CTL_PORT, DISP_WR_NUM, 0);}
-	// #endif /*DISP_WR_NUM*/
-	// #ifdef DISP_RD_NUM
-	// 	#define ILI_PLATFORM_RD_HIGH()    {Cy_GPIO_Write(DISP_CTL_PORT, DISP_RD_NUM, 1);}
-	// 	#define ILI_PLATFORM_RD_LOW()     {Cy_GPIO_Write(DISP_CTL_PORT, DISP_RD_NUM, 0);}
-	// #endif /*DISP_RD_NUM*/
-/* ------------------------------------- */
 /* ================[ End: Optional Macros]=============== */
 
 
 /* ====================================================== */
 /*        Mandatory functions needed by ili9341.c/h       */
 /* ====================================================== */
-void ili_platform_spi_init(uint64_t spi_freq, uint8_t cpol, uint8_t cpha, uint8_t is_lsbfirst);
-void ili_platform_spi_deinit(void);
-void ili_platform_spi_send8(uint8_t byte);
-void ili_platform_spi_send_buffer16(uint16_t *buf, uint32_t items_count);
+void ili_platform_spi_init(ili_bus_t *bus, uint64_t spi_freq, uint8_t cpol, uint8_t cpha, uint8_t is_lsbfirst);
+void ili_platform_spi_deinit(ili_bus_t *bus);
+void ili_platform_spi_send8(ili_bus_t *bus, uint8_t byte);
+void ili_platform_spi_send_buffer16(ili_bus_t *bus, uint16_t *buf, uint32_t items_count);
+void ili_platform_spi_send_cmd(ili_bus_t *bus, uint8_t cmd, const uint8_t *params, uint32_t n);
 void ili_platform_delay(uint64_t ms);
-/* ------------------------------------- */
-	/* Not needed for SPI. Only for parallel */
-	//void ili_platform_parallel_init(void);
-	//void ili_platform_parallel_deinit(void);
-	//void ili_platform_parallel_send8(uint8_t byte);
-/* ------------------------------------- */
+#ifdef ILI_PLATFORM_SPI_ASYNC
+	/* Only needed when ILI_PLATFORM_SPI_ASYNC is defined */
+	void ili_platform_spi_send_buffer16_async(ili_bus_t *bus, uint16_t *buf, uint32_t items_count, void (*done_cb)(void *user_data), void *user_data);
+	void ili_platform_spi_wait_idle(ili_bus_t *bus);
+#endif /*ILI_PLATFORM_SPI_ASYNC*/
+#ifdef ILI_PLATFORM_SPI_READ
+	/* Only needed when ILI_PLATFORM_SPI_READ is defined */
+	void ili_platform_spi_read_cmd(ili_bus_t *bus, uint8_t cmd, uint8_t *buf, uint32_t n);
+#endif /*ILI_PLATFORM_SPI_READ*/
+#ifdef ILI_PLATFORM_TE
+	/* Only needed when ILI_PLATFORM_TE is defined */
+	void ili_platform_te_wait(ili_bus_t *bus);
+#endif /*ILI_PLATFORM_TE*/
 /* ==============[ End: Mandatory functions]============= */
 
+
+/* ====================================================== */
+/*     Optional inline functions used by ili9341.h/hpp    */
+/* ====================================================== */
+/*
+ * Single word writes to the TX FIFO, for the hot paths of the C++ front-end and the address
+ * window. Like the functions above, they leave the FIFO drained, so DC can change right after
+ */
+#define ILI_PLATFORM_SPI_INLINE
+
+/* Switch the SCB to 8 or 16-bit words */
+void ili_platform_spi_set_width(ili_bus_t *bus, uint8_t width);
+
+/* Whether the SCB is set to 16-bit words, as after pixel data */
+__attribute__((always_inline)) static inline uint8_t ili_platform_spi_is_16bit(ili_bus_t *bus)
+{
+	return (SCB_TX_CTRL(bus->scb) & 0xFUL) == 16UL - 1UL;
+}
+
+/* One 16-bit word, e.g. a pixel. DC is set by the caller */
+__attribute__((always_inline)) static inline void ili_platform_spi_send16(ili_bus_t *bus, uint16_t word)
+{
+	if (!ili_platform_spi_is_16bit(bus))
+		ili_platform_spi_set_width(bus, 16);
+	SCB_TX_FIFO_WR(bus->scb) = word;
+	while (!Cy_SCB_SPI_IsTxComplete(bus->scb));
+}
+
+/*
+ * ili_platform_spi_send_cmd() with its common case inlined: the SCB in 16-bit mode and up to 8
+ * parameters that pair up (CASET, PASET, RAMWR), which all fit in the FIFO at once
+ */
+__attribute__((always_inline)) static inline void ili_platform_spi_send_cmd_inline(ili_bus_t *bus, uint8_t cmd, const uint8_t *params, uint32_t n)
+{
+	if ((n & 1UL) || n > 8UL || !ili_platform_spi_is_16bit(bus))
+	{
+		ili_platform_spi_send_cmd(bus, cmd, params, n);
+		return;
+	}
+	ILI_PLATFORM_DC_LOW(bus);
+	SCB_TX_FIFO_WR(bus->scb) = (uint32_t)cmd;	/* 0x00 (NOP) in the upper byte */
+	while (!Cy_SCB_SPI_IsTxComplete(bus->scb));
+	if (n == 0)
+		return;
+
+	ILI_PLATFORM_DC_HIGH(bus);
+	for (uint32_t i = 0; i < n; i += 2)
+	{
+		SCB_TX_FIFO_WR(bus->scb) = ((uint32_t)params[i] << 8) | params[i + 1];
+	}
+	while (!Cy_SCB_SPI_IsTxComplete(bus->scb));
+}
+/* ===========[ End: Optional inline functions]========== */
+
+#ifdef __cplusplus
+}
+#endif
+
 #endif /*_PLATFORM_MTB_PSOC6_SPI_*/
@@ -0,0 +1,80 @@
+#include <ili9341.h>
+
+/*
+ * Both PSoC6 buses count TE pulses the same way. platform_mtb_psoc6_te.h is included by their
+ * headers only, so this is built when one of them is selected
+ */
+#if defined(_PLATFORM_MTB_PSOC6_TE_) && defined(ILI_PLATFORM_TE)
+
+/* Buses watched by the TE interrupt. Slot 0 is "none", a bus without a slot polls its pin */
+static ili_bus_t *g_te_bus[ILI_PLATFORM_MAX_TE_BUSES + 1];
+
+/*
+ * TE pulses are counted by the GPIO interrupt of the pin's port. The pins of a port share it,
+ * so one handler checks the pins of all the buses it watches
+ */
+static void _te_isr(void)
+{
+	for (uint8_t slot = 1; slot <= ILI_PLATFORM_MAX_TE_BUSES; slot++)
+	{
+		ili_bus_t *bus = g_te_bus[slot];
+		if (bus && Cy_GPIO_GetInterruptStatusMasked(bus->te_port, bus->te_num))
+		{
+			Cy_GPIO_ClearInterrupt(bus->te_port, bus->te_num);
+			bus->te_count++;
+		}
+	}
+}
+
+void ili_platform_te_init(ili_bus_t *bus)
+{
+	uint8_t slot;
+
+	Cy_GPIO_Pin_FastInit(bus->te_port, bus->te_num, CY_GPIO_DM_HIGHZ, 0, HSIOM_SEL_GPIO);
+	for (slot = 1; slot <= ILI_PLATFORM_MAX_TE_BUSES; slot++)
+	{
+		if (g_te_bus[slot] == NULL || g_te_bus[slot] == bus)
+			break;
+	}
+	if (slot > ILI_PLATFORM_MAX_TE_BUSES)
+	{
+		/* All entries are taken, this bus polls its pin */
+		bus->te_slot = 0;
+		return;
+	}
+	g_te_bus[slot] = bus;
+	bus->te_slot = slot;
+
+	cy_stc_sysint_t te_irq_config = {.intrSrc = bus->te_irq, .intrPriority = 3UL};
+	Cy_GPIO_SetInterruptEdge(bus->te_port, bus->te_num, CY_GPIO_INTR_RISING);
+	Cy_GPIO_ClearInterrupt(bus->te_port, bus->te_num);
+	Cy_GPIO_SetInterruptMask(bus->te_port, bus->te_num, 1UL);
+	Cy_SysInt_Init(&te_irq_config, _te_isr);
+	NVIC_EnableIRQ(bus->te_irq);
+}
+
+/* The port's interrupt stays enabled, other pins may use it */
+void ili_platform_te_deinit(ili_bus_t *bus)
+{
+	if (bus->te_slot)
+	{
+		Cy_GPIO_SetInterruptMask(bus->te_port, bus->te_num, 0UL);
+		g_te_bus[bus->te_slot] = NULL;
+		bus->te_slot = 0;
+	}
+}
+
+void ili_platform_te_wait(ili_bus_t *bus)
+{
+	if (bus->te_slot)
+	{
+		uint32_t count = bus->te_count;
+		while (bus->te_count == count);
+		return;
+	}
+	/* Next rising edge. The pulse lasts a line or more, a busy loop doesn't miss it */
+	while (Cy_GPIO_Read(bus->te_port, bus->te_num));
+	while (!Cy_GPIO_Read(bus->te_port, bus->te_num));
+}
+
+#endif /*_PLATFORM_MTB_PSOC6_TE_ && ILI_PLATFORM_TE*/
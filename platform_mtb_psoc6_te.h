@@ -0,0 +1,30 @@
+// NOTE: Only to be included by platform_mtb_psoc6_spi.h and platform_mtb_psoc6_parallel.h. User should NOT include it
+// ModusToolbox PSoC6 platform, tearing effect (TE) input. The same for the SPI and the parallel bus
+
+#ifndef _PLATFORM_MTB_PSOC6_TE_
+#define _PLATFORM_MTB_PSOC6_TE_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Tearing effect output of the panel. Only needed when ILI_PLATFORM_TE is defined.
+ * Any pin with a GPIO interrupt, the interrupt of its port is shared with the port's other pins */
+#define DISP_TE_PORT         P5_0_PORT
+#define DISP_TE_NUM          P5_6_NUM	/* D6 */
+#define DISP_TE_IRQ          ioss_interrupts_gpio_5_IRQn
+
+/* Number of buses whose TE pin is watched by the GPIO interrupt. The pin of any other bus is polled */
+#define ILI_PLATFORM_MAX_TE_BUSES       2
+
+#ifdef ILI_PLATFORM_TE
+/* Called by the bus init/deinit of the platform: TE pin and its interrupt slot */
+void ili_platform_te_init(ili_bus_t *bus);
+void ili_platform_te_deinit(ili_bus_t *bus);
+#endif /*ILI_PLATFORM_TE*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*_PLATFORM_MTB_PSOC6_TE_*/
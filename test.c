@@ -1,37 +1,192 @@
-#include "cyhal.h"
-#include "cybsp.h"
-#include "cy_retarget_io.h"
 #include "ili9341.h"
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "test_ui_panel.h"
+#include "test_ui_panel_4bpp.h"
+
+#if defined(ILI_PLATFORM_HOST_SIM)
+	#include <time.h>
+	#include <pthread.h>
+#else
+	#include "cyhal.h"
+	#include "cybsp.h"
+	#include "cy_retarget_io.h"
+#endif
 
 /*******************************************************************************
 * Macros
 *******************************************************************************/
 #define SYSTICK_MAX_CNT			(1 << 24) - 1		// max value for 24-bit reload register
 #define BUF_ROWS	320
+#define BENCH_STRIP_MAX_ROWS	32
+#define BENCH_DL_MAX_OPS		256
+#define BENCH_TEXT_CACHE_PX		(8 * 64 * 20)
+#define BENCH_ICON_SIZE			48
+#define BENCH_CAM_ROWS			32
+
+/* Every benchmark re-seeds the generator, so workloads are identical between runs and builds */
+#define BENCH_SEED				0x1234ABCDUL
+/* Work of each panel in the two panel benchmark */
+#define BENCH_PANEL_FRAMES		10
+/* Full frames per run of the vsync benchmark, and the line the tearing effect pulse comes at */
+#define BENCH_VSYNC_FRAMES		10
+#define BENCH_TE_LINE			8
+#define BENCH_PANEL_RECTS		500
+/* Random spans of the kernel equivalence checks (host only) */
+#define BENCH_CHECK_SPANS		20000
+#define BENCH_CHECK_MAX_W		70
+
+/*
+ * Bus cost model used for the estimated bus time (host only).
+ * Wire time is the bits on MOSI at ILI_SPI_FREQ, plus the bits read on MISO at ILI_SPI_READ_FREQ.
+ * On top of it, every blocking wait for the TX FIFO to drain and every 8 <-> 16 bit SCB
+ * reconfiguration costs some time during which the clock is idle. A read reconfigures the SCB
+ * twice, to read settings and back. Rough values for PSoC6 at 40MHz, tune them against a
+ * scope if needed.
+ */
+#define BENCH_DRAIN_COST_NS		150
+#define BENCH_WIDTH_SW_COST_NS	200
+
+/*
+ * Same for the 8-bit parallel bus (ILI_SIM_BUS_PARALLEL8). The CPU drives it with GPIO register
+ * stores: a byte is a data port store plus WR low and high, a repeated byte only the WR strobe,
+ * a DC change one store. A byte takes at least the panel's write cycle (ILI_SIM_WR_CYCLE_NS).
+ * Rough value for PSoC6 at 100MHz
+ */
+#define BENCH_GPIO_STORE_NS		30
+#define BENCH_PAR_BYTE_NS(stores)	(((stores) * BENCH_GPIO_STORE_NS > ILI_SIM_WR_CYCLE_NS) ? \
+									 (stores) * BENCH_GPIO_STORE_NS : ILI_SIM_WR_CYCLE_NS)
+
 /*******************************************************************************
 * Function Prototypes
 *******************************************************************************/
-static void isr_systick(void);
 uint32_t get_micros(void);
 uint32_t get_millis(void);
 uint16_t generate_color(uint32_t x, uint32_t y, uint32_t w, uint32_t h);
+#if !defined(ILI_PLATFORM_HOST_SIM)
+static void isr_systick(void);
 static inline __attribute__((always_inline)) uint32_t get_ticks(void);
+#endif
+
+static uint32_t bench_rand(void);
+static uint16_t bench_rand_range(uint16_t min, uint16_t max);
+static void bench_begin(void);
+static void bench_end(const char *name, uint32_t ops);
+
+static void bench_fill_rect(void);
+static void bench_line_thin(void);
+static void bench_line_thick(void);
+static void bench_line_diagonal(void);
+static void bench_polyline(void);
+static void bench_polyline_thick(void);
+static void bench_pixel(void);
+static void bench_rectangle(void);
+static void bench_circle_by_pixels(void);
+static void bench_circle_outline(void);
+static void bench_shapes_filled(void);
+static void bench_needle(uint8_t filled);
+static void bench_pixels_buffer(void);
+static void bench_full_frame(void);
+static void bench_full_frame_async(void);
+static void bench_clear(uint16_t color);
+static void bench_async_done(void *user_data);
+static void bench_fb_widgets(void);
+static void bench_strips(void);
+static void bench_display_list(void);
+static void bench_settings_screen(void);
+static void bench_strip_render(uint16_t *strip, uint16_t y, uint16_t h, void *user_data);
+static void bench_font_init(void);
+static void bench_text(uint8_t mode);
+static void bench_image(uint8_t mode);
+static void bench_console(uint8_t scroll);
+static void bench_low_power(void);
+static void bench_boot(void);
+static void bench_move(uint8_t copy);
+static void bench_icon_init(void);
+static void bench_blend(uint8_t kernel);
+static void bench_convert(uint8_t mode);
+#if defined(ILI_PLATFORM_HOST_SIM)
+static void check_blend(void);
+static void check_convert(void);
+static void check_after_command(void);
+#endif
+#if defined(ILI_PLATFORM_TE)
+static void bench_vsync(void);
+#endif
+#if defined(ILI_PLATFORM_HOST_SIM)
+static void bench_two_panels(void);
+static void *bench_panel_worker(void *arg);
+static void bench_panel_frame_done(void *user_data);
+#endif
+#if defined(ILI_BENCH_CPP)
+/* C++ front-end benchmark, in test_hpp.cpp */
+void bench_cpp(void);
+#endif
+
 /*******************************************************************************
 * Global Variables
 *******************************************************************************/
+#if !defined(ILI_PLATFORM_HOST_SIM)
 volatile uint32_t systick_wrap = 0;	// SysTick wraps every 1s (NOTE: uint64_t not supported!!)
-cyhal_spi_t mSPI;
+#endif
 uint16_t disp_buf[BUF_ROWS*240] = {0};
+/* Two strip buffers for ili_render_strips(), enough for the tallest strip benchmarked */
+uint16_t strip_buf[2][BENCH_STRIP_MAX_ROWS*240];
+/* Display list storage for the recorded screen */
+ili_dl_op_t dl_ops[2][BENCH_DL_MAX_OPS];
+/* Label cache pool of the text benchmark */
+uint16_t text_cache[BENCH_TEXT_CACHE_PX];
+/* RGB888 camera frame of the conversion benchmark */
+uint8_t cam_frame[BENCH_CAM_ROWS * 240 * 3];
+
+/*
+ * Seven segment font ' ' to '9' (digits, '-' and '.'), 4bpp with soft edges, made by bench_font_init().
+ * Real fonts come from tools/ili_fontconvert.py
+ */
+#define BENCH_FONT_FIRST		' '
+#define BENCH_FONT_LAST			'9'
+#define BENCH_FONT_W			12
+#define BENCH_FONT_H			20
+static uint8_t g_bench_font_bitmap[10 + 1][BENCH_FONT_W * BENCH_FONT_H / 2];
+static ili_glyph_t g_bench_font_glyphs[BENCH_FONT_LAST - BENCH_FONT_FIRST + 1];
+static ili_font_t g_bench_font;
+
+/* Round icon with anti-aliased edges, as RGB565 and an alpha map, made by bench_icon_init() */
+static uint16_t g_bench_icon[BENCH_ICON_SIZE * BENCH_ICON_SIZE];
+static uint8_t g_bench_icon_alpha[BENCH_ICON_SIZE * BENCH_ICON_SIZE];
+
+static uint32_t g_bench_rand_state;
+static uint32_t g_bench_start_us;
+static uint16_t g_bench_w, g_bench_h;
+
+#if defined(ILI_PLATFORM_HOST_SIM)
+/* Failed kernel equivalence checks, the exit code */
+static uint32_t g_check_failures;
+/* Second panel of the two panel benchmark, on a bus of its own */
+static ili_bus_t g_bench_bus2 = ILI_SIM_BUS_INIT;
+static ili_dev_t g_bench_dev2;
+
+typedef struct
+{
+	ili_dev_t *dev;
+	volatile uint32_t frames_left;
+} bench_panel_t;
+#endif
 
 /*******************************************************************************
 * Function Name: main
 *******************************************************************************/
 int main(void)
 {
+#if defined(ILI_PLATFORM_HOST_SIM)
+	ili_sim_reset();
+#else
     cy_rslt_t result;
 
     /* Initialize the device and board peripherals */
     result = cybsp_init();
+    (void)result;
 
     /* Enable global interrupts */
     __enable_irq();
@@ -52,81 +207,1288 @@ int main(void)
     /* \x1b[2J\x1b[;H - ANSI ESC sequence for clear screen */
     printf("\x1b[2J\x1b[;H");
 
-    printf("****************** "
-           "ILI9341 Test! "
-           "****************** \r\n\n");
-
-
     // CLK_TIMER set to 1MHz using device configurator
     // Interrupt fires after systick counter reached the end
     // Note: Device Configurator shows wrong freq for CLK_TIMER.
     // Actual freq of CLK_TIMER = Source Clk / Divider
     Cy_SysTick_Init(CY_SYSTICK_CLOCK_SOURCE_CLK_TIMER, SYSTICK_MAX_CNT);
     Cy_SysTick_SetCallback(0, isr_systick);
+#endif
 
+    printf("****************** "
+           "ILI9341 Test! "
+           "****************** \r\n\n");
 
     ili_bus_init();
-    cyhal_system_delay_ms(10);
+    ili_platform_delay(10);
     ili_init();
 	ili_fill_screen(0xff80);
 
-	uint16_t w = 0, h = 0;
 	uint8_t r = 0;
-	ili_get_display_size(&w, &h, &r);
-
-	uint32_t frames = 200;
-	uint32_t i_max = frames/10;
-	uint32_t len = w * h;
-
+	ili_get_display_size(&g_bench_w, &g_bench_h, &r);
+	bench_font_init();
+	bench_icon_init();
 
 	// Loop to fill the display buffer with color gradient
-	for (uint32_t y = 0; y < h; y++)
+	for (uint32_t y = 0; y < g_bench_h; y++)
 	{
-		for (uint32_t x = 0; x < w; x++)
+		for (uint32_t x = 0; x < g_bench_w; x++)
 		{
 			// Calculate RGB565 color based on position
-			uint16_t color = generate_color(x, y, (uint32_t)w, (uint32_t)h);
+			uint16_t color = generate_color(x, y, (uint32_t)g_bench_w, (uint32_t)g_bench_h);
 			// Set the color in the display buffer
-			disp_buf[y * w + x] = color;
+			disp_buf[y * g_bench_w + x] = color;
 		}
 	}
 
-	/* Sets the area where pixels will be drawn */
-	ili_set_address_window(0, 0, w, h);
-
+#if defined(ILI_PLATFORM_HOST_SIM)
+#if defined(ILI_BUS_TYPE_PARALLEL8)
+	printf("Bus model: 8-bit parallel, write cycle %d ns, GPIO store %d ns\r\n\n",
+			ILI_SIM_WR_CYCLE_NS, BENCH_GPIO_STORE_NS);
+#else
+	printf("Bus model: %lu Hz, drain %d ns, width switch %d ns\r\n\n",
+			(unsigned long)ILI_SPI_FREQ, BENCH_DRAIN_COST_NS, BENCH_WIDTH_SW_COST_NS);
+#endif
+	printf("%-16s %7s %8s %10s %8s %7s %8s %9s %9s\r\n",
+			"benchmark", "ops", "cmds", "data", "dc_tog", "w_sw", "drains", "wire_ms", "bus_ms");
+#else
 	cyhal_gpio_write(CYBSP_USER_LED, CYBSP_LED_STATE_ON);
-	uint32_t start = get_millis();
+	printf("%-16s %7s %9s %9s\r\n", "benchmark", "ops", "time_ms", "us/op");
+#endif
+
+	bench_fill_rect();
+	bench_line_thin();
+	bench_line_thick();
+	bench_line_diagonal();
+	bench_polyline();
+	bench_polyline_thick();
+	bench_pixel();
+	bench_rectangle();
+	bench_circle_by_pixels();
+	bench_circle_outline();
+	bench_shapes_filled();
+	bench_needle(0);
+	bench_needle(1);
+	bench_text(0);
+	bench_text(1);
+	bench_text(2);
+	bench_pixels_buffer();
+	bench_full_frame();
+	bench_full_frame_async();
+	bench_clear(0x0000);
+	bench_clear(0x001F);
+	bench_fb_widgets();
+	bench_strips();
+	bench_display_list();
+	bench_image(0);
+	bench_image(1);
+	bench_image(2);
+	bench_blend(0);
+	bench_blend(1);
+#if defined(ILI_PLATFORM_HOST_SIM)
+	check_blend();
+#endif
+	bench_convert(0);
+	bench_convert(1);
+	bench_convert(2);
+#if defined(ILI_PLATFORM_HOST_SIM)
+	check_convert();
+#endif
+	bench_console(0);
+	bench_console(1);
+	bench_move(0);
+#if defined(ILI_PLATFORM_SPI_READ)
+	bench_move(1);
+#endif
+	bench_low_power();
+
+#if defined(ILI_PLATFORM_HOST_SIM)
+	printf("\r\nChecksum : %08lx\r\n", (unsigned long)ili_sim_checksum());
+	ili_sim_dump_ppm("test_output.ppm");
+#endif
+	bench_boot();
+#if defined(ILI_PLATFORM_TE)
+	bench_vsync();
+#endif
+#if defined(ILI_PLATFORM_HOST_SIM)
+	check_after_command();
+	bench_two_panels();
+#else
+    cyhal_gpio_write(CYBSP_USER_LED, CYBSP_LED_STATE_OFF);
+#endif
+#if defined(ILI_BENCH_CPP)
+	bench_cpp();
+#endif
+    printf("\r\n");
+#if defined(ILI_PLATFORM_HOST_SIM)
+    return g_check_failures ? 1 : 0;
+#else
+    return 0;
+#endif
+}
 
-	// Drawing 200 frames. Loop is unrolled for faster execution
-    for (int i = 0; i < i_max; ++i)
-    {
-    	/* Now passing the buffer. Area is already set*/
 
-    	ili_draw_pixels_buffer(disp_buf, len);
-    	ili_draw_pixels_buffer(disp_buf, len);
-    	ili_draw_pixels_buffer(disp_buf, len);
-    	ili_draw_pixels_buffer(disp_buf, len);
-    	ili_draw_pixels_buffer(disp_buf, len);
+/* Random rectangles anywhere on the screen. Some of them are clipped by the bound check */
+static void bench_fill_rect(void)
+{
+	uint32_t ops = 200;
+	bench_begin();
+	for (uint32_t i = 0; i < ops; i++)
+	{
+		uint16_t x = bench_rand_range(0, g_bench_w - 1);
+		uint16_t y = bench_rand_range(0, g_bench_h - 1);
+		uint16_t w = bench_rand_range(1, 80);
+		uint16_t h = bench_rand_range(1, 80);
+		ili_fill_rect(x, y, w, h, (uint16_t)bench_rand());
+	}
+	bench_end("fill_rect", ops);
+}
 
-    	ili_draw_pixels_buffer(disp_buf, len);
-		ili_draw_pixels_buffer(disp_buf, len);
-		ili_draw_pixels_buffer(disp_buf, len);
-		ili_draw_pixels_buffer(disp_buf, len);
+static void bench_line_thin(void)
+{
+	uint32_t ops = 200;
+	bench_begin();
+	for (uint32_t i = 0; i < ops; i++)
+	{
+		ili_draw_line(bench_rand_range(0, g_bench_w - 1), bench_rand_range(0, g_bench_h - 1),
+					  bench_rand_range(0, g_bench_w - 1), bench_rand_range(0, g_bench_h - 1),
+					  1, (uint16_t)bench_rand());
+	}
+	bench_end("line_thin", ops);
+}
+
+static void bench_line_thick(void)
+{
+	uint32_t ops = 200;
+	bench_begin();
+	for (uint32_t i = 0; i < ops; i++)
+	{
+		uint8_t width = bench_rand_range(2, 6);
+		ili_draw_line(bench_rand_range(0, g_bench_w - width), bench_rand_range(0, g_bench_h - width),
+					  bench_rand_range(0, g_bench_w - width), bench_rand_range(0, g_bench_h - width),
+					  width, (uint16_t)bench_rand());
+	}
+	bench_end("line_thick", ops);
+}
+
+/* 45 degree lines, the worst case for the per-pixel address window */
+static void bench_line_diagonal(void)
+{
+	uint32_t ops = 200;
+	bench_begin();
+	for (uint32_t i = 0; i < ops; i++)
+	{
+		uint16_t len = bench_rand_range(10, g_bench_w / 2);
+		uint16_t x0 = bench_rand_range(0, g_bench_w - 1 - len);
+		uint16_t y0 = bench_rand_range(0, g_bench_h - 1 - len);
+		if (bench_rand() & 1)
+			ili_draw_line(x0, y0, x0 + len, y0 + len, 1, (uint16_t)bench_rand());
+		else
+			ili_draw_line(x0, y0 + len, x0 + len, y0, 1, (uint16_t)bench_rand());
+	}
+	bench_end("line_diagonal", ops);
+}
+
+/* Random walk charts spanning the screen width, the typical trend plot */
+static void bench_polyline(void)
+{
+	uint32_t ops = 20;
+	ili_point_t points[61];
+	bench_begin();
+	for (uint32_t i = 0; i < ops; i++)
+	{
+		uint16_t y = bench_rand_range(20, g_bench_h - 21);
+		for (uint16_t k = 0; k < 61; k++)
+		{
+			points[k].x = (uint16_t)((uint32_t)k * (g_bench_w - 1) / 60);
+			y = y + bench_rand_range(0, 40) - 20;
+			y = (y < 20) ? 20 : (y > g_bench_h - 21) ? g_bench_h - 21 : y;
+			points[k].y = y;
+		}
+		ili_draw_polyline(points, 61, 1, (uint16_t)bench_rand());
+	}
+	bench_end("polyline", ops);
+}
+
+/* Same charts drawn thick, once with each join and cap style */
+static void bench_polyline_thick(void)
+{
+	uint32_t ops = 20;
+	ili_point_t points[61];
+	bench_begin();
+	for (uint32_t i = 0; i < ops; i++)
+	{
+		uint16_t y = bench_rand_range(20, g_bench_h - 21);
+		for (uint16_t k = 0; k < 61; k++)
+		{
+			points[k].x = (uint16_t)((uint32_t)k * (g_bench_w - 1) / 60);
+			y = y + bench_rand_range(0, 40) - 20;
+			y = (y < 20) ? 20 : (y > g_bench_h - 21) ? g_bench_h - 21 : y;
+			points[k].y = y;
+		}
+		ili_draw_polyline_ex(points, 61, 5, (uint16_t)bench_rand(), i % 3, i & 1);
+	}
+	bench_end("polyline_thick", ops);
+}
+
+static void bench_pixel(void)
+{
+	uint32_t ops = 5000;
+	bench_begin();
+	for (uint32_t i = 0; i < ops; i++)
+	{
+		ili_draw_pixel(bench_rand_range(0, g_bench_w - 1), bench_rand_range(0, g_bench_h - 1), (uint16_t)bench_rand());
+	}
+	bench_end("pixel", ops);
+}
+
+/*
+ * Full screen clears. On the parallel bus black (high byte == low byte) is put on the port once
+ * and then only WR is strobed, blue needs both bytes for every pixel. On SPI both cost the same
+ */
+static void bench_clear(uint16_t color)
+{
+	uint32_t ops = 10;
+	bench_begin();
+	for (uint32_t i = 0; i < ops; i++)
+	{
+		ili_fill_screen(color);
+	}
+	bench_end(color ? "clear_blue" : "clear_black", ops);
+}
+
+/*
+ * Dashboard updates drawn into a full screen framebuffer (the gradient in disp_buf) and flushed
+ * once per frame. Only the bars, the counter box and the sparkline dots that changed are sent.
+ */
+static void bench_fb_widgets(void)
+{
+	uint32_t ops = 100;
+	uint16_t bar_w = g_bench_w / 2;
+	bench_begin();
+	ili_fb_attach(disp_buf, 0, 0, g_bench_w, g_bench_h);
+	for (uint32_t i = 0; i < ops; i++)
+	{
+		for (uint16_t bar = 0; bar < 4; bar++)
+		{
+			uint16_t value = bench_rand_range(0, bar_w);
+			uint16_t y = 20 + bar * 16;
+			ili_fill_rect(10, y, bar_w, 8, 0x0000);
+			ili_fill_rect(10, y, value, 8, 0x07E0);
+		}
+		ili_fill_rect(g_bench_w - 60, 20, 48, 16, (uint16_t)bench_rand());
+		for (uint16_t k = 0; k < 3; k++)
+			ili_draw_pixel(bench_rand_range(10, g_bench_w - 10), bench_rand_range(100, g_bench_h - 10), 0xFFFF);
+		ili_flush();
+	}
+	ili_fb_detach();
+	bench_end("fb_widgets", ops);
+}
+
+/*
+ * Full frames rendered in strips: the gradient computed per pixel plus a few widgets drawn with
+ * ili_* calls, for several strip heights. Small strips need little RAM but pay the per strip
+ * overhead and run the widgets once per strip. The wall time shows where it stops paying off.
+ */
+static void bench_strips(void)
+{
+	static const uint16_t heights[] = {1, 2, 4, 8, 16, BENCH_STRIP_MAX_ROWS};
+	uint32_t frames = 5;
+
+	for (uint8_t i = 0; i < sizeof(heights) / sizeof(heights[0]); i++)
+	{
+		char name[20];
+		snprintf(name, sizeof(name), "strips_%u", heights[i]);
+		bench_begin();
+		for (uint32_t f = 0; f < frames; f++)
+			ili_render_strips(strip_buf[0], strip_buf[1], heights[i], bench_strip_render, NULL);
+		uint32_t wall_us = get_micros() - g_bench_start_us;
+		bench_end(name, frames);
+		printf("%-16s %lu B of buffers, %.1f FPS\r\n", "", (unsigned long)(2UL * heights[i] * g_bench_w * sizeof(uint16_t)),
+				(float)frames * 1e6f / (float)wall_us);
+	}
+}
+
+static void bench_strip_render(uint16_t *strip, uint16_t y, uint16_t h, void *user_data)
+{
+	(void)user_data;
+	for (uint16_t row = 0; row < h; row++)
+	{
+		for (uint16_t x = 0; x < g_bench_w; x++)
+			*strip++ = generate_color(x, y + row, (uint32_t)g_bench_w, (uint32_t)g_bench_h);
+	}
+	// Widgets on top, clipped to the strip
+	ili_fill_rect(10, 10, g_bench_w - 20, 30, 0x0000);
+	ili_fill_rect(12, 12, g_bench_w / 3, 26, 0x07E0);
+	ili_draw_rectangle(20, g_bench_h / 2, g_bench_w - 40, 60, 0xFFFF);
+	ili_draw_line(0, g_bench_h - 1, g_bench_w - 1, g_bench_h / 2, 3, 0xF800);
+}
+
+/*
+ * A static settings screen recorded once and replayed as recorded and optimized,
+ * like a redraw after wake-up.
+ */
+static void bench_display_list(void)
+{
+	uint32_t frames = 20;
+	ili_dl_t raw = {dl_ops[0], BENCH_DL_MAX_OPS, 0, 0};
+	ili_dl_t opt = {dl_ops[1], BENCH_DL_MAX_OPS, 0, 0};
+
+	ili_dl_begin(&raw);
+	bench_settings_screen();
+	ili_dl_end();
+	for (uint16_t i = 0; i < raw.count; i++)
+		opt.ops[i] = raw.ops[i];
+	opt.count = raw.count;
+	ili_dl_optimize(&opt);
+
+	bench_begin();
+	for (uint32_t i = 0; i < frames; i++)
+		ili_dl_replay(&raw);
+	bench_end("dl_replay_raw", frames);
+
+	bench_begin();
+	for (uint32_t i = 0; i < frames; i++)
+		ili_dl_replay(&opt);
+	bench_end("dl_replay_opt", frames);
+	printf("%-16s %u ops recorded, %u after optimizing%s\r\n", "", raw.count, opt.count, raw.overflow ? " (overflow)" : "");
+}
+
+static void bench_settings_screen(void)
+{
+	uint16_t row_h = 32;
+
+	ili_fill_screen(0x0000);
+	ili_fill_rect(0, 0, g_bench_w, 30, 0x001F);
+	for (uint16_t row = 0; row < 8; row++)
+	{
+		uint16_t y = 40 + row * row_h;
+		// Row background drawn as two halves, the way widget code often ends up doing it
+		ili_fill_rect(0, y, g_bench_w / 2, row_h - 1, 0x2104);
+		ili_fill_rect(g_bench_w / 2, y, g_bench_w - g_bench_w / 2, row_h - 1, 0x2104);
+		ili_draw_line(0, y + row_h - 1, g_bench_w - 1, y + row_h - 1, 1, 0x4208);
+		ili_draw_bitmap(8, y + 8, 16, 16, disp_buf);
+		ili_draw_rectangle(g_bench_w - 28, y + 8, 16, 16, 0xFFFF);
+		if (row & 1)
+			ili_fill_rect(g_bench_w - 26, y + 10, 13, 13, 0x07E0);
+	}
+	// Selection highlight painted over the second row
+	ili_fill_rect(0, 40 + row_h, g_bench_w, row_h - 1, 0x001F);
+}
+
+/* Circle outlines plotted with ili_draw_pixel(), the way they were drawn before ili_draw_circle() */
+static void bench_circle_by_pixels(void)
+{
+	uint32_t ops = 100;
+	bench_begin();
+	for (uint32_t i = 0; i < ops; i++)
+	{
+		int32_t r = bench_rand_range(5, 60);
+		int32_t cx = bench_rand_range(r, g_bench_w - 1 - r);
+		int32_t cy = bench_rand_range(r, g_bench_h - 1 - r);
+		uint16_t color = (uint16_t)bench_rand();
+		int32_t x = r, y = 0, err = 1 - r;
+		while (x >= y)
+		{
+			ili_draw_pixel(cx + x, cy + y, color); ili_draw_pixel(cx - x, cy + y, color);
+			ili_draw_pixel(cx + x, cy - y, color); ili_draw_pixel(cx - x, cy - y, color);
+			ili_draw_pixel(cx + y, cy + x, color); ili_draw_pixel(cx - y, cy + x, color);
+			ili_draw_pixel(cx + y, cy - x, color); ili_draw_pixel(cx - y, cy - x, color);
+			y++;
+			if (err < 0)
+				err += 2 * y + 1;
+			else
+			{
+				x--;
+				err += 2 * (y - x) + 1;
+			}
+		}
+	}
+	bench_end("circle_by_pixel", ops);
+}
+
+/* Same circles with ili_draw_circle() */
+static void bench_circle_outline(void)
+{
+	uint32_t ops = 100;
+	bench_begin();
+	for (uint32_t i = 0; i < ops; i++)
+	{
+		uint16_t r = bench_rand_range(5, 60);
+		uint16_t cx = bench_rand_range(r, g_bench_w - 1 - r);
+		uint16_t cy = bench_rand_range(r, g_bench_h - 1 - r);
+		ili_draw_circle(cx, cy, r, (uint16_t)bench_rand());
+	}
+	bench_end("circle_outline", ops);
+}
+
+/* Gauges and buttons: filled circles, 270 degree arcs and rounded rectangles, partly off screen */
+static void bench_shapes_filled(void)
+{
+	uint32_t ops = 100;
+	bench_begin();
+	for (uint32_t i = 0; i < ops; i++)
+	{
+		uint16_t r = bench_rand_range(5, 60);
+		uint16_t x = bench_rand_range(0, g_bench_w - 1);
+		uint16_t y = bench_rand_range(0, g_bench_h - 1);
+		switch (i % 3)
+		{
+			case 0:
+				ili_fill_circle(x, y, r, (uint16_t)bench_rand());
+				break;
+			case 1:
+				ili_fill_arc(x, y, r, r * 3 / 4, 135, 135 + bench_rand_range(0, 270), (uint16_t)bench_rand());
+				break;
+			default:
+				ili_fill_round_rect(x, y, r * 2, r, r / 3, (uint16_t)bench_rand());
+				break;
+		}
+	}
+	bench_end("shapes_filled", ops);
+}
+
+/*
+ * Gauge needles: 9 px wide at the pivot, up to the tip. Either composed from one ili_draw_line()
+ * per base pixel, the way they were drawn before ili_fill_triangle(), or as filled triangles
+ */
+static void bench_needle(uint8_t filled)
+{
+	uint32_t ops = 100;
+	bench_begin();
+	for (uint32_t i = 0; i < ops; i++)
+	{
+		int32_t cx = bench_rand_range(20, g_bench_w - 21);
+		int32_t cy = bench_rand_range(20, g_bench_h - 21);
+		int32_t tx = bench_rand_range(0, g_bench_w - 1);
+		int32_t ty = bench_rand_range(0, g_bench_h - 1);
+		uint16_t color = (uint16_t)bench_rand();
+		int32_t dx = tx - cx, dy = ty - cy;
+		// Base across the needle's dominant direction
+		uint8_t vert_base = (dx < 0 ? -dx : dx) > (dy < 0 ? -dy : dy);
+		int32_t bx = vert_base ? 0 : 4;
+		int32_t by = vert_base ? 4 : 0;
+		if (filled)
+			ili_fill_triangle(cx - bx, cy - by, cx + bx, cy + by, tx, ty, color);
+		else
+		{
+			for (int32_t k = -4; k <= 4; k++)
+				ili_draw_line(cx + (vert_base ? 0 : k), cy + (vert_base ? k : 0), tx, ty, 1, color);
+		}
+	}
+	bench_end(filled ? "needle_filled" : "needle_by_lines", ops);
+}
+
+/* Segments a to g of each glyph (bit 0 is a), as rectangles x, y, w, h on the 12x20 cell */
+static const uint8_t g_bench_segments[7][4] = {
+	{2, 0, 8, 2}, {10, 2, 2, 7}, {10, 11, 2, 7}, {2, 18, 8, 2}, {0, 11, 2, 7}, {0, 2, 2, 7}, {2, 9, 8, 2}
+};
+
+static void bench_font_init(void)
+{
+	static const uint8_t digits[10] = {0x3F, 0x06, 0x5B, 0x4F, 0x66, 0x6D, 0x7D, 0x07, 0x7F, 0x6F};
+	for (uint8_t d = 0; d <= 10; d++)
+	{
+		uint8_t segs = (d < 10) ? digits[d] : 0x40;		// 10 is '-'
+		uint8_t *bm = g_bench_font_bitmap[d];
+		for (int32_t y = 0; y < BENCH_FONT_H; y++)
+		{
+			for (int32_t x = 0; x < BENCH_FONT_W; x++)
+			{
+				// Full coverage inside a segment, a soft level next to one
+				uint8_t a = 0;
+				for (uint8_t k = 0; k < 7; k++)
+				{
+					const uint8_t *sg = g_bench_segments[k];
+					if (!(segs & (1 << k)))
+						continue;
+					int32_t dx = (x < sg[0]) ? sg[0] - x : (x >= sg[0] + sg[2]) ? x - (sg[0] + sg[2] - 1) : 0;
+					int32_t dy = (y < sg[1]) ? sg[1] - y : (y >= sg[1] + sg[3]) ? y - (sg[1] + sg[3] - 1) : 0;
+					if (dx == 0 && dy == 0)
+						a = 15;
+					else if (dx + dy == 1 && a < 5)
+						a = 5;
+				}
+				uint32_t i = (uint32_t)y * BENCH_FONT_W + x;
+				bm[i >> 1] |= (i & 1) ? a : (uint8_t)(a << 4);
+			}
+		}
+	}
+
+	for (uint8_t c = BENCH_FONT_FIRST; c <= BENCH_FONT_LAST; c++)
+	{
+		ili_glyph_t *g = &g_bench_font_glyphs[c - BENCH_FONT_FIRST];
+		int32_t d = (c >= '0') ? c - '0' : (c == '-') ? 10 : -1;
+		if (d >= 0)
+		{
+			g->bitmap_offset = (uint32_t)d * sizeof(g_bench_font_bitmap[0]);
+			g->width = BENCH_FONT_W;
+			g->height = BENCH_FONT_H;
+			g->x_offset = 2;
+		}
+		else if (c == '.')
+		{
+			// Bottom right corner of '8' is a 2x2 block
+			g->bitmap_offset = 8 * sizeof(g_bench_font_bitmap[0]) + (18 * BENCH_FONT_W + 10) / 2;
+			g->width = 2;
+			g->height = 2;
+			g->x_offset = 1;
+			g->y_offset = BENCH_FONT_H - 2;
+		}
+		g->x_advance = (c == '.') ? 4 : (d >= 0) ? BENCH_FONT_W + 4 : 8;
+	}
+	g_bench_font.bitmap = &g_bench_font_bitmap[0][0];
+	g_bench_font.glyphs = g_bench_font_glyphs;
+	g_bench_font.first = BENCH_FONT_FIRST;
+	g_bench_font.last = BENCH_FONT_LAST;
+	g_bench_font.y_advance = BENCH_FONT_H + 4;
+	g_bench_font.bpp = 4;
+}
+
+/*
+ * Six numeric readouts slowly drifting around their set points, as on a dashboard.
+ * mode 0: background box plus ili_draw_pixel() per lit pixel, the way text was drawn before
+ * ili_draw_string(). mode 1: ili_draw_string(). mode 2: ili_draw_string() with the label cache
+ */
+static void bench_text(uint8_t mode)
+{
+	static const char *names[3] = {"text_by_pixel", "text_string", "text_cached"};
+	uint32_t ops = 300;
+	int32_t value[6] = {0};
+	char str[12];
+
+	if (mode == 2)
+		ili_text_cache_attach(text_cache, BENCH_TEXT_CACHE_PX);
+	bench_begin();
+	for (uint32_t i = 0; i < ops; i++)
+	{
+		uint8_t k = i % 6;
+		value[k] += (int32_t)bench_rand_range(0, 2) - 1;
+		value[k] = (value[k] < -3) ? -3 : (value[k] > 3) ? 3 : value[k];
+		int32_t v = 215 + value[k] * 5;
+		snprintf(str, sizeof(str), "%ld.%ld", (long)(v / 10), (long)(v % 10));
+		uint16_t x = 10 + (k & 1) * 120;
+		uint16_t y = 40 + (k >> 1) * 40;
+
+		if (mode != 0)
+		{
+			ili_draw_string(x, y, str, &g_bench_font, 0xFFE0, 0x0000);
+			continue;
+		}
+		ili_fill_rect(x, y, ili_text_width(str, &g_bench_font), g_bench_font.y_advance, 0x0000);
+		uint16_t cursor = x;
+		for (const char *c = str; *c; c++)
+		{
+			const ili_glyph_t *g = &g_bench_font.glyphs[*c - BENCH_FONT_FIRST];
+			const uint8_t *bm = &g_bench_font.bitmap[g->bitmap_offset];
+			for (uint16_t gy = 0; gy < g->height; gy++)
+			{
+				for (uint16_t gx = 0; gx < g->width; gx++)
+				{
+					uint32_t p = (uint32_t)gy * g->width + gx;
+					uint8_t a = (p & 1) ? (bm[p >> 1] & 0x0F) : (bm[p >> 1] >> 4);
+					if (a >= 8)
+						ili_draw_pixel(cursor + g->x_offset + gx, y + g->y_offset + gy, 0xFFE0);
+				}
+			}
+			cursor += g->x_advance;
+		}
+	}
+	bench_end(names[mode], ops);
+#if defined(ILI_PLATFORM_HOST_SIM)
+	printf("%-16s CPU busy for %lu us\r\n", "", (unsigned long)(get_micros() - g_bench_start_us));
+#endif
+	if (mode == 2)
+		ili_text_cache_detach();
+}
+
+/*
+ * The UI panel of test_ui_panel.h drawn at 20 places. mode 0: decoded once to RAM and sent with
+ * ili_draw_bitmap(). mode 1: streamed with ili_draw_image_rle(). mode 2: the 4 bpp version of
+ * test_ui_panel_4bpp.h with ili_draw_image_indexed(), every other one with an inverted palette
+ */
+static void bench_image(uint8_t mode)
+{
+	static const char *names[3] = {"image_raw", "image_rle", "image_4bpp"};
+	const ili_image_rle_t *img = &test_ui_panel;
+	uint16_t *raw = strip_buf[0];		// Free after the strip benchmarks
+	uint16_t inverted[16];
+	uint32_t ops = 20;
+	uint32_t flash = 0;
+
+	if (mode == 0)
+	{
+		uint32_t pos = 0;
+		for (uint32_t i = 0; i < img->length; )
+		{
+			uint16_t header = img->data[i++];
+			uint32_t n = (uint32_t)(header & ~ILI_RLE_RUN) + 1;
+			for (uint32_t k = 0; k < n; k++)
+				raw[pos++] = (header & ILI_RLE_RUN) ? img->data[i] : img->data[i + k];
+			i += (header & ILI_RLE_RUN) ? 1 : n;
+		}
+	}
+	for (uint8_t i = 0; i < 16; i++)
+		inverted[i] = ~test_ui_panel_4bpp.palette[i];
+
+	bench_begin();
+	for (uint32_t i = 0; i < ops; i++)
+	{
+		uint16_t x = bench_rand_range(0, g_bench_w - img->width);
+		uint16_t y = bench_rand_range(0, g_bench_h - img->height);
+		if (mode == 1)
+			ili_draw_image_rle(x, y, img);
+		else if (mode == 2)
+			ili_draw_image_indexed(x, y, &test_ui_panel_4bpp, (i & 1) ? inverted : NULL);
+		else
+			ili_draw_bitmap(x, y, img->width, img->height, raw);
+	}
+	bench_end(names[mode], ops);
+	if (mode == 1)
+		flash = img->length * sizeof(uint16_t);
+	else if (mode == 2)
+		flash = ((uint32_t)img->width * 4 + 7) / 8 * img->height + 16 * sizeof(uint16_t);
+	if (flash)
+		printf("%-16s %lu B of flash instead of %lu B\r\n", "", (unsigned long)flash,
+				(unsigned long)((uint32_t)img->width * img->height * sizeof(uint16_t)));
+}
+
+/*
+ * A log view printing 60 lines of readings. Either every new line redraws all the visible
+ * lines, the way the log view worked before, or ili_console_print() draws only the new one
+ */
+static void bench_console(uint8_t scroll)
+{
+	static char lines[16][24];		// Visible lines of the redrawn log, as a ring
+	ili_console_t con;
+	uint32_t ops = 60;
+	uint16_t lh = g_bench_font.y_advance;
+	uint16_t rows = (g_bench_h - 40) / lh;
+	rows = (rows > 16) ? 16 : rows;
+
+	ili_fill_screen(0x0000);
+	if (scroll)
+		ili_console_init(&con, &g_bench_font, 20, 20, 0x07E0, 0x0000);
+	bench_begin();
+	for (uint32_t i = 0; i < ops; i++)
+	{
+		char *str = lines[i % rows];
+		snprintf(str, sizeof(lines[0]), "%lu -%lu.%lu", (unsigned long)i, (unsigned long)(bench_rand() % 100), (unsigned long)(i % 10));
+		if (scroll)
+		{
+			ili_console_print(&con, str);
+			continue;
+		}
+		uint32_t first = (i + 1 > rows) ? i + 1 - rows : 0;
+		for (uint32_t k = first; k <= i; k++)
+		{
+			uint16_t y = 20 + (uint16_t)(k - first) * lh;
+			uint16_t w = ili_text_width(lines[k % rows], &g_bench_font);
+			ili_draw_string(0, y, lines[k % rows], &g_bench_font, 0x07E0, 0x0000);
+			ili_fill_rect(w, y, g_bench_w - w, lh, 0x0000);
+		}
+	}
+	bench_end(scroll ? "console_scroll" : "console_redraw", ops);
+	if (scroll)
+		ili_scroll_stop();
+}
+
+/*
+ * Static status screen: a band of 40 rows stays on in partial mode, 8 color idle mode, 10 Hz.
+ * Measures entering it and waking back to the full display. The panel switches modes on its
+ * next frame, so up to one frame period of the old mode adds to the numbers
+ */
+static void bench_low_power(void)
+{
+	ili_set_low_power_frame_rate(10);
+
+	bench_begin();
+	ili_partial_area(0, 39);
+	ili_idle_mode(1);
+	bench_end("low_power_enter", 1);
+
+	bench_begin();
+	ili_idle_mode(0);
+	ili_partial_off();
+	bench_end("low_power_wake", 1);
+	printf("%-16s + up to one frame: 10 ms entering from 100 Hz, 100 ms waking from 10 Hz\r\n", "");
+}
+
+/*
+ * Reset to the first frame on the display, as after waking from deep sleep. The frame is written
+ * while the panel's supplies settle after sleep out, the display is turned on once it is complete
+ */
+static void bench_boot(void)
+{
+	printf("\r\n");
+	bench_begin();
+	ili_init_seq(ILI_INIT_SEQ);
+	ili_set_address_window(0, 0, g_bench_w, g_bench_h);
+	ili_draw_pixels_buffer(disp_buf, (uint32_t)g_bench_w * g_bench_h);
+	ili_display_on(1);
+	bench_end("boot_to_frame", 1);
+#if defined(ILI_PLATFORM_HOST_SIM)
+	printf("%-16s + %lu ms of waits with ILI_RESET_WAIT_MS %d\r\n", "",
+			(unsigned long)ili_sim_get_stats()->delay_ms, ILI_RESET_WAIT_MS);
+#endif
+}
+
+/*
+ * The UI panel of test_ui_panel.h dragged 20 times by (2, 4) pixels. Either drawn again at its
+ * new place with ili_draw_image_rle(), or moved with ili_copy_rect(), which reads it back from
+ * the panel. The uncovered edges are cleared in both cases
+ */
+static void bench_move(uint8_t copy)
+{
+	const ili_image_rle_t *img = &test_ui_panel;
+	uint16_t x = 0;
+	uint16_t y = 0;
+	uint32_t ops = 20;
+
+	ili_fill_screen(0x0000);
+	ili_draw_image_rle(x, y, img);
+	bench_begin();
+	for (uint32_t i = 0; i < ops; i++)
+	{
+#if defined(ILI_PLATFORM_SPI_READ)
+		if (copy)
+			ili_copy_rect(x, y, img->width, img->height, x + 2, y + 4);
+		else
+#endif
+			ili_draw_image_rle(x + 2, y + 4, img);
+		ili_fill_rect(x, y, img->width, 4, 0x0000);
+		ili_fill_rect(x, y + 4, 2, img->height - 4, 0x0000);
+		x += 2;
+		y += 4;
+	}
+	bench_end(copy ? "move_copy" : "move_redraw", ops);
+#if defined(ILI_PLATFORM_HOST_SIM)
+	if (copy)
+		printf("%-16s %lu B read back at %lu Hz\r\n", "", (unsigned long)ili_sim_get_stats()->read_bytes,
+				(unsigned long)ILI_SPI_READ_FREQ);
+#endif
+}
+
+static void bench_icon_init(void)
+{
+	float c = (BENCH_ICON_SIZE - 1) / 2.0f;
+	float r = BENCH_ICON_SIZE / 2.0f - 1.0f;
+	for (uint16_t y = 0; y < BENCH_ICON_SIZE; y++)
+	{
+		for (uint16_t x = 0; x < BENCH_ICON_SIZE; x++)
+		{
+			// Coverage of the pixel by the disc, 1 pixel wide ramp at the edge
+			float cover = r - sqrtf((x - c) * (x - c) + (y - c) * (y - c)) + 0.5f;
+			cover = (cover < 0.0f) ? 0.0f : (cover > 1.0f) ? 1.0f : cover;
+			g_bench_icon_alpha[y * BENCH_ICON_SIZE + x] = (uint8_t)(cover * 255.0f + 0.5f);
+			g_bench_icon[y * BENCH_ICON_SIZE + x] = ILI_RGB((255 - x * 4), (64 + y * 3), 160);
+		}
+	}
+}
+
+/*
+ * A row of 4 anti-aliased icons blended into a 48 row strip of the gradient, then sent,
+ * 50 times. kernel 0: a loop over ili_blend_color() per pixel, the reference.
+ * kernel 1: ili_blend_bitmap_buffer(). Bus traffic is the same, the CPU time is the difference
+ */
+static void bench_blend(uint8_t kernel)
+{
+	uint16_t *strip = strip_buf[0];
+	uint32_t ops = 50;
+	uint32_t blend_us = 0;
+	uint32_t pixels = 0;
+
+	bench_begin();
+	for (uint32_t i = 0; i < ops; i++)
+	{
+		uint16_t y = bench_rand_range(0, g_bench_h - BENCH_ICON_SIZE);
+		memcpy(strip, &disp_buf[y * g_bench_w], (size_t)g_bench_w * BENCH_ICON_SIZE * sizeof(uint16_t));
+
+		uint32_t start_us = get_micros();
+		for (uint16_t k = 0; k < 4; k++)
+		{
+			uint16_t *dst = strip + 8 + k * (BENCH_ICON_SIZE + 8);
+			if (kernel)
+			{
+				ili_blend_bitmap_buffer(dst, g_bench_w, BENCH_ICON_SIZE, BENCH_ICON_SIZE, g_bench_icon, g_bench_icon_alpha);
+				continue;
+			}
+			for (uint16_t row = 0; row < BENCH_ICON_SIZE; row++)
+			{
+				for (uint16_t col = 0; col < BENCH_ICON_SIZE; col++)
+				{
+					uint32_t idx = row * BENCH_ICON_SIZE + col;
+					dst[row * g_bench_w + col] = ili_blend_color(g_bench_icon[idx], dst[row * g_bench_w + col], g_bench_icon_alpha[idx]);
+				}
+			}
+		}
+		blend_us += get_micros() - start_us;
+		pixels += 4 * BENCH_ICON_SIZE * BENCH_ICON_SIZE;
+
+		ili_draw_bitmap(0, y, g_bench_w, BENCH_ICON_SIZE, strip);
+	}
+	bench_end(kernel ? "blend_kernel" : "blend_ref", ops);
+	printf("%-16s CPU %lu us blending %lu px\r\n", "", (unsigned long)blend_us, (unsigned long)pixels);
+}
+
+#if defined(ILI_PLATFORM_HOST_SIM)
+/*
+ * ili_blend_fill_buffer() and ili_blend_bitmap_buffer() against ili_blend_color() per pixel, on
+ * random areas: odd widths, strides wider than the area, buffers and bitmaps off by one pixel
+ * from 32-bit alignment, alpha 0, 255 or random. Counts a failure if any pixel differs
+ */
+static void check_blend(void)
+{
+	uint16_t *buf = strip_buf[0];
+	uint16_t *ref = strip_buf[0] + 4096;
+	uint16_t *bitmap = strip_buf[1];
+	uint8_t *alpha = (uint8_t *)(strip_buf[1] + 4096);
+	uint32_t bad_px = 0;
+
+	g_bench_rand_state = BENCH_SEED;
+	for (uint32_t i = 0; i < BENCH_CHECK_SPANS; i++)
+	{
+		uint16_t w = bench_rand_range(1, BENCH_CHECK_MAX_W);
+		uint16_t h = bench_rand_range(1, 4);
+		uint32_t stride = w + ((i & 1) ? bench_rand_range(0, 5) : 0);
+		uint16_t *dst = buf + bench_rand_range(0, 1);
+		const uint16_t *src = bitmap + bench_rand_range(0, 1);
+		uint8_t mode = (uint8_t)bench_rand_range(0, 2);
+		uint16_t color = (uint16_t)bench_rand();
+		uint8_t fill_alpha = (mode == 0) ? 0 : (mode == 1) ? 255 : (uint8_t)bench_rand();
+
+		for (uint32_t k = 0; k < stride * h + 1; k++)
+		{
+			buf[k] = (uint16_t)bench_rand();
+			ref[k] = buf[k];
+			bitmap[k] = (uint16_t)bench_rand();
+			alpha[k] = (mode == 0) ? 0 : (mode == 1) ? 255 : (uint8_t)bench_rand();
+		}
+
+		uint16_t *dst_ref = ref + (dst - buf);
+		if (i & 2)
+		{
+			ili_blend_bitmap_buffer(dst, stride, w, h, src, alpha);
+			for (uint16_t row = 0; row < h; row++)
+				for (uint16_t col = 0; col < w; col++)
+					dst_ref[row * stride + col] = ili_blend_color(src[row * w + col], dst_ref[row * stride + col],
+							alpha[row * w + col]);
+		}
+		else
+		{
+			ili_blend_fill_buffer(dst, stride, w, h, color, fill_alpha);
+			for (uint16_t row = 0; row < h; row++)
+				for (uint16_t col = 0; col < w; col++)
+					dst_ref[row * stride + col] = ili_blend_color(color, dst_ref[row * stride + col], fill_alpha);
+		}
+
+		// Pixels between the rows and past the area must stay as they were too
+		for (uint32_t k = 0; k < stride * h + 1; k++)
+			bad_px += (buf[k] != ref[k]);
+	}
+
+	printf("%-16s %7lu spans, %lu px differ from ili_blend_color()%s\r\n", "blend_check", (unsigned long)BENCH_CHECK_SPANS,
+			(unsigned long)bad_px, bad_px ? " !! FAILED" : "");
+	g_check_failures += (bad_px != 0);
+}
+
+/*
+ * A fill right after ili_display_on() or a sleep out, as in bench_boot(): the command ends the
+ * panel's RAMWR stream, so the fill must open its address window again instead of continuing
+ * the one of the previous frame. Counts a failure if the fill doesn't reach the glass
+ */
+static void check_after_command(void)
+{
+	uint32_t bad = 0;
+
+	ili_fill_screen(0xF800);
+	ili_display_on(1);
+	ili_fill_screen(0x001F);
+	bad += (ili_sim_get_pixel(120, 160) != 0x001F);
+
+	ili_sleep(1);
+	ili_sleep(0);
+	ili_fill_screen(0x07E0);
+	bad += (ili_sim_get_pixel(120, 160) != 0x07E0);
+
+	printf("%-16s %7u fills, %lu after DISPON/SLPOUT lost%s\r\n", "command_check", 2U,
+			(unsigned long)bad, bad ? " !! FAILED" : "");
+	g_check_failures += (bad != 0);
+}
+
+/*
+ * ili_convert_to_rgb565() on random rows against the same pixels converted one at a time, which
+ * always takes the plain C loop: the 3 formats with every combination of ILI_CONV_DITHER,
+ * ILI_CONV_SWAP_RB and ILI_CONV_BYTESWAP, odd lengths, unaligned sources, any dither phase.
+ * Channel values are biased to the ends of the range, where dithering saturates
+ */
+static void check_convert(void)
+{
+	uint16_t *dst = strip_buf[0];
+	uint16_t *ref = strip_buf[0] + 4096;
+	uint8_t *src = (uint8_t *)strip_buf[1];
+	uint32_t bad_px = 0;
+
+	g_bench_rand_state = BENCH_SEED;
+	for (uint32_t i = 0; i < BENCH_CHECK_SPANS; i++)
+	{
+		uint32_t n = bench_rand_range(1, BENCH_CHECK_MAX_W);
+		uint8_t format = (uint8_t)(i % 3);
+		uint8_t flags = (uint8_t)((i / 3) & 7);
+		uint16_t x = bench_rand_range(0, 239);
+		uint16_t y = bench_rand_range(0, 319);
+		uint32_t step = (format == ILI_FMT_ARGB8888) ? 4 : 3;
+		// ARGB8888 words stay 32-bit aligned, 3-byte pixels start anywhere
+		const uint8_t *p = src + ((step == 4) ? 0 : bench_rand_range(0, 3));
+
+		for (uint32_t k = 0; k < n * step + 4; k++)
+		{
+			uint32_t r = bench_rand();
+			src[k] = (r & 0x100) ? (uint8_t)r : (r & 0x200) ? (uint8_t)(0xF8 | (r >> 10)) : (uint8_t)((r >> 10) & 7);
+		}
+		for (uint32_t k = 0; k < n + 1; k++)
+		{
+			dst[k] = 0x5A5A;
+			ref[k] = 0x5A5A;
+		}
+
+		ili_convert_to_rgb565(dst, p, n, format, flags, x, y);
+		for (uint32_t k = 0; k < n; k++)
+			ili_convert_to_rgb565(&ref[k], p + k * step, 1, format, flags, x + k, y);
+
+		for (uint32_t k = 0; k < n + 1; k++)
+			bad_px += (dst[k] != ref[k]);
+	}
+
+	printf("%-16s %7lu spans, %lu px differ from the plain C loop%s\r\n", "rgb888_check", (unsigned long)BENCH_CHECK_SPANS,
+			(unsigned long)bad_px, bad_px ? " !! FAILED" : "");
+	g_check_failures += (bad_px != 0);
+}
+#endif
+
+/*
+ * A 32 row RGB888 camera frame with smooth gradients drawn 20 times. mode 0: ILI_RGB() per pixel
+ * into a strip, then sent. mode 1: ili_convert_to_rgb565() per row with dithering into the strip,
+ * then sent. mode 2: ili_draw_pixels_rgb888() with dithering, through the temporary display
+ * buffer instead of a strip. Modes 0 and 1 print the CPU time of the conversion
+ */
+static void bench_convert(uint8_t mode)
+{
+	uint8_t *frame = cam_frame;
+	uint16_t *strip = strip_buf[0];
+	uint32_t ops = 20;
+	uint32_t conv_us = 0;
+
+	for (uint16_t y = 0; y < BENCH_CAM_ROWS; y++)
+	{
+		for (uint16_t x = 0; x < g_bench_w; x++)
+		{
+			uint8_t *px = &frame[((uint32_t)y * g_bench_w + x) * 3];
+			px[0] = (uint8_t)(x * 255 / (g_bench_w - 1));
+			px[1] = (uint8_t)(96 + y);
+			px[2] = (uint8_t)(255 - x * 128 / (g_bench_w - 1));
+		}
+	}
+
+	bench_begin();
+	for (uint32_t i = 0; i < ops; i++)
+	{
+		uint16_t y = bench_rand_range(0, g_bench_h - BENCH_CAM_ROWS);
+		if (mode == 2)
+		{
+			ili_set_address_window(0, y, g_bench_w, BENCH_CAM_ROWS);
+			ili_draw_pixels_rgb888(frame, (uint32_t)g_bench_w * BENCH_CAM_ROWS, ILI_FMT_RGB888, ILI_CONV_DITHER);
+			continue;
+		}
+
+		uint32_t start_us = get_micros();
+		for (uint16_t row = 0; row < BENCH_CAM_ROWS; row++)
+		{
+			const uint8_t *src = &frame[(uint32_t)row * g_bench_w * 3];
+			uint16_t *dst = &strip[(uint32_t)row * g_bench_w];
+			if (mode)
+			{
+				ili_convert_to_rgb565(dst, src, g_bench_w, ILI_FMT_RGB888, ILI_CONV_DITHER, 0, y + row);
+				continue;
+			}
+			for (uint16_t col = 0; col < g_bench_w; col++)
+				dst[col] = ILI_RGB(src[col * 3], src[col * 3 + 1], src[col * 3 + 2]);
+		}
+		conv_us += get_micros() - start_us;
+
+		ili_draw_bitmap(0, y, g_bench_w, BENCH_CAM_ROWS, strip);
+	}
+	bench_end((mode == 2) ? "rgb888_stream" : mode ? "rgb888_kernel" : "rgb888_macro", ops);
+	if (mode != 2)
+		printf("%-16s CPU %lu us converting %lu px\r\n", "", (unsigned long)conv_us,
+				(unsigned long)ops * g_bench_w * BENCH_CAM_ROWS);
+}
+
+static void bench_rectangle(void)
+{
+	uint32_t ops = 200;
+	bench_begin();
+	for (uint32_t i = 0; i < ops; i++)
+	{
+		uint16_t w = bench_rand_range(2, 100);
+		uint16_t h = bench_rand_range(2, 100);
+		ili_draw_rectangle(bench_rand_range(0, g_bench_w - 1 - w), bench_rand_range(0, g_bench_h - 1 - h),
+						   w, h, (uint16_t)bench_rand());
+	}
+	bench_end("rectangle", ops);
+}
+
+/* Sprite-sized blits from the gradient buffer */
+static void bench_pixels_buffer(void)
+{
+	uint32_t ops = 200;
+	bench_begin();
+	for (uint32_t i = 0; i < ops; i++)
+	{
+		uint16_t w = bench_rand_range(8, 64);
+		uint16_t h = bench_rand_range(8, 64);
+		ili_set_address_window(bench_rand_range(0, g_bench_w - w), bench_rand_range(0, g_bench_h - h), w, h);
+		ili_draw_pixels_buffer(disp_buf, (uint32_t)w * h);
+	}
+	bench_end("pixels_buffer", ops);
+}
+
+/* The old FPS test: full frame blit of a pre-filled buffer. Area is set only once */
+static void bench_full_frame(void)
+{
+	uint32_t frames = 20;
+	uint32_t len = (uint32_t)g_bench_w * g_bench_h;
+
+	bench_begin();
+	ili_set_address_window(0, 0, g_bench_w, g_bench_h);
+	for (uint32_t i = 0; i < frames; i++)
+	{
 		ili_draw_pixels_buffer(disp_buf, len);
-    }
+	}
+	bench_end("full_frame", frames);
+}
 
-    uint32_t end = get_millis();
-    cyhal_gpio_write(CYBSP_USER_LED, CYBSP_LED_STATE_OFF);
-    uint32_t delta = end - start;
 
-    float fps = ((float)frames / (float)delta) * 1000.;
+/*
+ * Same as full_frame but non-blocking. Every frame is started from the previous frame's
+ * completion, the CPU only waits at the end. The gap between the two is free CPU time.
+ */
+static void bench_full_frame_async(void)
+{
+	volatile uint32_t frames_left = 20;
+	uint32_t frames = frames_left;
 
-    printf("\r\nFrames   : %ld", frames);
-    printf("\r\nDelta(ms): %ld", delta);
-    printf("\r\nFPS      : %f", fps);
-    printf("\r\n");
+	bench_begin();
+	ili_set_address_window(0, 0, g_bench_w, g_bench_h);
+	ili_draw_pixels_buffer_async(disp_buf, (uint32_t)g_bench_w * g_bench_h, bench_async_done, (void *)&frames_left);
+	uint32_t cpu_us = get_micros() - g_bench_start_us;
+	while (frames_left);
+	ili_wait_idle();
+	bench_end("full_frame_async", frames);
+	printf("%-16s CPU busy for %lu us while starting the transfer\r\n", "", (unsigned long)cpu_us);
+}
+
+static void bench_async_done(void *user_data)
+{
+	volatile uint32_t *frames_left = (volatile uint32_t *)user_data;
+	if (--(*frames_left))
+		ili_draw_pixels_buffer_async(disp_buf, (uint32_t)g_bench_w * g_bench_h, bench_async_done, user_data);
+}
+
+
+static uint32_t bench_rand(void)
+{
+	/* xorshift32 */
+	uint32_t x = g_bench_rand_state;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	g_bench_rand_state = x;
+	return x;
+}
+
+static uint16_t bench_rand_range(uint16_t min, uint16_t max)
+{
+	return min + (uint16_t)(bench_rand() % ((uint32_t)max - min + 1));
 }
 
+static void bench_begin(void)
+{
+	g_bench_rand_state = BENCH_SEED;
+#if defined(ILI_PLATFORM_HOST_SIM)
+	ili_sim_reset_stats();
+#endif
+	g_bench_start_us = get_micros();
+}
+
+static void bench_end(const char *name, uint32_t ops)
+{
+#if defined(ILI_PLATFORM_HOST_SIM)
+	const ili_sim_stats_t *st = ili_sim_get_stats();
+#if defined(ILI_BUS_TYPE_PARALLEL8)
+	double wire_ms = (double)st->wr_strobes * ILI_SIM_WR_CYCLE_NS / 1e6;
+	double bus_ms = ((double)st->port_writes * BENCH_PAR_BYTE_NS(3)
+			+ (double)(st->wr_strobes - st->port_writes) * BENCH_PAR_BYTE_NS(2)
+			+ (double)st->dc_toggles * BENCH_GPIO_STORE_NS) / 1e6;
+#else
+	double wire_ms = (double)(st->cmd_count + st->data_bytes) * 8.0 * 1000.0 / (double)ILI_SPI_FREQ
+			+ (double)st->read_bytes * 8.0 * 1000.0 / (double)ILI_SPI_READ_FREQ;
+	double bus_ms = wire_ms
+			+ (double)st->tx_drains * BENCH_DRAIN_COST_NS / 1e6
+			+ (double)(st->width_switches + 2 * st->read_cmds) * BENCH_WIDTH_SW_COST_NS / 1e6;
+#endif
+
+	printf("%-16s %7lu %8lu %10lu %8lu %7lu %8lu %9.3f %9.3f\r\n", name, (unsigned long)ops,
+			(unsigned long)st->cmd_count, (unsigned long)st->data_bytes, (unsigned long)st->dc_toggles,
+			(unsigned long)st->width_switches, (unsigned long)st->tx_drains, wire_ms, bus_ms);
+	if (st->order_violations)
+		printf("%-16s !! %lu bus accesses while a DMA transfer was in flight\r\n", "", (unsigned long)st->order_violations);
+#else
+	uint32_t delta = get_micros() - g_bench_start_us;
+	printf("%-16s %7lu %9.3f %9.3f\r\n", name, (unsigned long)ops,
+			(float)delta / 1000.0f, (float)delta / (float)ops);
+#endif
+}
+
+#if defined(ILI_PLATFORM_TE)
+/*
+ * Full frames three ways: back to back at the init frame rate, each one started on the tearing
+ * effect pulse, and the same at a frame rate the write can follow (two frame periods per frame,
+ * with a margin for the lines before the pulse). The simulator times them on the panel's clock
+ * and counts the refreshes that showed a frame half written
+ */
+static void bench_vsync(void)
+{
+	static const char *names[3] = {"frame_free", "frame_te", "frame_te_slow"};
+	uint32_t len = (uint32_t)g_bench_w * g_bench_h;
+	uint32_t frame_us = 1;
+	uint16_t hz = ILI_FRAME_RATE_HZ;
+
+	printf("\r\n%-16s %7s %5s %9s %9s", "vsync", "frames", "hz", "time_ms", "fps");
+#if defined(ILI_PLATFORM_HOST_SIM)
+	printf(" %5s %8s", "torn", "te_waits");
+#endif
+	printf("\r\n");
+
+	for (uint8_t mode = 0; mode < 3; mode++)
+	{
+		if (mode == 2)
+		{
+			uint32_t slow_hz = 1800000UL / frame_us;
+			hz = (slow_hz < ILI_FRAME_RATE_HZ) ? (uint16_t)slow_hz : ILI_FRAME_RATE_HZ;
+		}
+		ili_set_frame_rate(hz);
+		if (mode == 0)
+			ili_te_disable();
+		else
+			ili_te_enable(BENCH_TE_LINE);
+
+		bench_begin();
+		ili_set_address_window(0, 0, g_bench_w, g_bench_h);
+		for (uint32_t i = 0; i < BENCH_VSYNC_FRAMES; i++)
+		{
+			ili_wait_te();
+			ili_draw_pixels_buffer(disp_buf, len);
+		}
+		ili_wait_idle();
+#if defined(ILI_PLATFORM_HOST_SIM)
+		const ili_sim_stats_t *st = ili_sim_get_stats();
+		uint32_t us = (uint32_t)(st->clock_ns / 1000ULL);
+#else
+		uint32_t us = get_micros() - g_bench_start_us;
+#endif
+		if (mode == 0)
+			frame_us = us / BENCH_VSYNC_FRAMES;
+
+		printf("%-16s %7lu %5u %9.3f %9.1f", names[mode], (unsigned long)BENCH_VSYNC_FRAMES, (unsigned)hz,
+				(float)us / 1000.0f, (float)BENCH_VSYNC_FRAMES * 1e6f / (float)us);
+#if defined(ILI_PLATFORM_HOST_SIM)
+		printf(" %5lu %8lu", (unsigned long)st->torn_frames, (unsigned long)st->te_waits);
+#endif
+		printf("\r\n");
+	}
+
+	ili_te_disable();
+	ili_set_frame_rate(ILI_FRAME_RATE_HZ);
+}
+#endif
+
+#if defined(ILI_PLATFORM_HOST_SIM)
+/*
+ * Two panels on two buses drawing the same screen, first one after the other from one thread,
+ * then at the same time from a thread each. Both instances share nothing but the read-only
+ * image and font: the second run gives the same pixels, and one panel draws while the other
+ * one's DMA transfer is in flight (on a multi-core host both draw at once).
+ */
+static void bench_two_panels(void)
+{
+	bench_panel_t panels[2] = {{.dev = ili_dev_default()}, {.dev = &g_bench_dev2}};
+	pthread_t threads[2];
+
+	ili_sim_bus_reset(&g_bench_bus2);
+	ili_dev_setup(&g_bench_dev2, &g_bench_bus2);
+	ili_dev_bus_init(&g_bench_dev2);
+	ili_dev_init(&g_bench_dev2);
+
+	uint32_t start_us = get_micros();
+	bench_panel_worker(&panels[0]);
+	bench_panel_worker(&panels[1]);
+	uint32_t serial_us = get_micros() - start_us;
+
+	ili_sim_reset_stats();
+	ili_sim_bus_reset_stats(&g_bench_bus2);
+	start_us = get_micros();
+	for (uint8_t i = 0; i < 2; i++)
+		pthread_create(&threads[i], NULL, bench_panel_worker, &panels[i]);
+	for (uint8_t i = 0; i < 2; i++)
+		pthread_join(threads[i], NULL);
+	uint32_t concurrent_us = get_micros() - start_us;
+
+	uint32_t sum0 = ili_sim_checksum();
+	uint32_t sum1 = ili_sim_bus_checksum(&g_bench_bus2);
+	printf("Two panels : serial %.3f ms, concurrent %.3f ms, checksums %08lx %08lx%s\r\n",
+			(float)serial_us / 1000.0f, (float)concurrent_us / 1000.0f,
+			(unsigned long)sum0, (unsigned long)sum1, (sum0 == sum1) ? "" : " !! differ");
+	if (ili_sim_get_stats()->order_violations || ili_sim_bus_get_stats(&g_bench_bus2)->order_violations)
+		printf("%-16s !! bus accesses while a DMA transfer was in flight\r\n", "");
+
+	ili_dev_bus_deinit(&g_bench_dev2);
+}
+
+/* Full frames streamed with DMA, then rectangles and a label on top */
+static void *bench_panel_worker(void *arg)
+{
+	bench_panel_t *panel = (bench_panel_t *)arg;
+	uint32_t rand_state = BENCH_SEED;
+
+	ili_dev_set_address_window(panel->dev, 0, 0, g_bench_w, g_bench_h);
+	panel->frames_left = BENCH_PANEL_FRAMES;
+	ili_dev_draw_pixels_buffer_async(panel->dev, disp_buf, (uint32_t)g_bench_w * g_bench_h, bench_panel_frame_done, panel);
+	while (panel->frames_left);
+	ili_dev_wait_idle(panel->dev);
+
+	for (uint32_t i = 0; i < BENCH_PANEL_RECTS; i++)
+	{
+		/* Own xorshift32 state, bench_rand() isn't shared between threads */
+		rand_state ^= rand_state << 13;
+		rand_state ^= rand_state >> 17;
+		rand_state ^= rand_state << 5;
+		ili_dev_fill_rect(panel->dev, rand_state % g_bench_w, (rand_state >> 8) % g_bench_h,
+				8 + (rand_state >> 16) % 32, 8 + (rand_state >> 21) % 32, (uint16_t)rand_state);
+	}
+	ili_dev_draw_string(panel->dev, 10, 10, "-12.5", &g_bench_font, 0xFFFF, 0x0000);
+	return NULL;
+}
+
+static void bench_panel_frame_done(void *user_data)
+{
+	bench_panel_t *panel = (bench_panel_t *)user_data;
+	if (--panel->frames_left)
+		ili_dev_draw_pixels_buffer_async(panel->dev, disp_buf, (uint32_t)g_bench_w * g_bench_h, bench_panel_frame_done, panel);
+}
+#endif
+
+
 // Function to generate RGB565 color based on position
 uint16_t generate_color(uint32_t x, uint32_t y, uint32_t w, uint32_t h)
 {
@@ -139,6 +1501,20 @@ uint16_t generate_color(uint32_t x, uint32_t y, uint32_t w, uint32_t h)
     return (red << 11) | (green << 5) | blue;
 }
 
+#if defined(ILI_PLATFORM_HOST_SIM)
+uint32_t get_micros(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint32_t)((uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000ULL);
+}
+
+uint32_t get_millis(void)
+{
+	return get_micros() / 1000;
+}
+
+#else
 // See: https://community.infineon.com/t5/PSoC-6/SysTick-for-timing-measurement/m-p/347523#M12764
 static inline __attribute__((always_inline)) uint32_t get_ticks(void)
 {
@@ -163,5 +1539,6 @@ void isr_systick(void)
 {
     ++systick_wrap;
 }
+#endif
 
 /* [] END OF FILE */
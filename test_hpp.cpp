@@ -0,0 +1,145 @@
+/*
+ * Benchmark of the C++ front-end (ili9341.hpp) against the C functions, on the same instance.
+ * Built into the example when ILI_BENCH_CPP is defined, test.c then calls bench_cpp() at the end:
+ * the Display initializes the default bus again and takes it over from the ili_* functions.
+ */
+#include "ili9341.hpp"
+#include <stdio.h>
+
+extern "C" uint32_t get_micros(void);
+extern "C" void bench_cpp(void);
+
+#define BENCH_CPP_SEED			0x1234ABCDUL
+#define BENCH_CPP_PLOTS			4000		// Runs of 8 pixels along a row, like a plotted curve
+#define BENCH_CPP_RECTS			5000
+#define BENCH_CPP_LINES			5000
+
+/* Landscape, so the size the bound checks fold against isn't the default one */
+static ili::Display<ili::DefaultBus, 1> g_lcd;
+static uint32_t g_cpp_rand_state;
+
+static uint32_t bench_cpp_rand(void)
+{
+	/* xorshift32 */
+	uint32_t x = g_cpp_rand_state;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	g_cpp_rand_state = x;
+	return x;
+}
+
+/* The same calls, through the ili_dev_* functions (Cpp = false) or through the template */
+template <bool Cpp>
+static void bench_cpp_pixels(void)
+{
+	for (uint32_t i = 0; i < BENCH_CPP_PLOTS; i++)
+	{
+		uint32_t r = bench_cpp_rand();
+		uint16_t x = r % (g_lcd.width + 8);		// Some runs cross the edge
+		uint16_t y = (r >> 9) % g_lcd.height;
+		for (uint16_t k = 0; k < 8; k++)
+		{
+			if (Cpp)
+				g_lcd.draw_pixel(x + k, y, (uint16_t)(r >> 16));
+			else
+				ili_dev_draw_pixel(g_lcd.dev(), x + k, y, (uint16_t)(r >> 16));
+		}
+	}
+}
+
+template <bool Cpp>
+static void bench_cpp_rects(void)
+{
+	for (uint32_t i = 0; i < BENCH_CPP_RECTS; i++)
+	{
+		uint32_t r = bench_cpp_rand();
+		uint16_t x = r % g_lcd.width;
+		uint16_t y = (r >> 9) % g_lcd.height;
+		uint16_t w = 1 + (r >> 17) % 16;
+		uint16_t h = 1 + (r >> 21) % 16;
+		if (Cpp)
+			g_lcd.fill_rect(x, y, w, h, (uint16_t)r);
+		else
+			ili_dev_fill_rect(g_lcd.dev(), x, y, w, h, (uint16_t)r);
+	}
+}
+
+template <bool Cpp>
+static void bench_cpp_lines(void)
+{
+	for (uint32_t i = 0; i < BENCH_CPP_LINES; i++)
+	{
+		uint32_t r = bench_cpp_rand();
+		uint16_t x = r % g_lcd.width;
+		uint16_t y = (r >> 9) % g_lcd.height;
+		uint16_t len = 1 + (r >> 17) % 64;
+		if (Cpp)
+		{
+			if (r & 1)
+				g_lcd.draw_hline(x, y, len, (uint16_t)r);
+			else
+				g_lcd.draw_vline(x, y, len, (uint16_t)r);
+		}
+		else
+		{
+			if (r & 1)
+				ili_dev_fill_rect(g_lcd.dev(), x, y, len, 1, (uint16_t)r);
+			else
+				ili_dev_fill_rect(g_lcd.dev(), x, y, 1, len, (uint16_t)r);
+		}
+	}
+}
+
+/* Run both versions from a cleared screen and the same seed */
+static void bench_cpp_run(const char *name, uint32_t ops, void (*c_fn)(void), void (*cpp_fn)(void))
+{
+	uint32_t us[2];
+#if defined(ILI_PLATFORM_HOST_SIM)
+	uint32_t sum[2];
+	uint32_t bytes[2];
+#endif
+
+	for (uint8_t k = 0; k < 2; k++)
+	{
+		ili_dev_fill_screen(g_lcd.dev(), 0x0000);
+		ili_dev_wait_idle(g_lcd.dev());
+		g_cpp_rand_state = BENCH_CPP_SEED;
+#if defined(ILI_PLATFORM_HOST_SIM)
+		ili_sim_reset_stats();
+#endif
+		uint32_t start_us = get_micros();
+		(k ? cpp_fn : c_fn)();
+		us[k] = get_micros() - start_us;
+#if defined(ILI_PLATFORM_HOST_SIM)
+		const ili_sim_stats_t *st = ili_sim_get_stats();
+		bytes[k] = st->cmd_count + st->data_bytes;
+		sum[k] = ili_sim_checksum();
+#endif
+	}
+
+	printf("%-16s %7lu %9.3f %9.3f %7.2f", name, (unsigned long)ops,
+			(float)us[0] / (float)ops, (float)us[1] / (float)ops, (float)us[0] / (float)(us[1] ? us[1] : 1));
+#if defined(ILI_PLATFORM_HOST_SIM)
+	printf(" %10lu %s", (unsigned long)bytes[1], (sum[0] == sum[1] && bytes[0] == bytes[1]) ? "same" : "!! differ");
+#endif
+	printf("\r\n");
+}
+
+void bench_cpp(void)
+{
+	ili_bus_deinit();
+	g_lcd.begin();
+
+	printf("\r\nC++ front-end, %ux%u, against the ili_dev_* functions on the same instance\r\n",
+			(unsigned)g_lcd.width, (unsigned)g_lcd.height);
+	printf("%-16s %7s %9s %9s %7s", "benchmark", "ops", "c_us/op", "cpp_us/op", "speedup");
+#if defined(ILI_PLATFORM_HOST_SIM)
+	printf(" %10s %s", "bytes", "output");
+#endif
+	printf("\r\n");
+
+	bench_cpp_run("cpp_pixel", BENCH_CPP_PLOTS * 8, bench_cpp_pixels<false>, bench_cpp_pixels<true>);
+	bench_cpp_run("cpp_fill_rect", BENCH_CPP_RECTS, bench_cpp_rects<false>, bench_cpp_rects<true>);
+	bench_cpp_run("cpp_hv_line", BENCH_CPP_LINES, bench_cpp_lines<false>, bench_cpp_lines<true>);
+}
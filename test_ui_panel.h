@@ -0,0 +1,149 @@
+/* Generated by ili_imgconvert.py from test_ui_panel.png, 200x64 */
+#ifndef _TEST_UI_PANEL_H_
+#define _TEST_UI_PANEL_H_
+
+#include "ili9341.h"
+
+static const uint16_t test_ui_panel_data[] = {
+    0x84BA, 0x18E5, 0x8030, 0xE73C, 0x800E, 0x18E5, 0x8030, 0xE73C, 0x800E, 0x18E5, 0x8030, 0xE73C,
+    0x8014, 0x18E5, 0x0001, 0xE73C, 0xE73C, 0x8030, 0x2D0A, 0x0001, 0xE73C, 0xE73C, 0x800A, 0x18E5,
+    0x0001, 0xE73C, 0xE73C, 0x8030, 0xC9E6, 0x0001, 0xE73C, 0xE73C, 0x800A, 0x18E5, 0x0001, 0xE73C,
+    0xE73C, 0x8030, 0x3B79, 0x0001, 0xE73C, 0xE73C, 0x8011, 0x18E5, 0x0000, 0xE73C, 0x8034, 0x2D0A,
+    0x0000, 0xE73C, 0x8008, 0x18E5, 0x0000, 0xE73C, 0x8034, 0xC9E6, 0x0000, 0xE73C, 0x8008, 0x18E5,
+    0x0000, 0xE73C, 0x8034, 0x3B79, 0x0000, 0xE73C, 0x800F, 0x18E5, 0x0000, 0xE73C, 0x8036, 0x2D0A,
+    0x0000, 0xE73C, 0x8006, 0x18E5, 0x0000, 0xE73C, 0x8036, 0xC9E6, 0x0000, 0xE73C, 0x8006, 0x18E5,
+    0x0000, 0xE73C, 0x8036, 0x3B79, 0x0000, 0xE73C, 0x800E, 0x18E5, 0x0000, 0xE73C, 0x8036, 0x2D0A,
+    0x0000, 0xE73C, 0x8006, 0x18E5, 0x0000, 0xE73C, 0x8036, 0xC9E6, 0x0000, 0xE73C, 0x8006, 0x18E5,
+    0x0000, 0xE73C, 0x8036, 0x3B79, 0x0000, 0xE73C, 0x800D, 0x18E5, 0x0000, 0xE73C, 0x8038, 0x2D0A,
+    0x0000, 0xE73C, 0x8004, 0x18E5, 0x0000, 0xE73C, 0x8038, 0xC9E6, 0x0000, 0xE73C, 0x8004, 0x18E5,
+    0x0000, 0xE73C, 0x8038, 0x3B79, 0x0000, 0xE73C, 0x800C, 0x18E5, 0x0000, 0xE73C, 0x8038, 0x2D0A,
+    0x0000, 0xE73C, 0x8004, 0x18E5, 0x0000, 0xE73C, 0x8038, 0xC9E6, 0x0000, 0xE73C, 0x8004, 0x18E5,
+    0x0000, 0xE73C, 0x8038, 0x3B79, 0x0000, 0xE73C, 0x800C, 0x18E5, 0x0000, 0xE73C, 0x8038, 0x2D0A,
+    0x0000, 0xE73C, 0x8004, 0x18E5, 0x0000, 0xE73C, 0x8038, 0xC9E6, 0x0000, 0xE73C, 0x8004, 0x18E5,
+    0x0000, 0xE73C, 0x8038, 0x3B79, 0x0000, 0xE73C, 0x800C, 0x18E5, 0x0000, 0xE73C, 0x8038, 0x2D0A,
+    0x0000, 0xE73C, 0x8004, 0x18E5, 0x0000, 0xE73C, 0x8038, 0xC9E6, 0x0000, 0xE73C, 0x8004, 0x18E5,
+    0x0000, 0xE73C, 0x8038, 0x3B79, 0x0000, 0xE73C, 0x800C, 0x18E5, 0x0000, 0xE73C, 0x8038, 0x2D0A,
+    0x0000, 0xE73C, 0x8004, 0x18E5, 0x0000, 0xE73C, 0x8038, 0xC9E6, 0x0000, 0xE73C, 0x8004, 0x18E5,
+    0x0000, 0xE73C, 0x8038, 0x3B79, 0x0000, 0xE73C, 0x800C, 0x18E5, 0x0000, 0xE73C, 0x800E, 0x2D0A,
+    0x0004, 0x4D6D, 0xC73A, 0xF7DE, 0xE79C, 0x9695, 0x8024, 0x2D0A, 0x0000, 0xE73C, 0x8004, 0x18E5,
+    0x0000, 0xE73C, 0x800F, 0xC9E6, 0x0005, 0xD2CA, 0xF679, 0xFFBE, 0xF73C, 0xE4F3, 0xCA06, 0x8022,
+    0xC9E6, 0x0000, 0xE73C, 0x8004, 0x18E5, 0x0000, 0xE73C, 0x800C, 0x3B79, 0x0001, 0xE77F, 0xB65D,
+    0x8005, 0x3B79, 0x0001, 0xBE7D, 0xDF3E, 0x8021, 0x3B79, 0x0000, 0xE73C, 0x800C, 0x18E5, 0x0000,
+    0xE73C, 0x800E, 0x2D0A, 0x0008, 0xE79D, 0x8E54, 0x352B, 0x558E, 0xB6F8, 0x2D0A, 0x2D0A, 0x7E32,
+    0x9674, 0x800E, 0x2D0A, 0x0001, 0x7E32, 0x9674, 0x800F, 0x2D0A, 0x0000, 0xE73C, 0x8004, 0x18E5,
+    0x0000, 0xE73C, 0x800F, 0xC9E6, 0x0008, 0xFF3C, 0xE4B1, 0xCA27, 0xD30B, 0xEDD6, 0xCA07, 0xC9E6,
+    0xDC50, 0xE4D2, 0x801F, 0xC9E6, 0x0000, 0xE73C, 0x8004, 0x18E5, 0x0000, 0xE73C, 0x800C, 0x3B79,
+    0x0002, 0xE77F, 0xFFFF, 0x5C3A, 0x8003, 0x3B79, 0x0002, 0x645A, 0xFFFF, 0xDF3E, 0x8021, 0x3B79,
+    0x0000, 0xE73C, 0x800C, 0x18E5, 0x0000, 0xE73C, 0x800D, 0x2D0A, 0x0001, 0x4D8D, 0xFFFF, 0x8005,
+    0x2D0A, 0x0001, 0xA6B6, 0x9674, 0x800E, 0x2D0A, 0x0001, 0xA6B6, 0x9674, 0x800F, 0x2D0A, 0x0000,
+    0xE73C, 0x8004, 0x18E5, 0x0000, 0xE73C, 0x800E, 0xC9E6, 0x0001, 0xD2EA, 0xFFFF, 0x8005, 0xC9E6,
+    0x0001, 0xE554, 0xE4D2, 0x801F, 0xC9E6, 0x0000, 0xE73C, 0x8004, 0x18E5, 0x0000, 0xE73C, 0x800C,
+    0x3B79, 0x0002, 0xE77F, 0xF7BF, 0xC69D, 0x8003, 0x3B79, 0x0002, 0xC6BD, 0xF7BF, 0xDF3E, 0x8021,
+    0x3B79, 0x0000, 0xE73C, 0x800C, 0x18E5, 0x0000, 0xE73C, 0x800D, 0x2D0A, 0x0002, 0x3D4B, 0xFFFF,
+    0x8E74, 0x8003, 0x2D0A, 0x0000, 0xAED7, 0x8002, 0xFFFF, 0x000D, 0x7E32, 0x2D0A, 0x7611, 0xDF9C,
+    0xF7FF, 0xC73A, 0x3D4B, 0x2D0A, 0x352B, 0xF7DE, 0x6DF1, 0xEFBD, 0xDF7C, 0xAED7, 0x8002, 0xFFFF,
+    0x0000, 0x7E32, 0x800D, 0x2D0A, 0x0000, 0xE73C, 0x8004, 0x18E5, 0x0000, 0xE73C, 0x800E, 0xC9E6,
+    0x0002, 0xCA68, 0xFFFF, 0xE4D2, 0x8003, 0xC9E6, 0x0011, 0xED95, 0xFFDF, 0xFFFF, 0xFFFF, 0xDC2F,
+    0xC9E6, 0xD30B, 0xF699, 0xFFBE, 0xF6FB, 0xDBEE, 0xC9E6, 0xCA27, 0xFFBE, 0xD32B, 0xF71C, 0xFF9E,
+    0xE554, 0x8010, 0xC9E6, 0x0000, 0xE73C, 0x8004, 0x18E5, 0x0000, 0xE73C, 0x800C, 0x3B79, 0x001A,
+    0xE77F, 0x957C, 0xFFFF, 0x647A, 0x3B79, 0x3B79, 0x647A, 0xFFFF, 0x959C, 0xDF3E, 0x3B79, 0x3B79,
+    0x645A, 0xD71E, 0xFFDF, 0xD6FE, 0x5C1A, 0x3B79, 0x43B9, 0xF7BF, 0x6C9A, 0xE75E, 0xF7BF, 0xA5FC,
+    0x3B79, 0x647A, 0xF7DF, 0x8002, 0x3B79, 0x0001, 0xEF9F, 0x74BA, 0x800B, 0x3B79, 0x0000, 0xE73C,
+    0x800C, 0x18E5, 0x0000, 0xE73C, 0x800E, 0x2D0A, 0x0008, 0x9695, 0xFFFF, 0xEFBD, 0x9EB5, 0x3D4B,
+    0x2D0A, 0x2D0A, 0xBF18, 0x9674, 0x8002, 0x2D0A, 0x000D, 0xA6B6, 0x558E, 0x352B, 0xBF18, 0xA6B6,
+    0x2D0A, 0x352B, 0xFFFF, 0xB6F8, 0x352B, 0x2D0A, 0x2D0A, 0xBF18, 0x9674, 0x800F, 0x2D0A, 0x0000,
+    0xE73C, 0x8004, 0x18E5, 0x0000, 0xE73C, 0x800F, 0xC9E6, 0x0018, 0xE4F3, 0xFFFF, 0xFF7D, 0xE534,
+    0xCA68, 0xC9E6, 0xC9E6, 0xEE17, 0xE4D2, 0xC9E6, 0xC9E6, 0xCA48, 0xFF9E, 0xDC70, 0xCA27, 0xD38D,
+    0xFFBE, 0xD32B, 0xCA27, 0xFFFF, 0xEDB6, 0xCA48, 0xD2EA, 0xFF7D, 0xDC0F, 0x800F, 0xC9E6, 0x0000,
+    0xE73C, 0x8004, 0x18E5, 0x0000, 0xE73C, 0x800C, 0x3B79, 0x001A, 0xE77F, 0x6C9A, 0xBE7D, 0xCEBE,
+    0x3B79, 0x3B79, 0xCEBE, 0xB65D, 0x74BB, 0xDF3E, 0x3B79, 0x4BD9, 0xF7BF, 0x8D5B, 0x43B9, 0x851B,
+    0xDF1E, 0x3B79, 0x43B9, 0xFFFF, 0xB65D, 0x4BD9, 0x645A, 0xF7DF, 0x647A, 0x647A, 0xF7DF, 0x8002,
+    0x3B79, 0x0001, 0xEF9F, 0x74BA, 0x800B, 0x3B79, 0x0000, 0xE73C, 0x800C, 0x18E5, 0x0000, 0xE73C,
+    0x800F, 0x2D0A, 0x0007, 0x4D8D, 0x9EB6, 0xF7DE, 0xE7BD, 0x352B, 0x2D0A, 0xBF18, 0x9674, 0x8005,
+    0x2D0A, 0x0005, 0x7E32, 0xCF5A, 0x2D0A, 0x352B, 0xFFFF, 0x4D6D, 0x8002, 0x2D0A, 0x0001, 0xBF18,
+    0x9674, 0x800F, 0x2D0A, 0x0000, 0xE73C, 0x8004, 0x18E5, 0x0000, 0xE73C, 0x8010, 0xC9E6, 0x000B,
+    0xD2EA, 0xE534, 0xFF9E, 0xFF5D, 0xCA48, 0xC9E6, 0xEE17, 0xE4D2, 0xC9E6, 0xC9E6, 0xDC30, 0xF6DB,
+    0x8002, 0xC9E6, 0x0008, 0xED95, 0xED95, 0xCA27, 0xFFFF, 0xCA89, 0xC9E6, 0xC9E6, 0xE554, 0xEDD6,
+    0x800F, 0xC9E6, 0x0000, 0xE73C, 0x8004, 0x18E5, 0x0000, 0xE73C, 0x800C, 0x3B79, 0x000C, 0xE77F,
+    0x6C9A, 0x5419, 0xFFDF, 0x6C9A, 0x6C7A, 0xFFDF, 0x53F9, 0x74BB, 0xDF3E, 0x3B79, 0x853B, 0xD71E,
+    0x8002, 0x3B79, 0x000A, 0xDF3E, 0x5C1A, 0x43B9, 0xFFFF, 0x53F9, 0x3B79, 0x3B79, 0xD6FE, 0x8D3B,
+    0x647A, 0xF7DF, 0x8002, 0x3B79, 0x0001, 0xEF9F, 0x74BA, 0x800B, 0x3B79, 0x0000, 0xE73C, 0x800C,
+    0x18E5, 0x0000, 0xE73C, 0x8011, 0x2D0A, 0x0005, 0x3D4C, 0xF7DE, 0x7611, 0x2D0A, 0xBF18, 0x9674,
+    0x8002, 0x2D0A, 0x0008, 0x65D0, 0xC73A, 0xEFDE, 0xFFFF, 0xD75B, 0x2D0A, 0x352B, 0xFFFF, 0x454C,
+    0x8002, 0x2D0A, 0x0001, 0xBF18, 0x9674, 0x800F, 0x2D0A, 0x0000, 0xE73C, 0x8004, 0x18E5, 0x0000,
+    0xE73C, 0x8012, 0xC9E6, 0x0009, 0xCA68, 0xFFBE, 0xDBEF, 0xC9E6, 0xEE17, 0xE4D2, 0xC9E6, 0xC9E6,
+    0xE4F2, 0xEE17, 0x8002, 0xC9E6, 0x0008, 0xE4D2, 0xEE38, 0xCA27, 0xFFFF, 0xCA89, 0xC9E6, 0xC9E6,
+    0xE4B2, 0xEE58, 0x800F, 0xC9E6, 0x0000, 0xE73C, 0x8004, 0x18E5, 0x0000, 0xE73C, 0x800C, 0x3B79,
+    0x000B, 0xE77F, 0x6C9A, 0x3B79, 0xA5FC, 0xCEDE, 0xCEDE, 0xA5DC, 0x3B79, 0x74BB, 0xDF3E, 0x3B79,
+    0x9D9C, 0x8004, 0xFFFF, 0x0009, 0x6C9A, 0x43B9, 0xFFFF, 0x53F9, 0x3B79, 0x3B79, 0xCEDE, 0x8D5B,
+    0x647A, 0xF7DF, 0x8002, 0x3B79, 0x0001, 0xEF9F, 0x74BA, 0x800B, 0x3B79, 0x0000, 0xE73C, 0x800C,
+    0x18E5, 0x0000, 0xE73C, 0x8012, 0x2D0A, 0x0010, 0xDF7C, 0x6DF0, 0x2D0A, 0xBF18, 0x9674, 0x2D0A,
+    0x2D0A, 0x558E, 0xEFBE, 0x6DF1, 0x3D4B, 0x7E12, 0xD75B, 0x2D0A, 0x352B, 0xFFFF, 0x454C, 0x8002,
+    0x2D0A, 0x0001, 0xBF18, 0x9674, 0x800F, 0x2D0A, 0x0000, 0xE73C, 0x8004, 0x18E5, 0x0000, 0xE73C,
+    0x8013, 0xC9E6, 0x0008, 0xF6FB, 0xDBCE, 0xC9E6, 0xEE17, 0xE4D2, 0xC9E6, 0xC9E6, 0xDC30, 0xF6DB,
+    0x8002, 0xC9E6, 0x0008, 0xED95, 0xED95, 0xCA27, 0xFFFF, 0xCA89, 0xC9E6, 0xC9E6, 0xED95, 0xED95,
+    0x800F, 0xC9E6, 0x0000, 0xE73C, 0x8004, 0x18E5, 0x0000, 0xE73C, 0x800C, 0x3B79, 0x000C, 0xE77F,
+    0x6C9A, 0x3B79, 0x43B9, 0xF7BF, 0xEF9F, 0x43B9, 0x3B79, 0x74BB, 0xDF3E, 0x3B79, 0x851B, 0xCEBE,
+    0x8004, 0x3B79, 0x0008, 0x43B9, 0xFFFF, 0x53F9, 0x3B79, 0x3B79, 0xCEDE, 0x8D5B, 0x5C5A, 0xFFFF,
+    0x8002, 0x3B79, 0x0001, 0xEF9F, 0x74BA, 0x800B, 0x3B79, 0x0000, 0xE73C, 0x800C, 0x18E5, 0x0000,
+    0xE73C, 0x800D, 0x2D0A, 0x0015, 0x7E32, 0xC719, 0x4D8D, 0x352B, 0x7E32, 0xEFBD, 0x352B, 0x2D0A,
+    0xB6F7, 0xB6F7, 0x3D4C, 0x352B, 0x7611, 0xDF7C, 0x352B, 0x454C, 0xBF18, 0xD75B, 0x2D0A, 0x352B,
+    0xFFFF, 0x454C, 0x8002, 0x2D0A, 0x0003, 0xB6F7, 0xB6F7, 0x3D4C, 0x352B, 0x800D, 0x2D0A, 0x0000,
+    0xE73C, 0x8004, 0x18E5, 0x0000, 0xE73C, 0x800E, 0xC9E6, 0x0019, 0xDC50, 0xEE38, 0xD2EA, 0xCA27,
+    0xDC50, 0xFF7D, 0xCA27, 0xC9E6, 0xEDB6, 0xEDD6, 0xCA68, 0xCA48, 0xCA48, 0xFF9E, 0xDC50, 0xCA27,
+    0xD36C, 0xFFBE, 0xD34C, 0xCA27, 0xFFFF, 0xE4B2, 0xCA27, 0xD36C, 0xFFBE, 0xD34C, 0x800F, 0xC9E6,
+    0x0000, 0xE73C, 0x8004, 0x18E5, 0x0000, 0xE73C, 0x800C, 0x3B79, 0x001F, 0xE77F, 0x6C9A, 0x3B79,
+    0x3B79, 0x74BB, 0x74DB, 0x3B79, 0x3B79, 0x74BB, 0xDF3E, 0x3B79, 0x43B9, 0xEF9F, 0x851B, 0x43B9,
+    0x53F9, 0x8D5B, 0x4399, 0x43B9, 0xFFFF, 0x53F9, 0x3B79, 0x3B79, 0xCEDE, 0x8D5B, 0x43B9, 0xF7DF,
+    0x851B, 0x4BD9, 0x959C, 0xFFFF, 0x74BA, 0x800B, 0x3B79, 0x0000, 0xE73C, 0x800C, 0x18E5, 0x0000,
+    0xE73C, 0x800D, 0x2D0A, 0x0015, 0x352B, 0xA6B6, 0xEFBE, 0xF7DE, 0xCF3A, 0x4D8D, 0x2D0A, 0x2D0A,
+    0x5DAF, 0xEFBD, 0xE7BD, 0x5DAF, 0x352A, 0xC73A, 0xFFFF, 0xCF5A, 0x65F0, 0xCF5A, 0x2D0A, 0x352B,
+    0xFFFF, 0x454C, 0x8002, 0x2D0A, 0x0003, 0x5DAF, 0xEFBD, 0xE7BD, 0x5DAF, 0x800D, 0x2D0A, 0x0000,
+    0xE73C, 0x8004, 0x18E5, 0x0000, 0xE73C, 0x800E, 0xC9E6, 0x0018, 0xCA27, 0xE554, 0xFF7D, 0xFFBE,
+    0xF679, 0xD2EA, 0xC9E6, 0xC9E6, 0xD34C, 0xFF7D, 0xFF5C, 0xD34C, 0xC9E6, 0xD32B, 0xF69A, 0xFFBE,
+    0xF71B, 0xDC0F, 0xC9E6, 0xCA27, 0xFFFF, 0xE554, 0xFF7D, 0xFF7D, 0xDC50, 0x8010, 0xC9E6, 0x0000,
+    0xE73C, 0x8004, 0x18E5, 0x0000, 0xE73C, 0x800C, 0x3B79, 0x0001, 0xE77F, 0x6C9A, 0x8005, 0x3B79,
+    0x0017, 0x74BB, 0xDF3E, 0x3B79, 0x3B79, 0x645A, 0xD6FE, 0xF7DF, 0xEF7F, 0x9DBC, 0x3B79, 0x43B9,
+    0xFFFF, 0x53F9, 0x3B79, 0x3B79, 0xCEDE, 0x8D5B, 0x3B79, 0x853B, 0xEF9F, 0xF7BF, 0x957C, 0xCEDE,
+    0x74BA, 0x800B, 0x3B79, 0x0000, 0xE73C, 0x800C, 0x18E5, 0x0000, 0xE73C, 0x8038, 0x2D0A, 0x0000,
+    0xE73C, 0x8004, 0x18E5, 0x0000, 0xE73C, 0x8021, 0xC9E6, 0x0002, 0xCA27, 0xFFFF, 0xCA89, 0x8013,
+    0xC9E6, 0x0000, 0xE73C, 0x8004, 0x18E5, 0x0000, 0xE73C, 0x8038, 0x3B79, 0x0000, 0xE73C, 0x800C,
+    0x18E5, 0x0000, 0xE73C, 0x8038, 0x2D0A, 0x0000, 0xE73C, 0x8004, 0x18E5, 0x0000, 0xE73C, 0x8021,
+    0xC9E6, 0x0002, 0xCA27, 0xFFFF, 0xCA89, 0x8013, 0xC9E6, 0x0000, 0xE73C, 0x8004, 0x18E5, 0x0000,
+    0xE73C, 0x8038, 0x3B79, 0x0000, 0xE73C, 0x800C, 0x18E5, 0x0000, 0xE73C, 0x8038, 0x2D0A, 0x0000,
+    0xE73C, 0x8004, 0x18E5, 0x0000, 0xE73C, 0x8038, 0xC9E6, 0x0000, 0xE73C, 0x8004, 0x18E5, 0x0000,
+    0xE73C, 0x8038, 0x3B79, 0x0000, 0xE73C, 0x800C, 0x18E5, 0x0000, 0xE73C, 0x8038, 0x2D0A, 0x0000,
+    0xE73C, 0x8004, 0x18E5, 0x0000, 0xE73C, 0x8038, 0xC9E6, 0x0000, 0xE73C, 0x8004, 0x18E5, 0x0000,
+    0xE73C, 0x8038, 0x3B79, 0x0000, 0xE73C, 0x800D, 0x18E5, 0x0000, 0xE73C, 0x8036, 0x2D0A, 0x0000,
+    0xE73C, 0x8006, 0x18E5, 0x0000, 0xE73C, 0x8036, 0xC9E6, 0x0000, 0xE73C, 0x8006, 0x18E5, 0x0000,
+    0xE73C, 0x8036, 0x3B79, 0x0000, 0xE73C, 0x800E, 0x18E5, 0x0000, 0xE73C, 0x8036, 0x2D0A, 0x0000,
+    0xE73C, 0x8006, 0x18E5, 0x0000, 0xE73C, 0x8036, 0xC9E6, 0x0000, 0xE73C, 0x8006, 0x18E5, 0x0000,
+    0xE73C, 0x8036, 0x3B79, 0x0000, 0xE73C, 0x800F, 0x18E5, 0x0000, 0xE73C, 0x8034, 0x2D0A, 0x0000,
+    0xE73C, 0x8008, 0x18E5, 0x0000, 0xE73C, 0x8034, 0xC9E6, 0x0000, 0xE73C, 0x8008, 0x18E5, 0x0000,
+    0xE73C, 0x8034, 0x3B79, 0x0000, 0xE73C, 0x8011, 0x18E5, 0x0001, 0xE73C, 0xE73C, 0x8030, 0x2D0A,
+    0x0001, 0xE73C, 0xE73C, 0x800A, 0x18E5, 0x0001, 0xE73C, 0xE73C, 0x8030, 0xC9E6, 0x0001, 0xE73C,
+    0xE73C, 0x800A, 0x18E5, 0x0001, 0xE73C, 0xE73C, 0x8030, 0x3B79, 0x0001, 0xE73C, 0xE73C, 0x8014,
+    0x18E5, 0x8030, 0xE73C, 0x800E, 0x18E5, 0x8030, 0xE73C, 0x800E, 0x18E5, 0x8030, 0xE73C, 0x8589,
+    0x18E5, 0x80BB, 0x7BD1, 0x800B, 0x18E5, 0x0000, 0x7BD1, 0x80B9, 0x2967, 0x0000, 0x7BD1, 0x800B,
+    0x18E5, 0x0001, 0x7BD1, 0x2967, 0x8078, 0xF5A5, 0x802C, 0x2967, 0x8003, 0x5EEF, 0x800E, 0x2967,
+    0x0000, 0x7BD1, 0x800B, 0x18E5, 0x0001, 0x7BD1, 0x2967, 0x8078, 0xF5A5, 0x802A, 0x2967, 0x8007,
+    0x5EEF, 0x800C, 0x2967, 0x0000, 0x7BD1, 0x800B, 0x18E5, 0x0001, 0x7BD1, 0x2967, 0x8078, 0xF5A5,
+    0x8029, 0x2967, 0x8009, 0x5EEF, 0x800B, 0x2967, 0x0000, 0x7BD1, 0x800B, 0x18E5, 0x0001, 0x7BD1,
+    0x2967, 0x8078, 0xF5A5, 0x8029, 0x2967, 0x8009, 0x5EEF, 0x800B, 0x2967, 0x0000, 0x7BD1, 0x800B,
+    0x18E5, 0x0001, 0x7BD1, 0x2967, 0x8078, 0xF5A5, 0x8028, 0x2967, 0x800B, 0x5EEF, 0x800A, 0x2967,
+    0x0000, 0x7BD1, 0x800B, 0x18E5, 0x0001, 0x7BD1, 0x2967, 0x8078, 0xF5A5, 0x8028, 0x2967, 0x800B,
+    0x5EEF, 0x800A, 0x2967, 0x0000, 0x7BD1, 0x800B, 0x18E5, 0x0001, 0x7BD1, 0x2967, 0x8078, 0xF5A5,
+    0x8028, 0x2967, 0x800B, 0x5EEF, 0x800A, 0x2967, 0x0000, 0x7BD1, 0x800B, 0x18E5, 0x0001, 0x7BD1,
+    0x2967, 0x8078, 0xF5A5, 0x8028, 0x2967, 0x800B, 0x5EEF, 0x800A, 0x2967, 0x0000, 0x7BD1, 0x800B,
+    0x18E5, 0x0001, 0x7BD1, 0x2967, 0x8078, 0xF5A5, 0x8029, 0x2967, 0x8009, 0x5EEF, 0x800B, 0x2967,
+    0x0000, 0x7BD1, 0x800B, 0x18E5, 0x0001, 0x7BD1, 0x2967, 0x8078, 0xF5A5, 0x8029, 0x2967, 0x8009,
+    0x5EEF, 0x800B, 0x2967, 0x0000, 0x7BD1, 0x800B, 0x18E5, 0x0001, 0x7BD1, 0x2967, 0x8078, 0xF5A5,
+    0x802A, 0x2967, 0x8007, 0x5EEF, 0x800C, 0x2967, 0x0000, 0x7BD1, 0x800B, 0x18E5, 0x0001, 0x7BD1,
+    0x2967, 0x8078, 0xF5A5, 0x802C, 0x2967, 0x8003, 0x5EEF, 0x800E, 0x2967, 0x0000, 0x7BD1, 0x800B,
+    0x18E5, 0x0000, 0x7BD1, 0x80B9, 0x2967, 0x0000, 0x7BD1, 0x800B, 0x18E5, 0x80BB, 0x7BD1, 0x84B5,
+    0x18E5,
+};
+
+static const ili_image_rle_t test_ui_panel = {200, 64, 1633, test_ui_panel_data};
+
+#endif /* _TEST_UI_PANEL_H_ */
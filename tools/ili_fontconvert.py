@@ -0,0 +1,147 @@
+#!/usr/bin/env python3
+"""
+Convert a TTF/OTF or BDF font into an ili_font_t table for ili_draw_string().
+
+    python3 ili_fontconvert.py <font.ttf|font.bdf> <name> [--size 16] [--bpp 4] [--first 32] [--last 126] > name.h
+
+TTF/OTF fonts are rasterized with Pillow (pip install pillow) at --size pixels, either
+anti-aliased (--bpp 4) or thresholded (--bpp 1). BDF fonts are bitmap fonts already, they are
+read as they are and --size is ignored. The output is a header to include in one source file.
+"""
+import argparse
+import os
+import sys
+
+
+class Glyph:
+    def __init__(self, width, height, x_advance, x_offset, y_offset, rows):
+        self.width = width
+        self.height = height
+        self.x_advance = x_advance
+        self.x_offset = x_offset
+        self.y_offset = y_offset
+        self.rows = rows            # `height` lists of `width` coverage values, 0..255
+
+
+def load_ttf(path, size, first, last):
+    from PIL import Image, ImageDraw, ImageFont
+
+    font = ImageFont.truetype(path, size)
+    ascent, descent = font.getmetrics()
+    glyphs = {}
+    for code in range(first, last + 1):
+        ch = chr(code)
+        advance = int(round(font.getlength(ch)))
+        left, _, right, _ = font.getbbox(ch)
+        pad = max(0, -left)
+        img = Image.new("L", (max(1, right + pad), ascent + descent), 0)
+        ImageDraw.Draw(img).text((pad, 0), ch, font=font, fill=255)
+        box = img.getbbox()
+        if box is None:
+            glyphs[code] = Glyph(0, 0, advance, 0, 0, [])
+            continue
+        x0, y0, x1, y1 = box
+        crop = img.crop(box)
+        rows = [[crop.getpixel((x, y)) for x in range(x1 - x0)] for y in range(y1 - y0)]
+        glyphs[code] = Glyph(x1 - x0, y1 - y0, advance, x0 - pad, y0, rows)
+    return glyphs, ascent + descent
+
+
+def load_bdf(path, first, last):
+    glyphs = {}
+    ascent = descent = 0
+    with open(path, encoding="latin-1") as f:
+        lines = iter(f.read().splitlines())
+    for line in lines:
+        words = line.split()
+        if not words:
+            continue
+        if words[0] == "FONT_ASCENT":
+            ascent = int(words[1])
+        elif words[0] == "FONT_DESCENT":
+            descent = int(words[1])
+        elif words[0] == "STARTCHAR":
+            code = -1
+            advance = 0
+            bbx = (0, 0, 0, 0)
+            for line in lines:
+                words = line.split()
+                if words[0] == "ENCODING":
+                    code = int(words[1])
+                elif words[0] == "DWIDTH":
+                    advance = int(words[1])
+                elif words[0] == "BBX":
+                    bbx = tuple(int(v) for v in words[1:5])
+                elif words[0] == "BITMAP":
+                    break
+            w, h, xo, yo = bbx
+            rows = []
+            for _ in range(h):
+                bits = int(next(lines), 16)
+                nbits = ((w + 7) // 8) * 8
+                rows.append([255 if bits & (1 << (nbits - 1 - x)) else 0 for x in range(w)])
+            if first <= code <= last:
+                # BDF offsets are from the baseline, y up
+                glyphs[code] = Glyph(w, h, advance, xo, ascent - (yo + h), rows)
+    return glyphs, ascent + descent
+
+
+def pack(glyph, bpp):
+    values = []
+    for row in glyph.rows:
+        for v in row:
+            values.append((v + 8) // 17 if bpp == 4 else (1 if v >= 128 else 0))
+    out = bytearray()
+    per_byte = 8 // bpp
+    for i in range(0, len(values), per_byte):
+        byte = 0
+        for k in range(per_byte):
+            v = values[i + k] if i + k < len(values) else 0
+            byte |= v << (8 - bpp * (k + 1))
+        out.append(byte)
+    return out
+
+
+def main():
+    ap = argparse.ArgumentParser(description="Convert a TTF/OTF or BDF font into an ili_font_t table")
+    ap.add_argument("font")
+    ap.add_argument("name", help="C name of the font")
+    ap.add_argument("--size", type=int, default=16, help="pixel size of TTF/OTF fonts")
+    ap.add_argument("--bpp", type=int, choices=(1, 4), default=4)
+    ap.add_argument("--first", type=int, default=32)
+    ap.add_argument("--last", type=int, default=126)
+    args = ap.parse_args()
+
+    if args.font.lower().endswith(".bdf"):
+        glyphs, line_h = load_bdf(args.font, args.first, args.last)
+    else:
+        glyphs, line_h = load_ttf(args.font, args.size, args.first, args.last)
+
+    bitmap = bytearray()
+    table = []
+    for code in range(args.first, args.last + 1):
+        g = glyphs.get(code, Glyph(0, 0, 0, 0, 0, []))
+        table.append((len(bitmap), g, code))
+        bitmap += pack(g, args.bpp)
+
+    o = sys.stdout
+    guard = "_" + args.name.upper() + "_H_"
+    o.write("/* Generated by ili_fontconvert.py from %s, --bpp %d */\n" % (os.path.basename(args.font), args.bpp))
+    o.write("#ifndef %s\n#define %s\n\n#include \"ili9341.h\"\n\n" % (guard, guard))
+    o.write("static const uint8_t %s_bitmap[] = {\n" % args.name)
+    for i in range(0, len(bitmap), 16):
+        o.write("    " + ", ".join("0x%02X" % b for b in bitmap[i:i + 16]) + ",\n")
+    o.write("};\n\n")
+    o.write("static const ili_glyph_t %s_glyphs[] = {\n" % args.name)
+    for offset, g, code in table:
+        ch = chr(code) if 32 <= code < 127 and chr(code) not in "\\'" else " "
+        o.write("    {%6d, %3d, %3d, %3d, %4d, %4d},  /* 0x%02X '%s' */\n"
+                % (offset, g.width, g.height, g.x_advance, g.x_offset, g.y_offset, code, ch))
+    o.write("};\n\n")
+    o.write("static const ili_font_t %s = {%s_bitmap, %s_glyphs, %d, %d, %d, %d};\n\n"
+            % (args.name, args.name, args.name, args.first, args.last, line_h, args.bpp))
+    o.write("#endif /* %s */\n" % guard)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,164 @@
+#!/usr/bin/env python3
+"""
+Convert a PNG or PPM image into a run-length encoded ili_image_rle_t for ili_draw_image_rle(),
+or with --bpp into a palette indexed ili_image_indexed_t for ili_draw_image_indexed().
+
+    python3 ili_imgconvert.py <image.png|image.ppm> <name> [--bpp 1|2|4|8] > name.h
+
+PPM (P6, as dumped by the host simulator) is read directly, other formats need Pillow
+(pip install pillow). Indexed images with more colors than the palette holds are quantized,
+which also needs Pillow. The compression ratio against raw RGB565 is reported on stderr.
+"""
+import argparse
+import os
+import sys
+
+RUN = 0x8000
+MAX_COUNT = 0x8000      # Pixels per packet
+MIN_RUN = 3             # Shorter runs are cheaper inside a literal
+
+
+def read_ppm(path):
+    with open(path, "rb") as f:
+        data = f.read()
+    fields = []
+    pos = 0
+    while len(fields) < 4:
+        while data[pos:pos + 1].isspace():
+            pos += 1
+        if data[pos:pos + 1] == b"#":
+            pos = data.index(b"\n", pos)
+            continue
+        end = pos
+        while not data[end:end + 1].isspace():
+            end += 1
+        fields.append(data[pos:end])
+        pos = end
+    if fields[0] != b"P6" or int(fields[3]) != 255:
+        raise ValueError("only 8-bit binary PPM (P6) is supported")
+    w, h = int(fields[1]), int(fields[2])
+    raw = data[pos + 1:pos + 1 + w * h * 3]
+    return w, h, [tuple(raw[i:i + 3]) for i in range(0, len(raw), 3)]
+
+
+def read_image(path):
+    if path.lower().endswith(".ppm"):
+        return read_ppm(path)
+    from PIL import Image
+    img = Image.open(path).convert("RGB")
+    raw = img.tobytes()
+    return img.width, img.height, [tuple(raw[i:i + 3]) for i in range(0, len(raw), 3)]
+
+
+def rgb565(p):
+    r, g, b = p[:3]
+    return ((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3)
+
+
+def encode(pixels):
+    words = []
+    literal = []
+
+    def flush_literal():
+        for i in range(0, len(literal), MAX_COUNT):
+            chunk = literal[i:i + MAX_COUNT]
+            words.append(len(chunk) - 1)
+            words.extend(chunk)
+        literal.clear()
+
+    i = 0
+    while i < len(pixels):
+        n = 1
+        while i + n < len(pixels) and pixels[i + n] == pixels[i] and n < MAX_COUNT:
+            n += 1
+        if n >= MIN_RUN:
+            flush_literal()
+            words.append(RUN | (n - 1))
+            words.append(pixels[i])
+        else:
+            literal.extend(pixels[i:i + n])
+        i += n
+    flush_literal()
+    return words
+
+
+def quantize(w, h, rgb, bpp):
+    colors = sorted(set(rgb))
+    if len(colors) <= (1 << bpp):
+        lookup = {c: i for i, c in enumerate(colors)}
+        return [lookup[p] for p in rgb], colors
+    from PIL import Image
+    img = Image.new("RGB", (w, h))
+    img.frombytes(bytes(v for p in rgb for v in p))
+    q = img.quantize(colors=1 << bpp)
+    pal = q.getpalette()[:3 * (1 << bpp)]
+    return list(q.tobytes()), [tuple(pal[i:i + 3]) for i in range(0, len(pal), 3)]
+
+
+def pack_indexed(w, h, indexes, bpp):
+    out = bytearray()
+    for y in range(h):
+        row = indexes[y * w:(y + 1) * w]
+        for i in range(0, w, 8 // bpp):
+            byte = 0
+            for k in range(8 // bpp):
+                v = row[i + k] if i + k < w else 0
+                byte |= v << (8 - bpp * (k + 1))
+            out.append(byte)
+    return out
+
+
+def write_header(o, args, w, h, what):
+    guard = "_" + args.name.upper() + "_H_"
+    o.write("/* Generated by ili_imgconvert.py from %s, %dx%d%s */\n" % (os.path.basename(args.image), w, h, what))
+    o.write("#ifndef %s\n#define %s\n\n#include \"ili9341.h\"\n\n" % (guard, guard))
+    return guard
+
+
+def main():
+    ap = argparse.ArgumentParser(description="Convert a PNG/PPM image into an ili_image_rle_t")
+    ap.add_argument("image")
+    ap.add_argument("name", help="C name of the image")
+    ap.add_argument("--bpp", type=int, choices=(1, 2, 4, 8), help="palette indexed instead of RLE")
+    args = ap.parse_args()
+
+    w, h, rgb = read_image(args.image)
+    o = sys.stdout
+    raw = w * h * 2
+
+    if args.bpp:
+        indexes, palette = quantize(w, h, rgb, args.bpp)
+        palette = palette + [(0, 0, 0)] * ((1 << args.bpp) - len(palette))
+        data = pack_indexed(w, h, indexes, args.bpp)
+        guard = write_header(o, args, w, h, ", %d bpp" % args.bpp)
+        o.write("static const uint8_t %s_data[] = {\n" % args.name)
+        for i in range(0, len(data), 16):
+            o.write("    " + ", ".join("0x%02X" % b for b in data[i:i + 16]) + ",\n")
+        o.write("};\n\n")
+        o.write("static const uint16_t %s_palette[] = {\n" % args.name)
+        for i in range(0, len(palette), 8):
+            o.write("    " + ", ".join("0x%04X" % rgb565(p) for p in palette[i:i + 8]) + ",\n")
+        o.write("};\n\n")
+        o.write("static const ili_image_indexed_t %s = {%d, %d, %d, %s_data, %s_palette};\n\n"
+                % (args.name, w, h, args.bpp, args.name, args.name))
+        o.write("#endif /* %s */\n" % guard)
+        size = len(data) + len(palette) * 2
+        sys.stderr.write("%s: %dx%d, %d bytes raw RGB565, %d bytes at %d bpp with palette, ratio %.2f:1\n"
+                         % (args.image, w, h, raw, size, args.bpp, raw / float(size)))
+        return
+
+    words = encode([rgb565(p) for p in rgb])
+    guard = write_header(o, args, w, h, "")
+    o.write("static const uint16_t %s_data[] = {\n" % args.name)
+    for i in range(0, len(words), 12):
+        o.write("    " + ", ".join("0x%04X" % v for v in words[i:i + 12]) + ",\n")
+    o.write("};\n\n")
+    o.write("static const ili_image_rle_t %s = {%d, %d, %d, %s_data};\n\n" % (args.name, w, h, len(words), args.name))
+    o.write("#endif /* %s */\n" % guard)
+
+    sys.stderr.write("%s: %dx%d, %d bytes raw RGB565, %d bytes RLE, ratio %.2f:1\n"
+                     % (args.image, w, h, raw, len(words) * 2, raw / (len(words) * 2.0)))
+
+
+if __name__ == "__main__":
+    main()